@@ -0,0 +1,540 @@
+/*
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Lesser General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+*/
+
+#include "ruby.h"
+#include "ruby/encoding.h"
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+VALUE mCosmos = Qnil;
+VALUE mBinaryRpc = Qnil;
+
+/* First byte of every binary message */
+#define BINARY_RPC_MARKER 0xC1
+/* MessagePack extension type of Time */
+#define BINARY_RPC_TIME_EXT -1
+/* MessagePack extension type of integers which do not fit in 64 bits */
+#define BINARY_RPC_BIGNUM_EXT 1
+
+static ID id_method_to_h = 0;
+static ID id_method_as_json = 0;
+static ID id_method_encode = 0;
+static ID id_method_less_than = 0;
+static ID id_method_greater_than = 0;
+static ID id_const_JsonRpc = 0;
+
+static VALUE int64_min = Qnil;
+static VALUE uint64_max = Qnil;
+
+static void encode_object(VALUE object, VALUE buffer);
+
+static void append_byte(VALUE buffer, unsigned char byte)
+{
+  rb_str_buf_cat(buffer, (const char *)&byte, 1);
+}
+
+/* Writes length big endian bytes of value */
+static void write_uint(unsigned char *bytes, uint64_t value, int length)
+{
+  int index = 0;
+
+  for (index = 0; index < length; index++)
+  {
+    bytes[length - 1 - index] = (unsigned char)(value >> (8 * index));
+  }
+}
+
+static void append_type_and_bytes(VALUE buffer, unsigned char type, uint64_t value, int length)
+{
+  unsigned char bytes[9];
+
+  bytes[0] = type;
+  write_uint(&bytes[1], value, length);
+  rb_str_buf_cat(buffer, (const char *)bytes, length + 1);
+}
+
+static void encode_int64(int64_t value, VALUE buffer)
+{
+  if (value >= 0)
+  {
+    if (value < 128) {
+      append_byte(buffer, (unsigned char)value);
+    } else if (value < 0x100) {
+      append_type_and_bytes(buffer, 0xCC, (uint64_t)value, 1);
+    } else if (value < 0x10000) {
+      append_type_and_bytes(buffer, 0xCD, (uint64_t)value, 2);
+    } else if (value < 0x100000000LL) {
+      append_type_and_bytes(buffer, 0xCE, (uint64_t)value, 4);
+    } else {
+      append_type_and_bytes(buffer, 0xCF, (uint64_t)value, 8);
+    }
+  }
+  else
+  {
+    if (value >= -32) {
+      append_byte(buffer, (unsigned char)(int8_t)value);
+    } else if (value >= -0x80) {
+      append_type_and_bytes(buffer, 0xD0, (uint64_t)value, 1);
+    } else if (value >= -0x8000) {
+      append_type_and_bytes(buffer, 0xD1, (uint64_t)value, 2);
+    } else if (value >= -0x80000000LL) {
+      append_type_and_bytes(buffer, 0xD2, (uint64_t)value, 4);
+    } else {
+      append_type_and_bytes(buffer, 0xD3, (uint64_t)value, 8);
+    }
+  }
+}
+
+static void encode_bignum(VALUE value, VALUE buffer)
+{
+  if (RTEST(rb_funcall(value, id_method_less_than, 1, int64_min)) ||
+      RTEST(rb_funcall(value, id_method_greater_than, 1, uint64_max)))
+  {
+    /* Too large for MessagePack so sent as decimal text */
+    VALUE digits = rb_big2str(value, 10);
+    long length = RSTRING_LEN(digits);
+    if (length < 0x100) {
+      append_type_and_bytes(buffer, 0xC7, (uint64_t)length, 1);
+    } else {
+      append_type_and_bytes(buffer, 0xC9, (uint64_t)length, 4);
+    }
+    append_byte(buffer, (unsigned char)BINARY_RPC_BIGNUM_EXT);
+    rb_str_buf_cat(buffer, RSTRING_PTR(digits), length);
+  }
+  else if (RTEST(rb_funcall(value, id_method_less_than, 1, INT2FIX(0))))
+  {
+    encode_int64((int64_t)rb_big2ll(value), buffer);
+  }
+  else
+  {
+    append_type_and_bytes(buffer, 0xCF, (uint64_t)rb_big2ull(value), 8);
+  }
+}
+
+static void encode_double(double value, VALUE buffer)
+{
+  uint64_t bits = 0;
+  memcpy(&bits, &value, sizeof(bits));
+  append_type_and_bytes(buffer, 0xCB, bits, 8);
+}
+
+/* Matches String::NON_ASCII_PRINTABLE (/[^\x21-\x7e\s]/) */
+static int is_non_ascii_printable(const unsigned char *data, long length)
+{
+  long index = 0;
+  unsigned char byte = 0;
+
+  for (index = 0; index < length; index++)
+  {
+    byte = data[index];
+    if ((byte < 0x21 || byte > 0x7E) && byte != ' ' && (byte < '\t' || byte > '\r'))
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void encode_length(VALUE buffer, long length, unsigned char type8, unsigned char type16, unsigned char type32)
+{
+  if (length < 0x100) {
+    append_type_and_bytes(buffer, type8, (uint64_t)length, 1);
+  } else if (length < 0x10000) {
+    append_type_and_bytes(buffer, type16, (uint64_t)length, 2);
+  } else {
+    append_type_and_bytes(buffer, type32, (uint64_t)length, 4);
+  }
+}
+
+/* Binary strings are encoded as MessagePack bin so they decode as ASCII-8BIT
+ * strings. Text is encoded as MessagePack str and decodes as UTF-8 like it
+ * does from JSON. */
+static void encode_string(VALUE string, VALUE buffer)
+{
+  int encoding_index = ENCODING_GET(string);
+  long length = RSTRING_LEN(string);
+
+  if ((rb_enc_str_coderange(string) == ENC_CODERANGE_BROKEN) ||
+      ((encoding_index == rb_ascii8bit_encindex()) &&
+       is_non_ascii_printable((const unsigned char *)RSTRING_PTR(string), length)))
+  {
+    encode_length(buffer, length, 0xC4, 0xC5, 0xC6);
+  }
+  else
+  {
+    if ((encoding_index != rb_utf8_encindex()) && (rb_enc_str_coderange(string) != ENC_CODERANGE_7BIT))
+    {
+      string = rb_funcall(string, id_method_encode, 1, rb_enc_from_encoding(rb_utf8_encoding()));
+      length = RSTRING_LEN(string);
+    }
+    if (length < 32) {
+      append_byte(buffer, (unsigned char)(0xA0 | length));
+    } else {
+      encode_length(buffer, length, 0xD9, 0xDA, 0xDB);
+    }
+  }
+  rb_str_buf_cat(buffer, RSTRING_PTR(string), length);
+  RB_GC_GUARD(string);
+}
+
+static void encode_header(VALUE buffer, long length, unsigned char fix_type, unsigned char type16, unsigned char type32)
+{
+  if (length < 16) {
+    append_byte(buffer, (unsigned char)(fix_type | length));
+  } else if (length < 0x10000) {
+    append_type_and_bytes(buffer, type16, (uint64_t)length, 2);
+  } else {
+    append_type_and_bytes(buffer, type32, (uint64_t)length, 4);
+  }
+}
+
+static int encode_pair(VALUE key, VALUE value, VALUE buffer)
+{
+  /* Keys are converted to strings as they are in JSON */
+  if (SYMBOL_P(key)) {
+    key = rb_sym_to_s(key);
+  } else if (!RB_TYPE_P(key, T_STRING)) {
+    key = rb_obj_as_string(key);
+  }
+  encode_string(key, buffer);
+  encode_object(value, buffer);
+  return ST_CONTINUE;
+}
+
+static void encode_object(VALUE object, VALUE buffer)
+{
+  long index = 0;
+  struct timespec time;
+  unsigned char time_bytes[15];
+
+  switch (TYPE(object))
+  {
+    case T_NIL:
+      append_byte(buffer, 0xC0);
+      break;
+
+    case T_FALSE:
+      append_byte(buffer, 0xC2);
+      break;
+
+    case T_TRUE:
+      append_byte(buffer, 0xC3);
+      break;
+
+    case T_FIXNUM:
+      encode_int64((int64_t)FIX2LONG(object), buffer);
+      break;
+
+    case T_BIGNUM:
+      encode_bignum(object, buffer);
+      break;
+
+    case T_FLOAT:
+      encode_double(RFLOAT_VALUE(object), buffer);
+      break;
+
+    case T_STRING:
+      encode_string(object, buffer);
+      break;
+
+    case T_SYMBOL:
+      encode_string(rb_sym_to_s(object), buffer);
+      break;
+
+    case T_ARRAY:
+      encode_header(buffer, RARRAY_LEN(object), 0x90, 0xDC, 0xDD);
+      for (index = 0; index < RARRAY_LEN(object); index++)
+      {
+        encode_object(rb_ary_entry(object, index), buffer);
+      }
+      break;
+
+    case T_HASH:
+      encode_header(buffer, (long)RHASH_SIZE(object), 0x80, 0xDE, 0xDF);
+      rb_hash_foreach(object, encode_pair, buffer);
+      break;
+
+    default:
+      if (RTEST(rb_obj_is_kind_of(object, rb_cTime)))
+      {
+        /* MessagePack timestamp 96 */
+        time = rb_time_timespec(object);
+        time_bytes[0] = 0xC7;
+        time_bytes[1] = 12;
+        time_bytes[2] = (unsigned char)(int8_t)BINARY_RPC_TIME_EXT;
+        write_uint(&time_bytes[3], (uint64_t)time.tv_nsec, 4);
+        write_uint(&time_bytes[7], (uint64_t)(int64_t)time.tv_sec, 8);
+        rb_str_buf_cat(buffer, (const char *)time_bytes, sizeof(time_bytes));
+      }
+      else if (RTEST(rb_obj_is_kind_of(object, rb_cNumeric)))
+      {
+        encode_double(rb_num2dbl(object), buffer);
+      }
+      else if (RTEST(rb_obj_is_kind_of(object, rb_eException)) ||
+               (rb_const_defined(mCosmos, id_const_JsonRpc) &&
+                RTEST(rb_obj_is_kind_of(object, rb_const_get(mCosmos, id_const_JsonRpc)))))
+      {
+        encode_object(rb_funcall(object, id_method_to_h, 0), buffer);
+      }
+      else
+      {
+        encode_object(rb_funcall(object, id_method_as_json, 0), buffer);
+      }
+      break;
+  }
+}
+
+/*
+ * @param object [Object] The object to encode
+ * @return [String] The binary message
+ */
+static VALUE binary_rpc_dump(VALUE self, VALUE object)
+{
+  VALUE buffer = rb_str_buf_new(256);
+  append_byte(buffer, BINARY_RPC_MARKER);
+  encode_object(object, buffer);
+  return buffer;
+}
+
+typedef struct {
+  const unsigned char *data;
+  long length;
+  long pos;
+} decoder_t;
+
+static VALUE decode_object(decoder_t *decoder);
+
+static const unsigned char *read_bytes(decoder_t *decoder, long length)
+{
+  const unsigned char *bytes = NULL;
+
+  if ((length < 0) || (length > (decoder->length - decoder->pos)))
+  {
+    rb_raise(rb_eArgError, "Truncated binary message");
+  }
+  bytes = decoder->data + decoder->pos;
+  decoder->pos += length;
+  return bytes;
+}
+
+static uint64_t read_uint(decoder_t *decoder, int length)
+{
+  const unsigned char *bytes = read_bytes(decoder, length);
+  uint64_t value = 0;
+  int index = 0;
+
+  for (index = 0; index < length; index++)
+  {
+    value = (value << 8) | bytes[index];
+  }
+  return value;
+}
+
+static VALUE read_str(decoder_t *decoder, long length)
+{
+  const unsigned char *bytes = read_bytes(decoder, length);
+  return rb_enc_str_new((const char *)bytes, length, rb_utf8_encoding());
+}
+
+static VALUE read_bin(decoder_t *decoder, long length)
+{
+  const unsigned char *bytes = read_bytes(decoder, length);
+  return rb_str_new((const char *)bytes, length);
+}
+
+static VALUE read_array(decoder_t *decoder, long length)
+{
+  long index = 0;
+  VALUE array = Qnil;
+
+  /* Each element is at least one byte */
+  if (length > (decoder->length - decoder->pos))
+  {
+    rb_raise(rb_eArgError, "Truncated binary message");
+  }
+  array = rb_ary_new2(length);
+  for (index = 0; index < length; index++)
+  {
+    rb_ary_push(array, decode_object(decoder));
+  }
+  return array;
+}
+
+static VALUE read_map(decoder_t *decoder, long length)
+{
+  long index = 0;
+  VALUE hash = rb_hash_new();
+  VALUE key = Qnil;
+
+  for (index = 0; index < length; index++)
+  {
+    key = decode_object(decoder);
+    rb_hash_aset(hash, key, decode_object(decoder));
+  }
+  return hash;
+}
+
+static VALUE read_float(decoder_t *decoder)
+{
+  uint32_t bits = (uint32_t)read_uint(decoder, 4);
+  float value = 0.0;
+  memcpy(&value, &bits, sizeof(value));
+  return rb_float_new((double)value);
+}
+
+static VALUE read_double(decoder_t *decoder)
+{
+  uint64_t bits = read_uint(decoder, 8);
+  double value = 0.0;
+  memcpy(&value, &bits, sizeof(value));
+  return rb_float_new(value);
+}
+
+static VALUE read_ext(decoder_t *decoder, long length)
+{
+  int type = (int8_t)read_uint(decoder, 1);
+  const unsigned char *bytes = NULL;
+  uint64_t value = 0;
+  decoder_t ext;
+
+  bytes = read_bytes(decoder, length);
+  ext.data = bytes;
+  ext.length = length;
+  ext.pos = 0;
+
+  switch (type)
+  {
+    case BINARY_RPC_TIME_EXT:
+      switch (length)
+      {
+        case 4:
+          return rb_time_nano_new((time_t)read_uint(&ext, 4), 0);
+        case 8:
+          value = read_uint(&ext, 8);
+          return rb_time_nano_new((time_t)(value & 0x3FFFFFFFFULL), (long)(value >> 34));
+        case 12:
+          value = read_uint(&ext, 4);
+          return rb_time_nano_new((time_t)(int64_t)read_uint(&ext, 8), (long)value);
+        default:
+          rb_raise(rb_eArgError, "Invalid binary message time");
+      }
+    case BINARY_RPC_BIGNUM_EXT:
+      return rb_str_to_inum(rb_str_new((const char *)bytes, length), 10, Qtrue);
+    default:
+      rb_raise(rb_eArgError, "Unknown binary message extension %d", type);
+  }
+  return Qnil;
+}
+
+static VALUE decode_object(decoder_t *decoder)
+{
+  unsigned char type = (unsigned char)read_uint(decoder, 1);
+
+  if (type <= 0x7F) {
+    return INT2FIX(type);
+  } else if (type <= 0x8F) {
+    return read_map(decoder, type & 0x0F);
+  } else if (type <= 0x9F) {
+    return read_array(decoder, type & 0x0F);
+  } else if (type <= 0xBF) {
+    return read_str(decoder, type & 0x1F);
+  } else if (type >= 0xE0) {
+    return INT2FIX((int)type - 0x100);
+  }
+
+  switch (type)
+  {
+    case 0xC0: return Qnil;
+    case 0xC2: return Qfalse;
+    case 0xC3: return Qtrue;
+    case 0xC4: return read_bin(decoder, (long)read_uint(decoder, 1));
+    case 0xC5: return read_bin(decoder, (long)read_uint(decoder, 2));
+    case 0xC6: return read_bin(decoder, (long)read_uint(decoder, 4));
+    case 0xC7: return read_ext(decoder, (long)read_uint(decoder, 1));
+    case 0xC8: return read_ext(decoder, (long)read_uint(decoder, 2));
+    case 0xC9: return read_ext(decoder, (long)read_uint(decoder, 4));
+    case 0xCA: return read_float(decoder);
+    case 0xCB: return read_double(decoder);
+    case 0xCC: return INT2FIX(read_uint(decoder, 1));
+    case 0xCD: return INT2FIX(read_uint(decoder, 2));
+    case 0xCE: return ULL2NUM(read_uint(decoder, 4));
+    case 0xCF: return ULL2NUM(read_uint(decoder, 8));
+    case 0xD0: return INT2FIX((int8_t)read_uint(decoder, 1));
+    case 0xD1: return INT2FIX((int16_t)read_uint(decoder, 2));
+    case 0xD2: return LL2NUM((int32_t)read_uint(decoder, 4));
+    case 0xD3: return LL2NUM((int64_t)read_uint(decoder, 8));
+    case 0xD4: return read_ext(decoder, 1);
+    case 0xD5: return read_ext(decoder, 2);
+    case 0xD6: return read_ext(decoder, 4);
+    case 0xD7: return read_ext(decoder, 8);
+    case 0xD8: return read_ext(decoder, 16);
+    case 0xD9: return read_str(decoder, (long)read_uint(decoder, 1));
+    case 0xDA: return read_str(decoder, (long)read_uint(decoder, 2));
+    case 0xDB: return read_str(decoder, (long)read_uint(decoder, 4));
+    case 0xDC: return read_array(decoder, (long)read_uint(decoder, 2));
+    case 0xDD: return read_array(decoder, (long)read_uint(decoder, 4));
+    case 0xDE: return read_map(decoder, (long)read_uint(decoder, 2));
+    case 0xDF: return read_map(decoder, (long)read_uint(decoder, 4));
+    default:
+      rb_raise(rb_eArgError, "Invalid binary message type 0x%X", type);
+  }
+  return Qnil;
+}
+
+/*
+ * @param data [String] A binary message created by {.dump}
+ * @return [Object] The decoded object
+ */
+static VALUE binary_rpc_load(VALUE self, VALUE data)
+{
+  decoder_t decoder;
+  VALUE object = Qnil;
+
+  StringValue(data);
+  /* Decode from a frozen copy so the bytes can not change while Ruby code runs */
+  data = rb_str_new_frozen(data);
+  decoder.data = (const unsigned char *)RSTRING_PTR(data);
+  decoder.length = RSTRING_LEN(data);
+  decoder.pos = 0;
+
+  if ((decoder.length < 1) || (decoder.data[0] != BINARY_RPC_MARKER))
+  {
+    rb_raise(rb_eArgError, "Not a binary message");
+  }
+  decoder.pos = 1;
+  object = decode_object(&decoder);
+  if (decoder.pos != decoder.length)
+  {
+    rb_raise(rb_eArgError, "Extra data after binary message");
+  }
+  RB_GC_GUARD(data);
+  return object;
+}
+
+void Init_binary_rpc(void)
+{
+  id_method_to_h = rb_intern("to_h");
+  id_method_as_json = rb_intern("as_json");
+  id_method_encode = rb_intern("encode");
+  id_method_less_than = rb_intern("<");
+  id_method_greater_than = rb_intern(">");
+  id_const_JsonRpc = rb_intern("JsonRpc");
+
+  int64_min = rb_ll2inum(INT64_MIN);
+  rb_global_variable(&int64_min);
+  uint64_max = rb_ull2inum(UINT64_MAX);
+  rb_global_variable(&uint64_max);
+
+  mCosmos = rb_define_module("Cosmos");
+  mBinaryRpc = rb_define_module_under(mCosmos, "BinaryRpc");
+  rb_define_module_function(mBinaryRpc, "dump", binary_rpc_dump, 1);
+  rb_define_module_function(mBinaryRpc, "load", binary_rpc_load, 1);
+}
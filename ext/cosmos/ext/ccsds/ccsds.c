@@ -0,0 +1,385 @@
+/*
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+*/
+
+#include "ruby.h"
+#include "stdio.h"
+#include "string.h"
+
+VALUE mCosmos = Qnil;
+VALUE cCcsdsReassembler = Qnil;
+
+/* Length of the CCSDS primary header */
+#define CCSDS_HEADER_LENGTH 6
+/* Number of APIDs */
+#define CCSDS_NUM_APIDS 2048
+/* Modulus of the sequence count */
+#define CCSDS_SEQUENCE_COUNT_MODULUS 16384
+
+/* Sequence flag values */
+#define CCSDS_CONTINUATION 0
+#define CCSDS_FIRST 1
+#define CCSDS_LAST 2
+#define CCSDS_STANDALONE 3
+
+static ID id_packets = 0;
+static ID id_completed = 0;
+static ID id_missing = 0;
+static ID id_discarded = 0;
+static ID id_unexpected = 0;
+static ID id_in_progress_bytes = 0;
+
+/*
+ * Reassembly state of a single APID. The segments of the packet being
+ * reassembled are kept as frozen strings sharing the received buffers. The
+ * first segment is used whole and only the data following the primary header
+ * is used from the others.
+ */
+typedef struct {
+  VALUE segments;
+  long in_progress_length;
+  int sequence_count;
+  unsigned long long packets;
+  unsigned long long completed;
+  unsigned long long missing;
+  unsigned long long discarded;
+  unsigned long long unexpected;
+} apid_state_t;
+
+typedef struct {
+  apid_state_t* apids[CCSDS_NUM_APIDS];
+} ccsds_reassembler_t;
+
+static void ccsds_reassembler_mark(void* ptr)
+{
+  ccsds_reassembler_t* reassembler = (ccsds_reassembler_t*) ptr;
+  int apid = 0;
+  for (apid = 0; apid < CCSDS_NUM_APIDS; apid++)
+  {
+    if (reassembler->apids[apid])
+    {
+      rb_gc_mark(reassembler->apids[apid]->segments);
+    }
+  }
+}
+
+static void ccsds_reassembler_free(void* ptr)
+{
+  ccsds_reassembler_t* reassembler = (ccsds_reassembler_t*) ptr;
+  int apid = 0;
+  for (apid = 0; apid < CCSDS_NUM_APIDS; apid++)
+  {
+    if (reassembler->apids[apid])
+    {
+      xfree(reassembler->apids[apid]);
+    }
+  }
+  xfree(reassembler);
+}
+
+static size_t ccsds_reassembler_memsize(const void* ptr)
+{
+  const ccsds_reassembler_t* reassembler = (const ccsds_reassembler_t*) ptr;
+  size_t size = sizeof(ccsds_reassembler_t);
+  int apid = 0;
+  for (apid = 0; apid < CCSDS_NUM_APIDS; apid++)
+  {
+    if (reassembler->apids[apid])
+    {
+      size += sizeof(apid_state_t);
+    }
+  }
+  return size;
+}
+
+static const rb_data_type_t ccsds_reassembler_type = {
+  "Cosmos::CcsdsReassembler",
+  {ccsds_reassembler_mark, ccsds_reassembler_free, ccsds_reassembler_memsize,},
+  NULL, NULL, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE ccsds_reassembler_alloc(VALUE klass)
+{
+  ccsds_reassembler_t* reassembler = NULL;
+  /* TypedData_Make_Struct zeroes the APID table */
+  return TypedData_Make_Struct(klass, ccsds_reassembler_t, &ccsds_reassembler_type, reassembler);
+}
+
+static ccsds_reassembler_t* get_reassembler(VALUE self)
+{
+  ccsds_reassembler_t* reassembler = NULL;
+  TypedData_Get_Struct(self, ccsds_reassembler_t, &ccsds_reassembler_type, reassembler);
+  return reassembler;
+}
+
+static int get_apid(VALUE param_apid)
+{
+  int apid = NUM2INT(param_apid);
+  if ((apid < 0) || (apid >= CCSDS_NUM_APIDS))
+  {
+    rb_raise(rb_eArgError, "APID must be from 0 to %d: %d", CCSDS_NUM_APIDS - 1, apid);
+  }
+  return apid;
+}
+
+/* Drop the segments of the packet being reassembled */
+static void discard_in_progress(apid_state_t* state)
+{
+  if (state->in_progress_length > 0)
+  {
+    state->discarded++;
+  }
+  rb_ary_clear(state->segments);
+  state->in_progress_length = 0;
+}
+
+/* Concatenate the segments of the packet being reassembled */
+static VALUE join_segments(apid_state_t* state)
+{
+  volatile VALUE result = rb_str_new(NULL, state->in_progress_length);
+  volatile VALUE segment = Qnil;
+  char* destination = RSTRING_PTR(result);
+  long num_segments = RARRAY_LEN(state->segments);
+  long index = 0;
+  long offset = 0;
+
+  for (index = 0; index < num_segments; index++)
+  {
+    segment = rb_ary_entry(state->segments, index);
+    offset = (index == 0) ? 0 : CCSDS_HEADER_LENGTH;
+    memcpy(destination, RSTRING_PTR(segment) + offset, RSTRING_LEN(segment) - offset);
+    destination += RSTRING_LEN(segment) - offset;
+  }
+
+  rb_ary_clear(state->segments);
+  state->in_progress_length = 0;
+  return result;
+}
+
+/*
+ * Reassemble a segment of a CCSDS packet. Segments of different APIDs may be
+ * interleaved. Segments which do not continue the packet being reassembled
+ * for their APID are counted rather than raising an error so one bad APID
+ * does not disturb the others.
+ *
+ * @param data [String] A complete CCSDS packet including the primary header
+ * @return [String|nil] The reassembled packet once the last segment is
+ *   received, the data of a standalone packet or nil if the packet is not yet
+ *   complete or was discarded
+ */
+static VALUE ccsds_reassembler_unsegment(VALUE self, VALUE data)
+{
+  ccsds_reassembler_t* reassembler = get_reassembler(self);
+  apid_state_t* state = NULL;
+  unsigned char* header = NULL;
+  volatile VALUE segment = Qnil;
+  int apid = 0;
+  int sequence_flags = 0;
+  int sequence_count = 0;
+  int expected_sequence_count = 0;
+  int in_sequence = 1;
+
+  StringValue(data);
+  if (RSTRING_LEN(data) < CCSDS_HEADER_LENGTH)
+  {
+    rb_raise(rb_eArgError, "CCSDS packet of %ld bytes is shorter than the primary header", RSTRING_LEN(data));
+  }
+
+  /* Extract the primary header fields */
+  header = (unsigned char*) RSTRING_PTR(data);
+  apid = ((header[0] & 0x07) << 8) | header[1];
+  sequence_flags = header[2] >> 6;
+  sequence_count = ((header[2] & 0x3F) << 8) | header[3];
+
+  state = reassembler->apids[apid];
+  if (!state)
+  {
+    state = ALLOC(apid_state_t);
+    memset(state, 0, sizeof(apid_state_t));
+    state->segments = rb_ary_new();
+    state->sequence_count = -1;
+    reassembler->apids[apid] = state;
+  }
+
+  state->packets++;
+  if (state->sequence_count >= 0)
+  {
+    expected_sequence_count = (state->sequence_count + 1) % CCSDS_SEQUENCE_COUNT_MODULUS;
+    if (sequence_count != expected_sequence_count)
+    {
+      in_sequence = 0;
+      state->missing += (sequence_count - expected_sequence_count + CCSDS_SEQUENCE_COUNT_MODULUS) % CCSDS_SEQUENCE_COUNT_MODULUS;
+    }
+  }
+  state->sequence_count = sequence_count;
+
+  switch (sequence_flags)
+  {
+    case CCSDS_CONTINUATION:
+    case CCSDS_LAST:
+      if (state->in_progress_length == 0)
+      {
+        state->unexpected++;
+        return Qnil;
+      }
+      if (!in_sequence)
+      {
+        discard_in_progress(state);
+        return Qnil;
+      }
+      /* Share the received buffer rather than copying the data */
+      segment = rb_str_new_frozen(data);
+      rb_ary_push(state->segments, segment);
+      state->in_progress_length += RSTRING_LEN(segment) - CCSDS_HEADER_LENGTH;
+      if (sequence_flags == CCSDS_LAST)
+      {
+        state->completed++;
+        return join_segments(state);
+      }
+      return Qnil;
+
+    case CCSDS_FIRST:
+      if (state->in_progress_length > 0)
+      {
+        state->unexpected++;
+        discard_in_progress(state);
+      }
+      segment = rb_str_new_frozen(data);
+      rb_ary_push(state->segments, segment);
+      state->in_progress_length = RSTRING_LEN(segment);
+      return Qnil;
+
+    default: /* CCSDS_STANDALONE */
+      if (state->in_progress_length > 0)
+      {
+        state->unexpected++;
+        discard_in_progress(state);
+      }
+      state->completed++;
+      return data;
+  }
+}
+
+/*
+ * @param apid [Integer] The APID
+ * @return [Hash|nil] Reassembly statistics for the APID or nil if no packets
+ *   have been received with the APID. The keys are :packets (segments
+ *   received), :completed (packets returned), :missing (sequence counts
+ *   skipped), :discarded (partially reassembled packets dropped),
+ *   :unexpected (segments received out of order) and :in_progress_bytes.
+ */
+static VALUE ccsds_reassembler_stats(VALUE self, VALUE param_apid)
+{
+  ccsds_reassembler_t* reassembler = get_reassembler(self);
+  apid_state_t* state = reassembler->apids[get_apid(param_apid)];
+  volatile VALUE stats = Qnil;
+
+  if (!state)
+  {
+    return Qnil;
+  }
+
+  stats = rb_hash_new();
+  rb_hash_aset(stats, ID2SYM(id_packets), ULL2NUM(state->packets));
+  rb_hash_aset(stats, ID2SYM(id_completed), ULL2NUM(state->completed));
+  rb_hash_aset(stats, ID2SYM(id_missing), ULL2NUM(state->missing));
+  rb_hash_aset(stats, ID2SYM(id_discarded), ULL2NUM(state->discarded));
+  rb_hash_aset(stats, ID2SYM(id_unexpected), ULL2NUM(state->unexpected));
+  rb_hash_aset(stats, ID2SYM(id_in_progress_bytes), LONG2NUM(state->in_progress_length));
+  return stats;
+}
+
+/*
+ * @return [Array<Integer>] The APIDs which have been received
+ */
+static VALUE ccsds_reassembler_apids(VALUE self)
+{
+  ccsds_reassembler_t* reassembler = get_reassembler(self);
+  volatile VALUE apids = rb_ary_new();
+  int apid = 0;
+  for (apid = 0; apid < CCSDS_NUM_APIDS; apid++)
+  {
+    if (reassembler->apids[apid])
+    {
+      rb_ary_push(apids, INT2FIX(apid));
+    }
+  }
+  return apids;
+}
+
+/*
+ * @param apid [Integer] The APID
+ * @return [Boolean] Whether a packet is being reassembled for the APID
+ */
+static VALUE ccsds_reassembler_in_progress(VALUE self, VALUE param_apid)
+{
+  ccsds_reassembler_t* reassembler = get_reassembler(self);
+  apid_state_t* state = reassembler->apids[get_apid(param_apid)];
+  if (state && (state->in_progress_length > 0))
+  {
+    return Qtrue;
+  }
+  return Qfalse;
+}
+
+/*
+ * Drop the packets being reassembled and clear the statistics
+ *
+ * @param apid [Integer|nil] The APID to reset or nil to reset every APID
+ */
+static VALUE ccsds_reassembler_reset(int argc, VALUE* argv, VALUE self)
+{
+  ccsds_reassembler_t* reassembler = get_reassembler(self);
+  int apid = 0;
+  int first = 0;
+  int last = CCSDS_NUM_APIDS - 1;
+
+  if (argc > 1)
+  {
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+  }
+  if ((argc == 1) && (argv[0] != Qnil))
+  {
+    first = get_apid(argv[0]);
+    last = first;
+  }
+
+  for (apid = first; apid <= last; apid++)
+  {
+    if (reassembler->apids[apid])
+    {
+      xfree(reassembler->apids[apid]);
+      reassembler->apids[apid] = NULL;
+    }
+  }
+  return Qnil;
+}
+
+/*
+ * Initialize methods for the CCSDS processing classes
+ */
+void Init_ccsds(void)
+{
+  id_packets = rb_intern("packets");
+  id_completed = rb_intern("completed");
+  id_missing = rb_intern("missing");
+  id_discarded = rb_intern("discarded");
+  id_unexpected = rb_intern("unexpected");
+  id_in_progress_bytes = rb_intern("in_progress_bytes");
+
+  mCosmos = rb_define_module("Cosmos");
+
+  cCcsdsReassembler = rb_define_class_under(mCosmos, "CcsdsReassembler", rb_cObject);
+  rb_define_alloc_func(cCcsdsReassembler, ccsds_reassembler_alloc);
+  rb_define_method(cCcsdsReassembler, "unsegment", ccsds_reassembler_unsegment, 1);
+  rb_define_method(cCcsdsReassembler, "stats", ccsds_reassembler_stats, 1);
+  rb_define_method(cCcsdsReassembler, "apids", ccsds_reassembler_apids, 0);
+  rb_define_method(cCcsdsReassembler, "in_progress?", ccsds_reassembler_in_progress, 1);
+  rb_define_method(cCcsdsReassembler, "reset", ccsds_reassembler_reset, -1);
+}
@@ -9,7 +9,30 @@
 */
 
 #include "ruby.h"
+#include "ruby/io.h"
 #include "stdio.h"
+#include "string.h"
+#include "errno.h"
+
+#ifdef HAVE_WRITEV
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <limits.h>
+
+/* Number of segments passed to a single writev call */
+#ifdef IOV_MAX
+#define COSMOS_IOV_MAX (IOV_MAX < 64 ? IOV_MAX : 64)
+#else
+#define COSMOS_IOV_MAX 16
+#endif
+
+/* Bytes which can be written to a writable pipe without blocking */
+#ifndef PIPE_BUF
+#define PIPE_BUF 512
+#endif
+#endif
 
 static const int endianness_check = 1;
 #define HOST_ENDIANNESS (*((char *) &endianness_check))
@@ -19,6 +42,7 @@ static const int endianness_check = 1;
 VALUE mCosmosIO = Qnil;
 
 static ID id_method_read         = 0;
+static ID id_method_write_nonblock = 0;
 
 /* Reads a length field and then return the String resulting from reading the
   * number of bytes the length field indicates
@@ -105,13 +129,145 @@ static VALUE read_length_bytes(VALUE self, VALUE param_length_num_bytes)
   return return_value;
 }
 
+#ifdef HAVE_WRITEV
+/* Writes an Array of Strings to the IO with a single system call without
+ * blocking. The Strings are written directly from their own buffers so they
+ * do not need to be joined first. Like IO#write_nonblock this raises
+ * IO::EAGAINWaitWritable if the IO is not ready for writing but the mode of
+ * the file descriptor is not changed. Sockets are written with
+ * MSG_DONTWAIT. Other blocking file descriptors are written at most PIPE_BUF
+ * bytes at a time once they are writable.
+ *
+ * @param segments [Array<String>] Strings to write in order
+ * @return [Integer] Number of bytes written which may be less than the total
+ *   length of the segments
+ */
+static VALUE writev_nonblock(VALUE self, VALUE segments)
+{
+  rb_io_t *fptr = NULL;
+  struct iovec iov[COSMOS_IOV_MAX];
+  struct msghdr message;
+  struct pollfd poll_fd;
+  volatile VALUE io = Qnil;
+  volatile VALUE segment = Qnil;
+  long num_segments = 0;
+  long index = 0;
+  int iov_count = 0;
+  int fd = 0;
+  int flags = 0;
+  size_t total_length = 0;
+  ssize_t result = 0;
+
+  Check_Type(segments, T_ARRAY);
+  num_segments = RARRAY_LEN(segments);
+
+  /* IO like objects such as StringIO write the joined segments */
+  if (!RB_TYPE_P(self, T_FILE))
+  {
+    return rb_funcall(self, id_method_write_nonblock, 1, rb_ary_join(segments, rb_str_new2("")));
+  }
+
+  io = rb_io_get_write_io(self);
+  GetOpenFile(io, fptr);
+  rb_io_check_writable(fptr);
+#ifdef HAVE_RB_IO_DESCRIPTOR
+  fd = rb_io_descriptor(io);
+#else
+  fd = fptr->fd;
+#endif
+
+  for (index = 0; (index < num_segments) && (iov_count < COSMOS_IOV_MAX); index++)
+  {
+    segment = rb_ary_entry(segments, index);
+    StringValue(segment);
+    if (RSTRING_LEN(segment) == 0)
+    {
+      continue;
+    }
+    iov[iov_count].iov_base = RSTRING_PTR(segment);
+    iov[iov_count].iov_len = RSTRING_LEN(segment);
+    total_length += RSTRING_LEN(segment);
+    iov_count++;
+  }
+  if (iov_count == 0)
+  {
+    return INT2FIX(0);
+  }
+
+  flags = fcntl(fd, F_GETFL);
+  if ((flags != -1) && (flags & O_NONBLOCK))
+  {
+    do {
+      result = writev(fd, iov, iov_count);
+    } while ((result < 0) && (errno == EINTR));
+  }
+  else
+  {
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = iov;
+    message.msg_iovlen = iov_count;
+    do {
+      result = sendmsg(fd, &message, MSG_DONTWAIT);
+    } while ((result < 0) && (errno == EINTR));
+
+    if ((result < 0) && (errno == ENOTSOCK))
+    {
+      /* A writable pipe accepts PIPE_BUF bytes without blocking */
+      do {
+        poll_fd.fd = fd;
+        poll_fd.events = POLLOUT;
+        poll_fd.revents = 0;
+        result = poll(&poll_fd, 1, 0);
+      } while ((result < 0) && (errno == EINTR));
+      if (result == 0)
+      {
+        errno = EAGAIN;
+        result = -1;
+      }
+      else if (result > 0)
+      {
+        for (index = 0, total_length = 0; index < iov_count; index++)
+        {
+          if ((total_length + iov[index].iov_len) >= PIPE_BUF)
+          {
+            iov[index].iov_len = PIPE_BUF - total_length;
+            iov_count = (int) index + 1;
+            break;
+          }
+          total_length += iov[index].iov_len;
+        }
+        do {
+          result = writev(fd, iov, iov_count);
+        } while ((result < 0) && (errno == EINTR));
+      }
+    }
+  }
+
+  if (result < 0)
+  {
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+    {
+      rb_readwrite_syserr_fail(RB_IO_WAIT_WRITABLE, errno, "writev would block");
+    }
+    rb_sys_fail("writev");
+  }
+  RB_GC_GUARD(segments);
+
+  return LONG2NUM(result);
+}
+#endif
+
 /*
  * Initialize methods for CosmosIO
  */
 void Init_cosmos_io (void)
 {
   id_method_read = rb_intern("read");
+  id_method_write_nonblock = rb_intern("write_nonblock");
 
   mCosmosIO = rb_define_module("CosmosIO");
   rb_define_method(mCosmosIO, "read_length_bytes", read_length_bytes, 1);
+#ifdef HAVE_WRITEV
+  rb_define_method(mCosmosIO, "writev_nonblock", writev_nonblock, 1);
+#endif
 }
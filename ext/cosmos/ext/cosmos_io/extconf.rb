@@ -10,4 +10,7 @@ if CONFIG['CC'] =~ /gcc/
   end
 end
 
+have_func('writev', 'sys/uio.h')
+have_func('rb_io_descriptor', 'ruby/io.h')
+
 create_makefile 'cosmos/ext/cosmos_io'
@@ -85,47 +85,72 @@ static unsigned long long bit_reverse_64(unsigned long long value)
     ((unsigned long long)BIT_REVERSE_TABLE[(value >> 56) & 0x00000000000000ffULL]);
 }
 
+/*
+ * Parse the arguments to calc which are the data, an optional seed and an
+ * optional byte offset and length within the data. Returns the seed and
+ * sets the data pointer and length to the range to calculate over.
+ */
+static VALUE parse_calculate_args(int argc, VALUE* argv, VALUE self, unsigned char** data, long* length)
+{
+  VALUE param_seed = Qnil;
+  long data_length = 0;
+  long offset = 0;
+
+  if ((argc < 1) || (argc > 4))
+  {
+    /* Invalid number of arguments given */
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..4)", argc);
+  }
+
+  Check_Type(argv[0], T_STRING);
+  data_length = RSTRING_LEN(argv[0]);
+
+  if ((argc >= 2) && (argv[1] != Qnil))
+  {
+    param_seed = argv[1];
+  }
+  else
+  {
+    param_seed = rb_ivar_get(self, id_ivar_seed);
+  }
+
+  if ((argc >= 3) && (argv[2] != Qnil))
+  {
+    offset = NUM2LONG(argv[2]);
+    if ((offset < 0) || (offset > data_length))
+    {
+      rb_raise(rb_eArgError, "offset %ld outside of data of length %ld", offset, data_length);
+    }
+  }
+
+  *length = data_length - offset;
+  if ((argc >= 4) && (argv[3] != Qnil))
+  {
+    *length = NUM2LONG(argv[3]);
+    if ((*length < 0) || (*length > (data_length - offset)))
+    {
+      rb_raise(rb_eArgError, "length %ld at offset %ld outside of data of length %ld", *length, offset, data_length);
+    }
+  }
+
+  *data = ((unsigned char*) RSTRING_PTR(argv[0])) + offset;
+  return param_seed;
+}
+
 /*
  * Calculate a 16-bit CRC
  */
 static VALUE crc16_calculate(int argc, VALUE* argv, VALUE self)
 {
-  volatile VALUE param_data = Qnil;
   volatile VALUE param_seed = Qnil;
   unsigned char* data = NULL;
   unsigned short* table = NULL;
-  int i = 0;
+  long i = 0;
   long length = 0;
   unsigned short crc = 0;
 
-  switch (argc)
-  {
-    case 1:
-      Check_Type(argv[0], T_STRING);
-      param_data = argv[0];
-      param_seed = rb_ivar_get(self, id_ivar_seed);
-      break;
-    case 2:
-      Check_Type(argv[0], T_STRING);
-      param_data = argv[0];
-      if (argv[1] == Qnil)
-      {
-        param_seed = rb_ivar_get(self, id_ivar_seed);
-      }
-      else
-      {
-        param_seed = argv[1];
-      }
-      break;
-    default:
-      /* Invalid number of arguments given */
-      rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
-      break;
-  };
-
+  param_seed = parse_calculate_args(argc, argv, self, &data, &length);
   crc = NUM2UINT(param_seed);
-  data = (unsigned char*) RSTRING_PTR(param_data);
-  length = RSTRING_LEN(param_data);
   table = (unsigned short*) RSTRING_PTR(rb_ivar_get(self, id_ivar_table));
 
   if (RTEST(rb_ivar_get(self, id_ivar_reflect)))
@@ -167,42 +192,15 @@ static VALUE crc16_calculate(int argc, VALUE* argv, VALUE self)
  */
 static VALUE crc32_calculate(int argc, VALUE* argv, VALUE self)
 {
-  volatile VALUE param_data = Qnil;
   volatile VALUE param_seed = Qnil;
   unsigned char* data = NULL;
   unsigned int* table = NULL;
-  int i = 0;
+  long i = 0;
   long length = 0;
   unsigned int crc = 0;
 
-  switch (argc)
-  {
-    case 1:
-      Check_Type(argv[0], T_STRING);
-      param_data = argv[0];
-      param_seed = rb_ivar_get(self, id_ivar_seed);
-      break;
-    case 2:
-      Check_Type(argv[0], T_STRING);
-      param_data = argv[0];
-      if (argv[1] == Qnil)
-      {
-        param_seed = rb_ivar_get(self, id_ivar_seed);
-      }
-      else
-      {
-        param_seed = argv[1];
-      }
-      break;
-    default:
-      /* Invalid number of arguments given */
-      rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
-      break;
-  };
-
+  param_seed = parse_calculate_args(argc, argv, self, &data, &length);
   crc = NUM2UINT(param_seed);
-  data = (unsigned char*) RSTRING_PTR(param_data);
-  length = RSTRING_LEN(param_data);
   table = (unsigned int*) RSTRING_PTR(rb_ivar_get(self, id_ivar_table));
 
   if (RTEST(rb_ivar_get(self, id_ivar_reflect)))
@@ -244,42 +242,15 @@ static VALUE crc32_calculate(int argc, VALUE* argv, VALUE self)
  */
 static VALUE crc64_calculate(int argc, VALUE* argv, VALUE self)
 {
-  volatile VALUE param_data = Qnil;
   volatile VALUE param_seed = Qnil;
   unsigned char* data = NULL;
   unsigned long long* table = NULL;
-  int i = 0;
+  long i = 0;
   long length = 0;
   unsigned long long crc = 0;
 
-  switch (argc)
-  {
-    case 1:
-      Check_Type(argv[0], T_STRING);
-      param_data = argv[0];
-      param_seed = rb_ivar_get(self, id_ivar_seed);
-      break;
-    case 2:
-      Check_Type(argv[0], T_STRING);
-      param_data = argv[0];
-      if (argv[1] == Qnil)
-      {
-        param_seed = rb_ivar_get(self, id_ivar_seed);
-      }
-      else
-      {
-        param_seed = argv[1];
-      }
-      break;
-    default:
-      /* Invalid number of arguments given */
-      rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
-      break;
-  };
-
+  param_seed = parse_calculate_args(argc, argv, self, &data, &length);
   crc = NUM2ULL(param_seed);
-  data = (unsigned char*) RSTRING_PTR(param_data);
-  length = RSTRING_LEN(param_data);
   table = (unsigned long long*) RSTRING_PTR(rb_ivar_get(self, id_ivar_table));
 
   if (RTEST(rb_ivar_get(self, id_ivar_reflect)))
@@ -0,0 +1,379 @@
+/*
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "ruby.h"
+#include "ruby/io.h"
+#include "errno.h"
+
+/* Platforms without recvmmsg and sendmmsg use the single datagram reads and
+ * writes in lib/cosmos/io/udp_sockets.rb */
+#if !defined(_WIN32) && defined(HAVE_RECVMMSG) && defined(HAVE_SENDMMSG)
+#define COSMOS_NATIVE_DATAGRAM 1
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#endif
+
+VALUE mCosmos = Qnil;
+VALUE mDatagram = Qnil;
+VALUE cReceiver = Qnil;
+
+#ifdef COSMOS_NATIVE_DATAGRAM
+
+/* Maximum number of datagrams passed to a single sendmmsg call */
+#define DATAGRAM_SEND_BATCH 64
+
+/* Room for the receive timestamp and drop counter control messages */
+#define DATAGRAM_CONTROL_LENGTH (CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t)))
+
+typedef struct {
+  /* Number of datagrams which can be received by one call */
+  long count;
+  /* Size of each datagram buffer. Longer datagrams are truncated. */
+  long max_length;
+  char* buffers;
+  char* controls;
+  struct iovec* iovs;
+  struct mmsghdr* msgs;
+  /* Datagrams dropped by the socket as last reported by the kernel */
+  unsigned long dropped;
+  VALUE io;
+} receiver_t;
+
+static void receiver_mark(void* ptr)
+{
+  receiver_t* receiver = (receiver_t*) ptr;
+  rb_gc_mark(receiver->io);
+}
+
+static void receiver_free(void* ptr)
+{
+  receiver_t* receiver = (receiver_t*) ptr;
+  if (receiver->buffers)
+  {
+    xfree(receiver->buffers);
+    xfree(receiver->controls);
+    xfree(receiver->iovs);
+    xfree(receiver->msgs);
+  }
+  xfree(receiver);
+}
+
+static size_t receiver_memsize(const void* ptr)
+{
+  const receiver_t* receiver = (const receiver_t*) ptr;
+  return sizeof(receiver_t) + (receiver->count *
+    (receiver->max_length + DATAGRAM_CONTROL_LENGTH + sizeof(struct iovec) + sizeof(struct mmsghdr)));
+}
+
+static const rb_data_type_t receiver_type = {
+  "Cosmos::Datagram::Receiver",
+  {receiver_mark, receiver_free, receiver_memsize,},
+  NULL, NULL, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE receiver_alloc(VALUE klass)
+{
+  receiver_t* receiver = NULL;
+  VALUE self = TypedData_Make_Struct(klass, receiver_t, &receiver_type, receiver);
+  receiver->io = Qnil;
+  return self;
+}
+
+static receiver_t* get_receiver(VALUE self)
+{
+  receiver_t* receiver = NULL;
+  TypedData_Get_Struct(self, receiver_t, &receiver_type, receiver);
+  if (!receiver->buffers)
+  {
+    rb_raise(rb_eRuntimeError, "uninitialized receiver");
+  }
+  return receiver;
+}
+
+static int datagram_fd(VALUE io)
+{
+  rb_io_t* fptr = NULL;
+  io = rb_io_get_io(io);
+  GetOpenFile(io, fptr);
+  rb_io_check_closed(fptr);
+#ifdef HAVE_RB_IO_DESCRIPTOR
+  return rb_io_descriptor(io);
+#else
+  return fptr->fd;
+#endif
+}
+
+/*
+ * Allocates the buffers which every call to {#receive} reuses and asks the
+ * kernel to report the receive time and the socket drop counter with each
+ * datagram.
+ *
+ * @param io [UDPSocket] Socket to receive from
+ * @param count [Integer] Maximum number of datagrams received by one call
+ * @param max_length [Integer] Size of each datagram buffer
+ */
+static VALUE receiver_initialize(int argc, VALUE* argv, VALUE self)
+{
+  VALUE io = Qnil;
+  VALUE count = Qnil;
+  VALUE max_length = Qnil;
+  receiver_t* receiver = NULL;
+  long index = 0;
+  int fd = 0;
+  int enable = 1;
+
+  rb_scan_args(argc, argv, "12", &io, &count, &max_length);
+  TypedData_Get_Struct(self, receiver_t, &receiver_type, receiver);
+  if (receiver->buffers)
+  {
+    rb_raise(rb_eRuntimeError, "receiver already initialized");
+  }
+
+  fd = datagram_fd(io);
+  receiver->count = NIL_P(count) ? 64 : NUM2LONG(count);
+  receiver->max_length = NIL_P(max_length) ? 65536 : NUM2LONG(max_length);
+  if ((receiver->count <= 0) || (receiver->count > 1024))
+  {
+    rb_raise(rb_eArgError, "count must be between 1 and 1024: %ld", receiver->count);
+  }
+  if (receiver->max_length <= 0)
+  {
+    rb_raise(rb_eArgError, "max_length must be positive: %ld", receiver->max_length);
+  }
+  receiver->io = io;
+
+  receiver->buffers = ALLOC_N(char, receiver->count * receiver->max_length);
+  receiver->controls = ALLOC_N(char, receiver->count * DATAGRAM_CONTROL_LENGTH);
+  receiver->iovs = ALLOC_N(struct iovec, receiver->count);
+  receiver->msgs = ALLOC_N(struct mmsghdr, receiver->count);
+  memset(receiver->msgs, 0, receiver->count * sizeof(struct mmsghdr));
+  for (index = 0; index < receiver->count; index++)
+  {
+    receiver->iovs[index].iov_base = receiver->buffers + (index * receiver->max_length);
+    receiver->iovs[index].iov_len = receiver->max_length;
+    receiver->msgs[index].msg_hdr.msg_iov = &receiver->iovs[index];
+    receiver->msgs[index].msg_hdr.msg_iovlen = 1;
+  }
+
+  /* Not every kernel supports these so failures are ignored. The datagrams
+   * are then returned without a time and the drop count stays zero. */
+#ifdef SO_TIMESTAMPNS
+  setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+#endif
+#ifdef SO_RXQ_OVFL
+  setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+#endif
+  (void) enable;
+
+  return self;
+}
+
+/*
+ * Receives the datagrams waiting on the socket without blocking
+ *
+ * @param datagrams [Array<String>] Each datagram received is appended
+ * @param times [Array<Time|nil>] The kernel receive time of each datagram
+ *   is appended or nil if the kernel did not report it
+ * @param max_datagrams [Integer] Maximum number of datagrams to receive.
+ *   Limited to the count given to the constructor.
+ * @return [Integer] The number of datagrams received. 0 if none are waiting.
+ */
+static VALUE receiver_receive(int argc, VALUE* argv, VALUE self)
+{
+  VALUE datagrams = Qnil;
+  VALUE times = Qnil;
+  VALUE max_datagrams = Qnil;
+  receiver_t* receiver = get_receiver(self);
+  struct msghdr* hdr = NULL;
+  struct cmsghdr* cmsg = NULL;
+  struct timespec timestamp;
+  uint32_t dropped = 0;
+  VALUE time = Qnil;
+  long max = receiver->count;
+  long index = 0;
+  int received = 0;
+  int fd = 0;
+
+  rb_scan_args(argc, argv, "21", &datagrams, &times, &max_datagrams);
+  Check_Type(datagrams, T_ARRAY);
+  Check_Type(times, T_ARRAY);
+  if (!NIL_P(max_datagrams))
+  {
+    max = NUM2LONG(max_datagrams);
+    if (max > receiver->count)
+    {
+      max = receiver->count;
+    }
+    if (max <= 0)
+    {
+      return INT2FIX(0);
+    }
+  }
+
+  fd = datagram_fd(receiver->io);
+  for (index = 0; index < max; index++)
+  {
+    hdr = &receiver->msgs[index].msg_hdr;
+    hdr->msg_control = receiver->controls + (index * DATAGRAM_CONTROL_LENGTH);
+    hdr->msg_controllen = DATAGRAM_CONTROL_LENGTH;
+    hdr->msg_flags = 0;
+  }
+
+  received = recvmmsg(fd, receiver->msgs, (unsigned int) max, MSG_DONTWAIT, NULL);
+  if (received < 0)
+  {
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+    {
+      return INT2FIX(0);
+    }
+    rb_sys_fail("recvmmsg");
+  }
+
+  for (index = 0; index < received; index++)
+  {
+    hdr = &receiver->msgs[index].msg_hdr;
+    time = Qnil;
+    for (cmsg = CMSG_FIRSTHDR(hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(hdr, cmsg))
+    {
+      if (cmsg->cmsg_level != SOL_SOCKET)
+      {
+        continue;
+      }
+#ifdef SCM_TIMESTAMPNS
+      if (cmsg->cmsg_type == SCM_TIMESTAMPNS)
+      {
+        memcpy(&timestamp, CMSG_DATA(cmsg), sizeof(timestamp));
+        time = rb_time_nano_new(timestamp.tv_sec, timestamp.tv_nsec);
+      }
+#endif
+#ifdef SO_RXQ_OVFL
+      if (cmsg->cmsg_type == SO_RXQ_OVFL)
+      {
+        memcpy(&dropped, CMSG_DATA(cmsg), sizeof(dropped));
+        receiver->dropped = dropped;
+      }
+#endif
+    }
+    rb_ary_push(datagrams, rb_str_new((char*) receiver->iovs[index].iov_base, receiver->msgs[index].msg_len));
+    rb_ary_push(times, time);
+  }
+  (void) timestamp;
+  (void) dropped;
+
+  return INT2FIX(received);
+}
+
+/*
+ * @return [Integer] The number of datagrams the socket has dropped because
+ *   its receive buffer was full. Updated as datagrams are received.
+ */
+static VALUE receiver_dropped(VALUE self)
+{
+  return ULONG2NUM(get_receiver(self)->dropped);
+}
+
+/*
+ * @return [Integer] Maximum number of datagrams received by one call
+ */
+static VALUE receiver_count(VALUE self)
+{
+  return LONG2NUM(get_receiver(self)->count);
+}
+
+/*
+ * Sends datagrams on a connected socket without blocking
+ *
+ * @param io [UDPSocket] Connected socket to send on
+ * @param datagrams [Array<String>] Datagrams to send
+ * @param offset [Integer] Index of the first datagram to send
+ * @return [Integer] The number of datagrams sent starting at offset. At most
+ *   64 are sent by one call. 0 if the socket is not writable.
+ */
+static VALUE datagram_send_batch(int argc, VALUE* argv, VALUE self)
+{
+  VALUE io = Qnil;
+  VALUE datagrams = Qnil;
+  VALUE offset = Qnil;
+  struct mmsghdr msgs[DATAGRAM_SEND_BATCH];
+  struct iovec iovs[DATAGRAM_SEND_BATCH];
+  VALUE datagram = Qnil;
+  long first = 0;
+  long num_datagrams = 0;
+  long index = 0;
+  int sent = 0;
+  int fd = 0;
+
+  rb_scan_args(argc, argv, "21", &io, &datagrams, &offset);
+  Check_Type(datagrams, T_ARRAY);
+  first = NIL_P(offset) ? 0 : NUM2LONG(offset);
+  if (first < 0)
+  {
+    rb_raise(rb_eArgError, "negative offset: %ld", first);
+  }
+  num_datagrams = RARRAY_LEN(datagrams) - first;
+  if (num_datagrams <= 0)
+  {
+    return INT2FIX(0);
+  }
+  if (num_datagrams > DATAGRAM_SEND_BATCH)
+  {
+    num_datagrams = DATAGRAM_SEND_BATCH;
+  }
+
+  fd = datagram_fd(io);
+  memset(msgs, 0, sizeof(msgs));
+  for (index = 0; index < num_datagrams; index++)
+  {
+    datagram = rb_ary_entry(datagrams, first + index);
+    StringValue(datagram);
+    iovs[index].iov_base = RSTRING_PTR(datagram);
+    iovs[index].iov_len = RSTRING_LEN(datagram);
+    msgs[index].msg_hdr.msg_iov = &iovs[index];
+    msgs[index].msg_hdr.msg_iovlen = 1;
+  }
+
+  sent = sendmmsg(fd, msgs, (unsigned int) num_datagrams, MSG_DONTWAIT);
+  RB_GC_GUARD(datagrams);
+  if (sent < 0)
+  {
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+    {
+      return INT2FIX(0);
+    }
+    rb_sys_fail("sendmmsg");
+  }
+  return INT2FIX(sent);
+}
+
+#endif /* COSMOS_NATIVE_DATAGRAM */
+
+void Init_datagram(void)
+{
+  mCosmos = rb_define_module("Cosmos");
+
+#ifdef COSMOS_NATIVE_DATAGRAM
+  mDatagram = rb_define_module_under(mCosmos, "Datagram");
+  rb_define_module_function(mDatagram, "send_batch", datagram_send_batch, -1);
+
+  cReceiver = rb_define_class_under(mDatagram, "Receiver", rb_cObject);
+  rb_define_alloc_func(cReceiver, receiver_alloc);
+  rb_define_method(cReceiver, "initialize", receiver_initialize, -1);
+  rb_define_method(cReceiver, "receive", receiver_receive, -1);
+  rb_define_method(cReceiver, "dropped", receiver_dropped, 0);
+  rb_define_method(cReceiver, "count", receiver_count, 0);
+#endif
+}
@@ -0,0 +1,19 @@
+require 'mkmf'
+
+unless $CFLAGS.gsub!(/ -O[\dsz]?/, ' -O3')
+  $CFLAGS << ' -O3'
+end
+if CONFIG['CC'] =~ /gcc/
+  $CFLAGS << ' -Wall'
+  if $DEBUG && !$CFLAGS.gsub!(/ -O[\dsz]?/, ' -O0 -ggdb')
+    $CFLAGS << ' -O0 -ggdb'
+  end
+end
+
+# recvmmsg and sendmmsg are only declared by glibc with _GNU_SOURCE
+$CPPFLAGS << ' -D_GNU_SOURCE'
+have_func('recvmmsg', 'sys/socket.h')
+have_func('sendmmsg', 'sys/socket.h')
+have_func('rb_io_descriptor', 'ruby/io.h')
+
+create_makefile 'cosmos/ext/datagram'
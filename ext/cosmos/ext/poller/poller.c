@@ -0,0 +1,512 @@
+/*
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+*/
+
+#include "ruby.h"
+#include "ruby/io.h"
+#include "ruby/thread.h"
+#include "errno.h"
+
+/* Windows uses the IO.select based Poller in lib/cosmos/io/poller.rb */
+#if !defined(_WIN32) && (defined(HAVE_SYS_EPOLL_H) || defined(HAVE_POLL_H))
+#define COSMOS_NATIVE_POLLER 1
+#include <unistd.h>
+#include <fcntl.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+#endif
+
+VALUE mCosmos = Qnil;
+VALUE cPoller = Qnil;
+
+#ifdef COSMOS_NATIVE_POLLER
+
+#define POLLER_READABLE 1
+#define POLLER_WRITABLE 2
+
+/* Maximum number of events returned by a single wait */
+#define POLLER_MAX_EVENTS 256
+
+typedef struct {
+  int wakeup_reader;
+  int wakeup_writer;
+#ifdef HAVE_SYS_EPOLL_H
+  int epoll_fd;
+  struct epoll_event events[POLLER_MAX_EVENTS];
+#else
+  /* The first entry is always the wakeup pipe */
+  struct pollfd* fds;
+  long num_fds;
+  long capacity;
+#endif
+  /* Hash of file descriptor to the registered IO */
+  VALUE ios;
+} poller_t;
+
+/* Arguments to the wait performed without the GVL */
+typedef struct {
+  poller_t* poller;
+  int timeout;
+  int result;
+  int error;
+} poller_wait_t;
+
+static void poller_mark(void* ptr)
+{
+  poller_t* poller = (poller_t*) ptr;
+  rb_gc_mark(poller->ios);
+}
+
+static void poller_close_fds(poller_t* poller)
+{
+  if (poller->wakeup_reader >= 0)
+  {
+    close(poller->wakeup_reader);
+    close(poller->wakeup_writer);
+    poller->wakeup_reader = -1;
+    poller->wakeup_writer = -1;
+  }
+#ifdef HAVE_SYS_EPOLL_H
+  if (poller->epoll_fd >= 0)
+  {
+    close(poller->epoll_fd);
+    poller->epoll_fd = -1;
+  }
+#endif
+}
+
+static void poller_free(void* ptr)
+{
+  poller_t* poller = (poller_t*) ptr;
+  poller_close_fds(poller);
+#ifndef HAVE_SYS_EPOLL_H
+  if (poller->fds)
+  {
+    xfree(poller->fds);
+  }
+#endif
+  xfree(poller);
+}
+
+static size_t poller_memsize(const void* ptr)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  return sizeof(poller_t);
+#else
+  const poller_t* poller = (const poller_t*) ptr;
+  return sizeof(poller_t) + (poller->capacity * sizeof(struct pollfd));
+#endif
+}
+
+static const rb_data_type_t poller_type = {
+  "Cosmos::Poller",
+  {poller_mark, poller_free, poller_memsize,},
+  NULL, NULL, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE poller_alloc(VALUE klass)
+{
+  poller_t* poller = NULL;
+  VALUE self = TypedData_Make_Struct(klass, poller_t, &poller_type, poller);
+  poller->wakeup_reader = -1;
+  poller->wakeup_writer = -1;
+#ifdef HAVE_SYS_EPOLL_H
+  poller->epoll_fd = -1;
+#endif
+  poller->ios = Qnil;
+  return self;
+}
+
+static poller_t* get_poller(VALUE self)
+{
+  poller_t* poller = NULL;
+  TypedData_Get_Struct(self, poller_t, &poller_type, poller);
+  if (poller->wakeup_reader < 0)
+  {
+    rb_raise(rb_eIOError, "closed poller");
+  }
+  return poller;
+}
+
+static int poller_fd(VALUE io)
+{
+  rb_io_t* fptr = NULL;
+  io = rb_io_get_io(io);
+  GetOpenFile(io, fptr);
+#ifdef HAVE_RB_IO_DESCRIPTOR
+  return rb_io_descriptor(io);
+#else
+  return fptr->fd;
+#endif
+}
+
+/*
+ * Creates the wakeup pipe and the epoll instance
+ */
+static VALUE poller_initialize(VALUE self)
+{
+  poller_t* poller = NULL;
+  int fds[2];
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event event;
+#endif
+
+  TypedData_Get_Struct(self, poller_t, &poller_type, poller);
+  poller->ios = rb_hash_new();
+
+  if (pipe(fds) != 0)
+  {
+    rb_sys_fail("pipe");
+  }
+  fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+  fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+  poller->wakeup_reader = fds[0];
+  poller->wakeup_writer = fds[1];
+
+#ifdef HAVE_SYS_EPOLL_H
+  poller->epoll_fd = epoll_create(POLLER_MAX_EVENTS);
+  if (poller->epoll_fd < 0)
+  {
+    poller_close_fds(poller);
+    rb_sys_fail("epoll_create");
+  }
+  fcntl(poller->epoll_fd, F_SETFD, FD_CLOEXEC);
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = poller->wakeup_reader;
+  if (epoll_ctl(poller->epoll_fd, EPOLL_CTL_ADD, poller->wakeup_reader, &event) != 0)
+  {
+    poller_close_fds(poller);
+    rb_sys_fail("epoll_ctl");
+  }
+#else
+  poller->capacity = 16;
+  poller->fds = ALLOC_N(struct pollfd, poller->capacity);
+  poller->fds[0].fd = poller->wakeup_reader;
+  poller->fds[0].events = POLLIN;
+  poller->fds[0].revents = 0;
+  poller->num_fds = 1;
+#endif
+
+  return self;
+}
+
+#ifndef HAVE_SYS_EPOLL_H
+static long poller_find(poller_t* poller, int fd)
+{
+  long index = 0;
+  for (index = 1; index < poller->num_fds; index++)
+  {
+    if (poller->fds[index].fd == fd)
+    {
+      return index;
+    }
+  }
+  return -1;
+}
+#endif
+
+/*
+ * Watch an IO for readiness. Registering an IO which is already registered
+ * changes the events it is watched for.
+ *
+ * @param io [IO] The IO to watch
+ * @param events [Integer] READABLE, WRITABLE or both OR'd together
+ */
+static VALUE poller_register(VALUE self, VALUE io, VALUE events_value)
+{
+  poller_t* poller = get_poller(self);
+  int fd = poller_fd(io);
+  int events = NUM2INT(events_value);
+  int registered = RTEST(rb_hash_lookup2(poller->ios, INT2FIX(fd), Qfalse));
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event event;
+
+  memset(&event, 0, sizeof(event));
+  if (events & POLLER_READABLE)
+  {
+    event.events |= EPOLLIN;
+  }
+  if (events & POLLER_WRITABLE)
+  {
+    event.events |= EPOLLOUT;
+  }
+  event.data.fd = fd;
+  /* A descriptor which was closed and reused without being deregistered is
+   * no longer in the epoll instance */
+  if ((!registered || (epoll_ctl(poller->epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0)) &&
+      (epoll_ctl(poller->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0))
+  {
+    rb_sys_fail("epoll_ctl");
+  }
+#else
+  long index = registered ? poller_find(poller, fd) : -1;
+
+  if (index < 0)
+  {
+    if (poller->num_fds == poller->capacity)
+    {
+      poller->capacity *= 2;
+      REALLOC_N(poller->fds, struct pollfd, poller->capacity);
+    }
+    index = poller->num_fds++;
+    poller->fds[index].fd = fd;
+  }
+  poller->fds[index].events = 0;
+  if (events & POLLER_READABLE)
+  {
+    poller->fds[index].events |= POLLIN;
+  }
+  if (events & POLLER_WRITABLE)
+  {
+    poller->fds[index].events |= POLLOUT;
+  }
+  poller->fds[index].revents = 0;
+#endif
+
+  rb_hash_aset(poller->ios, INT2FIX(fd), io);
+  return io;
+}
+
+static int poller_find_io(VALUE key, VALUE value, VALUE arg)
+{
+  VALUE* result = (VALUE*) arg;
+  if (value == result[0])
+  {
+    result[1] = key;
+    return ST_STOP;
+  }
+  return ST_CONTINUE;
+}
+
+/*
+ * Stop watching an IO. An IO which has already been closed is also removed.
+ *
+ * @param io [IO] The IO to stop watching
+ */
+static VALUE poller_deregister(VALUE self, VALUE io)
+{
+  poller_t* poller = get_poller(self);
+  VALUE search[2];
+  int fd = 0;
+#ifdef HAVE_SYS_EPOLL_H
+  struct epoll_event event;
+#else
+  long index = 0;
+#endif
+
+  /* The descriptor of a closed IO is only known from the registration */
+  search[0] = io;
+  search[1] = Qnil;
+  rb_hash_foreach(poller->ios, poller_find_io, (VALUE) search);
+  if (search[1] == Qnil)
+  {
+    return Qnil;
+  }
+  fd = FIX2INT(search[1]);
+  rb_hash_delete(poller->ios, search[1]);
+
+#ifdef HAVE_SYS_EPOLL_H
+  /* Closing the descriptor already removed it from the epoll instance */
+  memset(&event, 0, sizeof(event));
+  epoll_ctl(poller->epoll_fd, EPOLL_CTL_DEL, fd, &event);
+#else
+  index = poller_find(poller, fd);
+  if (index >= 0)
+  {
+    poller->fds[index] = poller->fds[poller->num_fds - 1];
+    poller->num_fds--;
+  }
+#endif
+  return io;
+}
+
+static void* poller_wait_without_gvl(void* ptr)
+{
+  poller_wait_t* wait = (poller_wait_t*) ptr;
+#ifdef HAVE_SYS_EPOLL_H
+  wait->result = epoll_wait(wait->poller->epoll_fd, wait->poller->events, POLLER_MAX_EVENTS, wait->timeout);
+#else
+  wait->result = poll(wait->poller->fds, wait->poller->num_fds, wait->timeout);
+#endif
+  wait->error = errno;
+  return NULL;
+}
+
+static void poller_interrupt(void* ptr)
+{
+  poller_t* poller = (poller_t*) ptr;
+  ssize_t result = write(poller->wakeup_writer, ".", 1);
+  (void) result;
+}
+
+static void poller_drain_wakeup(poller_t* poller)
+{
+  char buffer[64];
+  while (read(poller->wakeup_reader, buffer, sizeof(buffer)) > 0);
+}
+
+static VALUE poller_event(VALUE ios, int fd, int readable, int writable)
+{
+  int events = 0;
+  if (readable)
+  {
+    events |= POLLER_READABLE;
+  }
+  if (writable)
+  {
+    events |= POLLER_WRITABLE;
+  }
+  return rb_assoc_new(rb_hash_lookup(ios, INT2FIX(fd)), INT2FIX(events));
+}
+
+/*
+ * Wait for registered IOs to become ready. The GVL is released while
+ * waiting. Errors and hang ups are reported as readable so they are seen by
+ * the next read.
+ *
+ * @param timeout [Float|nil] Maximum number of seconds to wait or nil to wait
+ *   until an IO is ready or {#wakeup} is called
+ * @return [Array<Array(IO, Integer)>] Each ready IO and the events it is
+ *   ready for. Empty if the timeout expired or the wait was woken up.
+ */
+static VALUE poller_wait(int argc, VALUE* argv, VALUE self)
+{
+  poller_t* poller = get_poller(self);
+  poller_wait_t wait;
+  volatile VALUE result = rb_ary_new();
+  int index = 0;
+  int fd = 0;
+  int wakeup = 0;
+
+  if (argc > 1)
+  {
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+  }
+  wait.poller = poller;
+  wait.timeout = -1;
+  if ((argc == 1) && (argv[0] != Qnil))
+  {
+    double timeout = NUM2DBL(argv[0]);
+    wait.timeout = (timeout <= 0.0) ? 0 : (int) ((timeout * 1000.0) + 0.5);
+  }
+
+  rb_thread_call_without_gvl(poller_wait_without_gvl, &wait, poller_interrupt, poller);
+  if (wait.result < 0)
+  {
+    if ((wait.error == EINTR) || (wait.error == EAGAIN))
+    {
+      rb_thread_check_ints();
+      return result;
+    }
+    errno = wait.error;
+    rb_sys_fail("wait");
+  }
+
+#ifdef HAVE_SYS_EPOLL_H
+  for (index = 0; index < wait.result; index++)
+  {
+    unsigned int events = poller->events[index].events;
+    fd = poller->events[index].data.fd;
+    if (fd == poller->wakeup_reader)
+    {
+      wakeup = 1;
+      continue;
+    }
+    rb_ary_push(result, poller_event(poller->ios, fd,
+      events & (EPOLLIN | EPOLLERR | EPOLLHUP), events & EPOLLOUT));
+  }
+#else
+  if (poller->fds[0].revents)
+  {
+    wakeup = 1;
+  }
+  for (index = 1; (index < poller->num_fds) && (RARRAY_LEN(result) < wait.result); index++)
+  {
+    short revents = poller->fds[index].revents;
+    if (revents == 0)
+    {
+      continue;
+    }
+    fd = poller->fds[index].fd;
+    rb_ary_push(result, poller_event(poller->ios, fd,
+      revents & (POLLIN | POLLERR | POLLHUP | POLLNVAL), revents & POLLOUT));
+  }
+#endif
+
+  if (wakeup)
+  {
+    poller_drain_wakeup(poller);
+  }
+  return result;
+}
+
+/*
+ * Wake up a thread blocked in {#wait}. May be called from any thread.
+ */
+static VALUE poller_wakeup(VALUE self)
+{
+  poller_interrupt(get_poller(self));
+  return Qnil;
+}
+
+/*
+ * @return [Integer] The number of registered IOs
+ */
+static VALUE poller_size(VALUE self)
+{
+  return LONG2NUM(RHASH_SIZE(get_poller(self)->ios));
+}
+
+/*
+ * Stop watching every IO and release the wakeup pipe. The registered IOs are
+ * not closed.
+ */
+static VALUE poller_close(VALUE self)
+{
+  poller_t* poller = NULL;
+  TypedData_Get_Struct(self, poller_t, &poller_type, poller);
+  poller_close_fds(poller);
+  if (poller->ios != Qnil)
+  {
+    rb_hash_clear(poller->ios);
+  }
+  return Qnil;
+}
+
+#endif /* COSMOS_NATIVE_POLLER */
+
+void Init_poller(void)
+{
+  mCosmos = rb_define_module("Cosmos");
+
+#ifdef COSMOS_NATIVE_POLLER
+  cPoller = rb_define_class_under(mCosmos, "Poller", rb_cObject);
+  rb_define_const(cPoller, "READABLE", INT2FIX(POLLER_READABLE));
+  rb_define_const(cPoller, "WRITABLE", INT2FIX(POLLER_WRITABLE));
+#ifdef HAVE_SYS_EPOLL_H
+  rb_define_const(cPoller, "BACKEND", ID2SYM(rb_intern("epoll")));
+#else
+  rb_define_const(cPoller, "BACKEND", ID2SYM(rb_intern("poll")));
+#endif
+  rb_define_alloc_func(cPoller, poller_alloc);
+  rb_define_method(cPoller, "initialize", poller_initialize, 0);
+  rb_define_method(cPoller, "register", poller_register, 2);
+  rb_define_method(cPoller, "deregister", poller_deregister, 1);
+  rb_define_method(cPoller, "wait", poller_wait, -1);
+  rb_define_method(cPoller, "wakeup", poller_wakeup, 0);
+  rb_define_method(cPoller, "size", poller_size, 0);
+  rb_define_method(cPoller, "close", poller_close, 0);
+#endif
+}
@@ -0,0 +1,247 @@
+/*
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+*/
+
+#include "ruby.h"
+#include "ruby/encoding.h"
+#include "stdio.h"
+#include "string.h"
+#include "limits.h"
+#include "../receive_buffer/receive_buffer.h"
+
+VALUE mCosmos = Qnil;
+VALUE mPreidentifiedCodec = Qnil;
+
+/*
+ * Preidentified entries are a UINT32 received time seconds, a UINT32
+ * received time microseconds, a UINT8 length prefixed target name, a UINT8
+ * length prefixed packet name, a UINT32 data length and the data. All values
+ * are big endian. The same layout is used by the PreidentifiedStreamProtocol
+ * and by packet log entries.
+ */
+#define PREIDENTIFIED_MAX_HEADER_LENGTH (4 + 4 + 1 + 255 + 1 + 255 + 4)
+
+typedef struct {
+  long header_length;
+  unsigned long time_seconds;
+  unsigned long time_microseconds;
+  const char* target_name;
+  long target_name_length;
+  const char* packet_name;
+  long packet_name_length;
+  unsigned long data_length;
+} preidentified_header_t;
+
+static VALUE new_binary_string(const char* ptr, long length)
+{
+  VALUE string = rb_str_new(ptr, length);
+  rb_enc_associate(string, rb_ascii8bit_encoding());
+  return string;
+}
+
+static unsigned long read_uint32(const unsigned char* data)
+{
+  return ((unsigned long) data[0] << 24) | ((unsigned long) data[1] << 16) |
+         ((unsigned long) data[2] << 8) | (unsigned long) data[3];
+}
+
+static void write_uint32(VALUE buffer, unsigned long value)
+{
+  char bytes[4];
+  bytes[0] = (char) ((value >> 24) & 0xFF);
+  bytes[1] = (char) ((value >> 16) & 0xFF);
+  bytes[2] = (char) ((value >> 8) & 0xFF);
+  bytes[3] = (char) (value & 0xFF);
+  rb_str_cat(buffer, bytes, 4);
+}
+
+/*
+ * Decode an entry header.
+ *
+ * @return 1 if the header is complete. Otherwise 0 with header_length set
+ *   to the number of bytes needed to decode more of the header.
+ */
+static int decode_preidentified_header(const unsigned char* data, long length, preidentified_header_t* header)
+{
+  long index = 8;
+
+  header->header_length = index + 1;
+  if (length < header->header_length)
+  {
+    return 0;
+  }
+  header->time_seconds = read_uint32(data);
+  header->time_microseconds = read_uint32(data + 4);
+
+  header->target_name_length = data[index];
+  header->target_name = (const char*) (data + index + 1);
+  index += 1 + header->target_name_length;
+  header->header_length = index + 1;
+  if (length < header->header_length)
+  {
+    return 0;
+  }
+
+  header->packet_name_length = data[index];
+  header->packet_name = (const char*) (data + index + 1);
+  index += 1 + header->packet_name_length;
+  header->header_length = index + 4;
+  if (length < header->header_length)
+  {
+    return 0;
+  }
+
+  header->data_length = read_uint32(data + index);
+  return 1;
+}
+
+static void check_name(VALUE name, const char* description)
+{
+  StringValue(name);
+  if (RSTRING_LEN(name) > 255)
+  {
+    rb_raise(rb_eArgError, "%s longer than 255 bytes: %ld", description, RSTRING_LEN(name));
+  }
+}
+
+/*
+ * Decode a preidentified entry header
+ *
+ * @param buffer [String] Data holding the header
+ * @param offset [Integer] Offset of the header in the data
+ * @return [Array|nil] The header length, received time seconds, received
+ *   time microseconds, target name, packet name and data length or nil if
+ *   the data does not hold a complete header
+ */
+static VALUE preidentified_decode_header(int argc, VALUE* argv, VALUE self)
+{
+  VALUE buffer = Qnil;
+  long offset = 0;
+  preidentified_header_t header;
+
+  if ((argc < 1) || (argc > 2))
+  {
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+  }
+  buffer = argv[0];
+  StringValue(buffer);
+  if (argc == 2)
+  {
+    offset = NUM2LONG(argv[1]);
+  }
+  if ((offset < 0) || (offset > RSTRING_LEN(buffer)))
+  {
+    rb_raise(rb_eArgError, "offset %ld outside of buffer of length %ld", offset, RSTRING_LEN(buffer));
+  }
+
+  if (!decode_preidentified_header((const unsigned char*) (RSTRING_PTR(buffer) + offset), RSTRING_LEN(buffer) - offset, &header))
+  {
+    return Qnil;
+  }
+  return rb_ary_new3(6,
+    LONG2NUM(header.header_length),
+    ULONG2NUM(header.time_seconds),
+    ULONG2NUM(header.time_microseconds),
+    new_binary_string(header.target_name, header.target_name_length),
+    new_binary_string(header.packet_name, header.packet_name_length),
+    ULONG2NUM(header.data_length));
+}
+
+/*
+ * Append a preidentified entry header to a buffer
+ *
+ * @param buffer [String] Buffer to append to
+ * @param time_seconds [Integer] Received time seconds
+ * @param time_microseconds [Integer] Received time microseconds
+ * @param target_name [String] Target name
+ * @param packet_name [String] Packet name
+ * @param data_length [Integer] Length of the data which follows the header
+ * @return [String] The buffer
+ */
+static VALUE preidentified_encode_header(VALUE self, VALUE buffer, VALUE time_seconds, VALUE time_microseconds, VALUE target_name, VALUE packet_name, VALUE data_length)
+{
+  char length = 0;
+
+  StringValue(buffer);
+  check_name(target_name, "target name");
+  check_name(packet_name, "packet name");
+  rb_str_modify_expand(buffer, 8 + 1 + RSTRING_LEN(target_name) + 1 + RSTRING_LEN(packet_name) + 4);
+
+  write_uint32(buffer, NUM2ULONG(time_seconds));
+  write_uint32(buffer, NUM2ULONG(time_microseconds));
+  length = (char) RSTRING_LEN(target_name);
+  rb_str_cat(buffer, &length, 1);
+  rb_str_cat(buffer, RSTRING_PTR(target_name), RSTRING_LEN(target_name));
+  length = (char) RSTRING_LEN(packet_name);
+  rb_str_cat(buffer, &length, 1);
+  rb_str_cat(buffer, RSTRING_PTR(packet_name), RSTRING_LEN(packet_name));
+  write_uint32(buffer, NUM2ULONG(data_length));
+  return buffer;
+}
+
+/*
+ * Remove a preidentified entry from the front of a receive buffer
+ *
+ * @param buffer [ReceiveBuffer] The received data
+ * @param max_length [Integer|nil] Maximum allowed data length
+ * @return [Array|Integer] The received time seconds, received time
+ *   microseconds, target name, packet name and data or the number of unread
+ *   bytes needed before the entry can be removed
+ */
+static VALUE preidentified_decode_frame(VALUE self, VALUE buffer_value, VALUE max_length)
+{
+  receive_buffer_t* buffer = NULL;
+  const unsigned char* data = NULL;
+  long unread = 0;
+  long frame_length = 0;
+  preidentified_header_t header;
+  volatile VALUE result = Qnil;
+
+  buffer = receive_buffer_get(buffer_value);
+  data = (const unsigned char*) (buffer->data + buffer->start);
+  unread = buffer->end - buffer->start;
+
+  if (!decode_preidentified_header(data, unread, &header))
+  {
+    return LONG2NUM(header.header_length);
+  }
+  if (RTEST(max_length) && (header.data_length > NUM2ULONG(max_length)))
+  {
+    rb_raise(rb_eRuntimeError, "Length value received larger than max_length: %lu > %lu", header.data_length, NUM2ULONG(max_length));
+  }
+  if (header.data_length > (unsigned long) (LONG_MAX - header.header_length))
+  {
+    rb_raise(rb_eRuntimeError, "Length value received too large: %lu", header.data_length);
+  }
+  frame_length = header.header_length + (long) header.data_length;
+  if (unread < frame_length)
+  {
+    return LONG2NUM(frame_length);
+  }
+
+  result = rb_ary_new3(5,
+    ULONG2NUM(header.time_seconds),
+    ULONG2NUM(header.time_microseconds),
+    new_binary_string(header.target_name, header.target_name_length),
+    new_binary_string(header.packet_name, header.packet_name_length),
+    new_binary_string((const char*) (data + header.header_length), (long) header.data_length));
+  buffer->start += frame_length;
+  return result;
+}
+
+void Init_preidentified_codec(void)
+{
+  mCosmos = rb_define_module("Cosmos");
+
+  mPreidentifiedCodec = rb_define_module_under(mCosmos, "PreidentifiedCodec");
+  rb_define_const(mPreidentifiedCodec, "MAX_HEADER_LENGTH", INT2FIX(PREIDENTIFIED_MAX_HEADER_LENGTH));
+  rb_define_module_function(mPreidentifiedCodec, "decode_header", preidentified_decode_header, -1);
+  rb_define_module_function(mPreidentifiedCodec, "encode_header", preidentified_encode_header, 6);
+  rb_define_module_function(mPreidentifiedCodec, "decode_frame", preidentified_decode_frame, 2);
+}
@@ -0,0 +1,778 @@
+/*
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+*/
+
+#include "ruby.h"
+#include "ruby/encoding.h"
+#include "stdio.h"
+#include "string.h"
+#include "limits.h"
+#include "receive_buffer.h"
+
+VALUE mCosmos = Qnil;
+VALUE cReceiveBuffer = Qnil;
+VALUE cLengthFramer = Qnil;
+VALUE cTerminatedFramer = Qnil;
+
+/* Initial capacity of a buffer if none is given */
+#define DEFAULT_CAPACITY 4096
+
+static void receive_buffer_free(void* ptr)
+{
+  receive_buffer_t* buffer = (receive_buffer_t*) ptr;
+  if (buffer->data)
+  {
+    xfree(buffer->data);
+  }
+  xfree(buffer);
+}
+
+static size_t receive_buffer_memsize(const void* ptr)
+{
+  const receive_buffer_t* buffer = (const receive_buffer_t*) ptr;
+  return sizeof(receive_buffer_t) + buffer->capacity;
+}
+
+static const rb_data_type_t receive_buffer_type = {
+  RECEIVE_BUFFER_TYPE_NAME,
+  {NULL, receive_buffer_free, receive_buffer_memsize,},
+  NULL, NULL, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE receive_buffer_alloc(VALUE klass)
+{
+  receive_buffer_t* buffer = NULL;
+  VALUE self = TypedData_Make_Struct(klass, receive_buffer_t, &receive_buffer_type, buffer);
+  buffer->data = NULL;
+  buffer->capacity = 0;
+  buffer->start = 0;
+  buffer->end = 0;
+  return self;
+}
+
+static receive_buffer_t* get_buffer(VALUE self)
+{
+  receive_buffer_t* buffer = NULL;
+  TypedData_Get_Struct(self, receive_buffer_t, &receive_buffer_type, buffer);
+  return buffer;
+}
+
+static VALUE new_binary_string(const char* ptr, long length)
+{
+  VALUE string = rb_str_new(ptr, length);
+  rb_enc_associate(string, rb_ascii8bit_encoding());
+  return string;
+}
+
+/*
+ * Clamp a range of the unread data the same way String#[] does.
+ *
+ * @return 0 if the offset is outside of the unread data
+ */
+static int clamp_range(receive_buffer_t* buffer, long* offset, long* length)
+{
+  long unread = buffer->end - buffer->start;
+  if ((*offset < 0) || (*offset > unread) || (*length < 0))
+  {
+    return 0;
+  }
+  if ((*offset + *length) > unread)
+  {
+    *length = unread - *offset;
+  }
+  return 1;
+}
+
+/*
+ * Create an empty buffer
+ *
+ * @param capacity [Integer] Number of bytes to allocate initially. The
+ *   buffer grows as needed.
+ */
+static VALUE receive_buffer_initialize(int argc, VALUE* argv, VALUE self)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  long capacity = DEFAULT_CAPACITY;
+
+  if (argc > 1)
+  {
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+  }
+  if ((argc == 1) && RTEST(argv[0]))
+  {
+    capacity = NUM2LONG(argv[0]);
+    if (capacity <= 0)
+    {
+      rb_raise(rb_eArgError, "capacity must be greater than 0: %ld", capacity);
+    }
+  }
+
+  if (buffer->data)
+  {
+    xfree(buffer->data);
+  }
+  buffer->data = ALLOC_N(char, capacity);
+  buffer->capacity = capacity;
+  buffer->start = 0;
+  buffer->end = 0;
+  return self;
+}
+
+/*
+ * Append data to the end of the buffer
+ *
+ * @param data [String] The data to append
+ * @return [ReceiveBuffer] self
+ */
+static VALUE receive_buffer_append(VALUE self, VALUE data)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  long length = 0;
+  long unread = 0;
+
+  StringValue(data);
+  length = RSTRING_LEN(data);
+  if (length == 0)
+  {
+    return self;
+  }
+
+  unread = buffer->end - buffer->start;
+  if (unread == 0)
+  {
+    buffer->start = 0;
+    buffer->end = 0;
+  }
+
+  if ((buffer->end + length) > buffer->capacity)
+  {
+    if (((unread + length) <= buffer->capacity) && (buffer->start >= unread))
+    {
+      /* Compact in place */
+      memmove(buffer->data, buffer->data + buffer->start, unread);
+    }
+    else
+    {
+      /* Grow and compact into the new allocation */
+      long capacity = buffer->capacity * 2;
+      char* data_ptr = NULL;
+      if (capacity < (unread + length))
+      {
+        capacity = unread + length;
+      }
+      data_ptr = ALLOC_N(char, capacity);
+      memcpy(data_ptr, buffer->data + buffer->start, unread);
+      xfree(buffer->data);
+      buffer->data = data_ptr;
+      buffer->capacity = capacity;
+    }
+    buffer->start = 0;
+    buffer->end = unread;
+  }
+
+  memcpy(buffer->data + buffer->end, RSTRING_PTR(data), length);
+  buffer->end += length;
+  return self;
+}
+
+/*
+ * @return [Integer] Number of unread bytes
+ */
+static VALUE receive_buffer_length(VALUE self)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  return LONG2NUM(buffer->end - buffer->start);
+}
+
+/*
+ * @return [Boolean] Whether there are no unread bytes
+ */
+static VALUE receive_buffer_empty(VALUE self)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  return (buffer->end == buffer->start) ? Qtrue : Qfalse;
+}
+
+/*
+ * @param index [Integer] Offset into the unread bytes
+ * @return [Integer|nil] The byte at the offset or nil if it is past the end
+ */
+static VALUE receive_buffer_getbyte(VALUE self, VALUE index)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  long offset = NUM2LONG(index);
+  if ((offset < 0) || (offset >= (buffer->end - buffer->start)))
+  {
+    return Qnil;
+  }
+  return INT2FIX((unsigned char) buffer->data[buffer->start + offset]);
+}
+
+/*
+ * Find a pattern in the unread bytes
+ *
+ * @param pattern [String] The bytes to search for
+ * @param offset [Integer] Offset into the unread bytes to start searching at
+ * @return [Integer|nil] Offset of the pattern from the first unread byte or
+ *   nil if it was not found
+ */
+static VALUE receive_buffer_index(int argc, VALUE* argv, VALUE self)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  VALUE pattern = Qnil;
+  long offset = 0;
+  long pattern_length = 0;
+  const char* pattern_ptr = NULL;
+  const char* search = NULL;
+  const char* last = NULL;
+
+  if ((argc < 1) || (argc > 2))
+  {
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+  }
+  pattern = argv[0];
+  StringValue(pattern);
+  if (argc == 2)
+  {
+    offset = NUM2LONG(argv[1]);
+  }
+  if ((offset < 0) || (offset > (buffer->end - buffer->start)))
+  {
+    return Qnil;
+  }
+
+  pattern_length = RSTRING_LEN(pattern);
+  if (pattern_length == 0)
+  {
+    return LONG2NUM(offset);
+  }
+  pattern_ptr = RSTRING_PTR(pattern);
+  search = buffer->data + buffer->start + offset;
+  last = buffer->data + buffer->end - pattern_length;
+  while (search <= last)
+  {
+    search = (const char*) memchr(search, pattern_ptr[0], (last - search) + 1);
+    if (!search)
+    {
+      break;
+    }
+    if (memcmp(search, pattern_ptr, pattern_length) == 0)
+    {
+      return LONG2NUM(search - (buffer->data + buffer->start));
+    }
+    search++;
+  }
+  return Qnil;
+}
+
+/*
+ * Copy unread bytes without consuming them
+ *
+ * @param offset [Integer] Offset into the unread bytes
+ * @param length [Integer] Number of bytes to copy. Fewer bytes are returned
+ *   if there are not enough unread bytes.
+ * @return [String|nil] The bytes or nil if the offset is past the end
+ */
+static VALUE receive_buffer_peek(VALUE self, VALUE offset, VALUE length)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  long start = NUM2LONG(offset);
+  long count = NUM2LONG(length);
+  if (!clamp_range(buffer, &start, &count))
+  {
+    return Qnil;
+  }
+  return new_binary_string(buffer->data + buffer->start + start, count);
+}
+
+/*
+ * Remove bytes from the front of the unread bytes and return them
+ *
+ * @param length [Integer] Number of bytes to remove. Fewer bytes are
+ *   returned if there are not enough unread bytes.
+ * @return [String] The bytes removed
+ */
+static VALUE receive_buffer_shift(VALUE self, VALUE length)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  long start = 0;
+  long count = NUM2LONG(length);
+  VALUE string = Qnil;
+  if (!clamp_range(buffer, &start, &count))
+  {
+    rb_raise(rb_eArgError, "length must not be negative: %ld", count);
+  }
+  string = new_binary_string(buffer->data + buffer->start, count);
+  buffer->start += count;
+  return string;
+}
+
+/*
+ * Remove bytes from the front of the unread bytes without copying them
+ *
+ * @param length [Integer] Number of bytes to remove
+ * @return [ReceiveBuffer] self
+ */
+static VALUE receive_buffer_discard(VALUE self, VALUE length)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  long start = 0;
+  long count = NUM2LONG(length);
+  if (!clamp_range(buffer, &start, &count))
+  {
+    rb_raise(rb_eArgError, "length must not be negative: %ld", count);
+  }
+  buffer->start += count;
+  return self;
+}
+
+/*
+ * Remove all the bytes from the buffer
+ *
+ * @return [ReceiveBuffer] self
+ */
+static VALUE receive_buffer_clear(VALUE self)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  buffer->start = 0;
+  buffer->end = 0;
+  return self;
+}
+
+/*
+ * @return [String] Copy of all the unread bytes
+ */
+static VALUE receive_buffer_to_s(VALUE self)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  return new_binary_string(buffer->data + buffer->start, buffer->end - buffer->start);
+}
+
+/*
+ * Record the current read position so bytes consumed after it can be
+ * restored with {#rewind}. The checkpoint is only valid until data is next
+ * appended or the buffer is cleared.
+ *
+ * @return [Integer] The checkpoint
+ */
+static VALUE receive_buffer_checkpoint(VALUE self)
+{
+  return LONG2NUM(get_buffer(self)->start);
+}
+
+/*
+ * Restore bytes consumed since a checkpoint
+ *
+ * @param checkpoint [Integer] Value returned by {#checkpoint}
+ * @return [ReceiveBuffer] self
+ */
+static VALUE receive_buffer_rewind(VALUE self, VALUE checkpoint)
+{
+  receive_buffer_t* buffer = get_buffer(self);
+  long start = NUM2LONG(checkpoint);
+  if ((start < 0) || (start > buffer->start))
+  {
+    rb_raise(rb_eArgError, "invalid checkpoint: %ld", start);
+  }
+  buffer->start = start;
+  return self;
+}
+
+/*
+ * Length field and sync pattern settings of a LengthStreamProtocol. The
+ * length field must be byte aligned.
+ */
+typedef struct {
+  long byte_offset;
+  long byte_size;
+  int little_endian;
+  long value_offset;
+  long bytes_per_count;
+  long long max_length;
+  long bytes_needed;
+  char* sync_pattern;
+  long sync_length;
+} length_framer_t;
+
+static void length_framer_free(void* ptr)
+{
+  length_framer_t* framer = (length_framer_t*) ptr;
+  if (framer->sync_pattern)
+  {
+    xfree(framer->sync_pattern);
+  }
+  xfree(framer);
+}
+
+static size_t length_framer_memsize(const void* ptr)
+{
+  const length_framer_t* framer = (const length_framer_t*) ptr;
+  return sizeof(length_framer_t) + framer->sync_length;
+}
+
+static const rb_data_type_t length_framer_type = {
+  "Cosmos::LengthFramer",
+  {NULL, length_framer_free, length_framer_memsize,},
+  NULL, NULL, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE length_framer_alloc(VALUE klass)
+{
+  length_framer_t* framer = NULL;
+  VALUE self = TypedData_Make_Struct(klass, length_framer_t, &length_framer_type, framer);
+  framer->sync_pattern = NULL;
+  framer->sync_length = 0;
+  return self;
+}
+
+static length_framer_t* get_framer(VALUE self)
+{
+  length_framer_t* framer = NULL;
+  TypedData_Get_Struct(self, length_framer_t, &length_framer_type, framer);
+  return framer;
+}
+
+/*
+ * @param bit_offset [Integer] Bit offset of the length field. Must be a
+ *   multiple of 8.
+ * @param bit_size [Integer] Bit size of the length field. Must be 8, 16, 24,
+ *   32, 40, 48, 56 or 64.
+ * @param value_offset [Integer] Offset added to the length value after
+ *   multiplying by bytes_per_count
+ * @param bytes_per_count [Integer] Number of bytes per length field count
+ * @param endianness [Symbol] :BIG_ENDIAN or :LITTLE_ENDIAN
+ * @param max_length [Integer|nil] Maximum allowed length value
+ * @param sync_pattern [String|nil] Sync pattern every frame must start with
+ */
+static VALUE length_framer_initialize(VALUE self, VALUE bit_offset, VALUE bit_size, VALUE value_offset, VALUE bytes_per_count, VALUE endianness, VALUE max_length, VALUE sync_pattern)
+{
+  length_framer_t* framer = get_framer(self);
+  long offset = NUM2LONG(bit_offset);
+  long size = NUM2LONG(bit_size);
+
+  if ((offset < 0) || ((offset % 8) != 0))
+  {
+    rb_raise(rb_eArgError, "bit_offset must be a non-negative multiple of 8: %ld", offset);
+  }
+  if ((size < 8) || (size > 64) || ((size % 8) != 0))
+  {
+    rb_raise(rb_eArgError, "bit_size must be a multiple of 8 from 8 to 64: %ld", size);
+  }
+
+  framer->byte_offset = offset / 8;
+  framer->byte_size = size / 8;
+  framer->bytes_needed = framer->byte_offset + framer->byte_size;
+  framer->little_endian = (rb_to_id(endianness) == rb_intern("LITTLE_ENDIAN"));
+  framer->value_offset = NUM2LONG(value_offset);
+  framer->bytes_per_count = NUM2LONG(bytes_per_count);
+  if (framer->bytes_per_count <= 0)
+  {
+    rb_raise(rb_eArgError, "bytes_per_count must be greater than 0: %ld", framer->bytes_per_count);
+  }
+  framer->max_length = RTEST(max_length) ? NUM2LL(max_length) : -1;
+
+  if (framer->sync_pattern)
+  {
+    xfree(framer->sync_pattern);
+    framer->sync_pattern = NULL;
+    framer->sync_length = 0;
+  }
+  if (RTEST(sync_pattern))
+  {
+    StringValue(sync_pattern);
+    framer->sync_length = RSTRING_LEN(sync_pattern);
+    framer->sync_pattern = ALLOC_N(char, framer->sync_length);
+    memcpy(framer->sync_pattern, RSTRING_PTR(sync_pattern), framer->sync_length);
+  }
+  return self;
+}
+
+/*
+ * Remove every complete frame from the front of a receive buffer. The first
+ * frame must already be synchronized. Later frames must start with the sync
+ * pattern and framing stops at the first one that does not so the stream
+ * protocol can resynchronize.
+ *
+ * @param buffer [ReceiveBuffer] The received data
+ * @param frames [Array<String>] Array the frames are appended to
+ * @return [Integer] Number of unread bytes needed before the next frame can
+ *   be removed
+ */
+static VALUE length_framer_frame(VALUE self, VALUE buffer_value, VALUE frames)
+{
+  length_framer_t* framer = get_framer(self);
+  receive_buffer_t* buffer = NULL;
+  int first = 1;
+
+  TypedData_Get_Struct(buffer_value, receive_buffer_t, &receive_buffer_type, buffer);
+  Check_Type(frames, T_ARRAY);
+
+  while (1)
+  {
+    const unsigned char* data = (const unsigned char*) (buffer->data + buffer->start);
+    long unread = buffer->end - buffer->start;
+    unsigned long long length = 0;
+    long long packet_length = 0;
+    long index = 0;
+
+    if (!first && framer->sync_length)
+    {
+      if ((unread < framer->sync_length) || (memcmp(data, framer->sync_pattern, framer->sync_length) != 0))
+      {
+        return LONG2NUM(framer->sync_length);
+      }
+    }
+    if (unread < framer->bytes_needed)
+    {
+      return LONG2NUM(framer->bytes_needed);
+    }
+
+    if (framer->little_endian)
+    {
+      for (index = framer->byte_size - 1; index >= 0; index--)
+      {
+        length = (length << 8) | data[framer->byte_offset + index];
+      }
+    }
+    else
+    {
+      for (index = 0; index < framer->byte_size; index++)
+      {
+        length = (length << 8) | data[framer->byte_offset + index];
+      }
+    }
+
+    /* Errors in later frames are raised by the next call so the frames
+     * before them are returned first */
+    if ((framer->max_length >= 0) && (length > (unsigned long long) framer->max_length))
+    {
+      if (!first) break;
+      rb_raise(rb_eRuntimeError, "Length value received larger than max_length: %llu > %lld", length, framer->max_length);
+    }
+    if (length > (unsigned long long) (LONG_MAX / framer->bytes_per_count))
+    {
+      if (!first) break;
+      rb_raise(rb_eRuntimeError, "Length value received too large: %llu", length);
+    }
+    packet_length = ((long long) length * framer->bytes_per_count) + framer->value_offset;
+    if ((packet_length <= 0) || (packet_length > LONG_MAX))
+    {
+      if (!first) break;
+      rb_raise(rb_eRuntimeError, "Length value received gives an invalid packet length: %lld", packet_length);
+    }
+    if (unread < packet_length)
+    {
+      return LONG2NUM((long) packet_length);
+    }
+
+    rb_ary_push(frames, new_binary_string((const char*) data, (long) packet_length));
+    buffer->start += (long) packet_length;
+    first = 0;
+  }
+  return LONG2NUM(framer->bytes_needed);
+}
+
+/*
+ * Termination characters and sync pattern settings of a
+ * TerminatedStreamProtocol
+ */
+typedef struct {
+  char* termination;
+  long termination_length;
+  int strip;
+  char* sync_pattern;
+  long sync_length;
+} terminated_framer_t;
+
+static void terminated_framer_free(void* ptr)
+{
+  terminated_framer_t* framer = (terminated_framer_t*) ptr;
+  if (framer->termination)
+  {
+    xfree(framer->termination);
+  }
+  if (framer->sync_pattern)
+  {
+    xfree(framer->sync_pattern);
+  }
+  xfree(framer);
+}
+
+static size_t terminated_framer_memsize(const void* ptr)
+{
+  const terminated_framer_t* framer = (const terminated_framer_t*) ptr;
+  return sizeof(terminated_framer_t) + framer->termination_length + framer->sync_length;
+}
+
+static const rb_data_type_t terminated_framer_type = {
+  "Cosmos::TerminatedFramer",
+  {NULL, terminated_framer_free, terminated_framer_memsize,},
+  NULL, NULL, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE terminated_framer_alloc(VALUE klass)
+{
+  terminated_framer_t* framer = NULL;
+  VALUE self = TypedData_Make_Struct(klass, terminated_framer_t, &terminated_framer_type, framer);
+  framer->termination = NULL;
+  framer->termination_length = 0;
+  framer->sync_pattern = NULL;
+  framer->sync_length = 0;
+  return self;
+}
+
+static terminated_framer_t* get_terminated_framer(VALUE self)
+{
+  terminated_framer_t* framer = NULL;
+  TypedData_Get_Struct(self, terminated_framer_t, &terminated_framer_type, framer);
+  return framer;
+}
+
+static char* copy_string(VALUE string, long* length)
+{
+  char* copy = NULL;
+  StringValue(string);
+  *length = RSTRING_LEN(string);
+  copy = ALLOC_N(char, *length + 1);
+  memcpy(copy, RSTRING_PTR(string), *length);
+  return copy;
+}
+
+/*
+ * @param termination [String] Termination characters at the end of each
+ *   frame
+ * @param strip [Boolean] Whether to remove the termination characters from
+ *   the frames
+ * @param sync_pattern [String|nil] Sync pattern every frame must start with
+ */
+static VALUE terminated_framer_initialize(VALUE self, VALUE termination, VALUE strip, VALUE sync_pattern)
+{
+  terminated_framer_t* framer = get_terminated_framer(self);
+
+  if (framer->termination)
+  {
+    xfree(framer->termination);
+    framer->termination = NULL;
+  }
+  if (framer->sync_pattern)
+  {
+    xfree(framer->sync_pattern);
+    framer->sync_pattern = NULL;
+    framer->sync_length = 0;
+  }
+
+  framer->termination = copy_string(termination, &framer->termination_length);
+  if (framer->termination_length == 0)
+  {
+    rb_raise(rb_eArgError, "termination characters must not be empty");
+  }
+  framer->strip = RTEST(strip);
+  if (RTEST(sync_pattern))
+  {
+    framer->sync_pattern = copy_string(sync_pattern, &framer->sync_length);
+  }
+  return self;
+}
+
+/*
+ * Remove every complete frame from the front of a receive buffer in one pass
+ * over the data. The first frame must already be synchronized. Later frames
+ * must start with the sync pattern and framing stops at the first one that
+ * does not so the stream protocol can resynchronize.
+ *
+ * @param buffer [ReceiveBuffer] The received data
+ * @param frames [Array<String>] Array the frames are appended to
+ * @return [Integer] Number of unread bytes needed before the next frame can
+ *   be removed
+ */
+static VALUE terminated_framer_frame(VALUE self, VALUE buffer_value, VALUE frames)
+{
+  terminated_framer_t* framer = get_terminated_framer(self);
+  receive_buffer_t* buffer = NULL;
+  const char* search = NULL;
+  const char* last = NULL;
+  int first = 1;
+
+  TypedData_Get_Struct(buffer_value, receive_buffer_t, &receive_buffer_type, buffer);
+  Check_Type(frames, T_ARRAY);
+
+  search = buffer->data + buffer->start;
+  last = buffer->data + buffer->end - framer->termination_length;
+  while (search <= last)
+  {
+    const char* frame = buffer->data + buffer->start;
+    long frame_length = 0;
+
+    if (!first && framer->sync_length)
+    {
+      if (((buffer->end - buffer->start) < framer->sync_length) ||
+          (memcmp(frame, framer->sync_pattern, framer->sync_length) != 0))
+      {
+        break;
+      }
+    }
+
+    search = (const char*) memchr(search, framer->termination[0], (last - search) + 1);
+    if (!search)
+    {
+      break;
+    }
+    if (memcmp(search, framer->termination, framer->termination_length) != 0)
+    {
+      search++;
+      continue;
+    }
+
+    frame_length = search - frame;
+    if (!framer->strip)
+    {
+      frame_length += framer->termination_length;
+    }
+    rb_ary_push(frames, new_binary_string(frame, frame_length));
+    search += framer->termination_length;
+    buffer->start = search - buffer->data;
+    first = 0;
+  }
+
+  return LONG2NUM((buffer->end - buffer->start) + 1);
+}
+
+void Init_receive_buffer(void)
+{
+  mCosmos = rb_define_module("Cosmos");
+
+  cReceiveBuffer = rb_define_class_under(mCosmos, "ReceiveBuffer", rb_cObject);
+  rb_define_alloc_func(cReceiveBuffer, receive_buffer_alloc);
+  rb_define_const(cReceiveBuffer, "DEFAULT_CAPACITY", INT2FIX(DEFAULT_CAPACITY));
+  rb_define_method(cReceiveBuffer, "initialize", receive_buffer_initialize, -1);
+  rb_define_method(cReceiveBuffer, "<<", receive_buffer_append, 1);
+  rb_define_method(cReceiveBuffer, "append", receive_buffer_append, 1);
+  rb_define_method(cReceiveBuffer, "length", receive_buffer_length, 0);
+  rb_define_method(cReceiveBuffer, "size", receive_buffer_length, 0);
+  rb_define_method(cReceiveBuffer, "empty?", receive_buffer_empty, 0);
+  rb_define_method(cReceiveBuffer, "getbyte", receive_buffer_getbyte, 1);
+  rb_define_method(cReceiveBuffer, "index", receive_buffer_index, -1);
+  rb_define_method(cReceiveBuffer, "peek", receive_buffer_peek, 2);
+  rb_define_method(cReceiveBuffer, "shift", receive_buffer_shift, 1);
+  rb_define_method(cReceiveBuffer, "discard", receive_buffer_discard, 1);
+  rb_define_method(cReceiveBuffer, "clear", receive_buffer_clear, 0);
+  rb_define_method(cReceiveBuffer, "to_s", receive_buffer_to_s, 0);
+  rb_define_method(cReceiveBuffer, "checkpoint", receive_buffer_checkpoint, 0);
+  rb_define_method(cReceiveBuffer, "rewind", receive_buffer_rewind, 1);
+
+  cLengthFramer = rb_define_class_under(mCosmos, "LengthFramer", rb_cObject);
+  rb_define_alloc_func(cLengthFramer, length_framer_alloc);
+  rb_define_method(cLengthFramer, "initialize", length_framer_initialize, 7);
+  rb_define_method(cLengthFramer, "frame", length_framer_frame, 2);
+
+  cTerminatedFramer = rb_define_class_under(mCosmos, "TerminatedFramer", rb_cObject);
+  rb_define_alloc_func(cTerminatedFramer, terminated_framer_alloc);
+  rb_define_method(cTerminatedFramer, "initialize", terminated_framer_initialize, 3);
+  rb_define_method(cTerminatedFramer, "frame", terminated_framer_frame, 2);
+}
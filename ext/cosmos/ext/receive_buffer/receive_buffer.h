@@ -0,0 +1,48 @@
+/*
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+*/
+
+#ifndef RECEIVE_BUFFER_H
+#define RECEIVE_BUFFER_H
+
+#include "ruby.h"
+#include "string.h"
+
+/* Name of the ReceiveBuffer data type */
+#define RECEIVE_BUFFER_TYPE_NAME "Cosmos::ReceiveBuffer"
+
+/*
+ * Bytes between start and end are unread. Consuming bytes only advances
+ * start. The unread bytes are moved back to the beginning of the allocation
+ * when data is appended and the consumed space is at least as large as the
+ * unread data so each byte is moved a bounded number of times.
+ */
+typedef struct {
+  char* data;
+  long capacity;
+  long start;
+  long end;
+} receive_buffer_t;
+
+/*
+ * Get the buffer of a ReceiveBuffer passed to a framer in another extension.
+ * Each extension is loaded separately so the data type is checked by name
+ * rather than by the rb_data_type_t in receive_buffer.c.
+ */
+static inline receive_buffer_t* receive_buffer_get(VALUE value)
+{
+  if (!RB_TYPE_P(value, T_DATA) || !RTYPEDDATA_P(value) ||
+      (strcmp(RTYPEDDATA_TYPE(value)->wrap_struct_name, RECEIVE_BUFFER_TYPE_NAME) != 0))
+  {
+    rb_raise(rb_eTypeError, "wrong argument type %s (expected %s)", rb_obj_classname(value), RECEIVE_BUFFER_TYPE_NAME);
+  }
+  return (receive_buffer_t*) RTYPEDDATA_DATA(value);
+}
+
+#endif
@@ -0,0 +1,19 @@
+require 'mkmf'
+
+unless $CFLAGS.gsub!(/ -O[\dsz]?/, ' -O3')
+  $CFLAGS << ' -O3'
+end
+if CONFIG['CC'] =~ /gcc/
+  $CFLAGS << ' -Wall'
+  if $DEBUG && !$CFLAGS.gsub!(/ -O[\dsz]?/, ' -O0 -ggdb')
+    $CFLAGS << ' -O0 -ggdb'
+  end
+end
+
+have_header('pthread.h')
+have_header('poll.h')
+# Driver error counters are only available on Linux
+have_header('linux/serial.h')
+have_func('rb_io_descriptor', 'ruby/io.h')
+
+create_makefile 'cosmos/ext/serial_reader'
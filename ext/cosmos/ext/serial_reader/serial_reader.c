@@ -0,0 +1,560 @@
+/*
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+*/
+
+#include "ruby.h"
+#include "ruby/io.h"
+#include "ruby/thread.h"
+#include "errno.h"
+
+/* Windows uses the Win32SerialDriver and platforms without pthreads read in
+ * the calling thread in lib/cosmos/io/posix_serial_driver.rb */
+#if !defined(_WIN32) && defined(HAVE_PTHREAD_H) && defined(HAVE_POLL_H)
+#define COSMOS_NATIVE_SERIAL_READER 1
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#ifdef HAVE_LINUX_SERIAL_H
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+#endif
+#endif
+
+VALUE mCosmos = Qnil;
+VALUE cSerialReader = Qnil;
+
+#ifdef COSMOS_NATIVE_SERIAL_READER
+
+/* Maximum number of bytes requested by one read of the serial port */
+#define SERIAL_READER_CHUNK 65536
+
+static ID id_bytes_read;
+static ID id_bytes_dropped;
+static ID id_high_water_mark;
+static ID id_frame;
+static ID id_overrun;
+static ID id_parity;
+static ID id_break;
+static ID id_buffer_overrun;
+
+typedef struct {
+  int fd;
+  /* Pipe written to stop the reader thread */
+  int stop_reader;
+  int stop_writer;
+  /* Ring buffer filled by the reader thread */
+  char* ring;
+  size_t capacity;
+  size_t head;
+  size_t length;
+  size_t high_water_mark;
+  unsigned long long bytes_read;
+  unsigned long long bytes_dropped;
+  /* errno of the failed read or -1 at end of file */
+  int error;
+  int running;
+  /* Set by the unblocking function to end a wait */
+  int interrupted;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t data_available;
+  VALUE io;
+} serial_reader_t;
+
+/* Arguments to the wait performed without the GVL */
+typedef struct {
+  serial_reader_t* reader;
+  double timeout;
+} serial_reader_wait_t;
+
+static void serial_reader_mark(void* ptr)
+{
+  serial_reader_t* reader = (serial_reader_t*) ptr;
+  rb_gc_mark(reader->io);
+}
+
+/*
+ * Stops the reader thread. Safe to call without the GVL.
+ */
+static void* serial_reader_stop_thread(void* ptr)
+{
+  serial_reader_t* reader = (serial_reader_t*) ptr;
+  char byte = 0;
+  if (reader->running)
+  {
+    if (write(reader->stop_writer, &byte, 1) < 0)
+    {
+      /* The pipe is never full since only one byte is ever written */
+    }
+    pthread_join(reader->thread, NULL);
+    reader->running = 0;
+  }
+  if (reader->stop_reader >= 0)
+  {
+    close(reader->stop_reader);
+    close(reader->stop_writer);
+    reader->stop_reader = -1;
+    reader->stop_writer = -1;
+  }
+  return NULL;
+}
+
+static void serial_reader_free(void* ptr)
+{
+  serial_reader_t* reader = (serial_reader_t*) ptr;
+  serial_reader_stop_thread(reader);
+  if (reader->ring)
+  {
+    xfree(reader->ring);
+    pthread_mutex_destroy(&reader->mutex);
+    pthread_cond_destroy(&reader->data_available);
+  }
+  xfree(reader);
+}
+
+static size_t serial_reader_memsize(const void* ptr)
+{
+  const serial_reader_t* reader = (const serial_reader_t*) ptr;
+  return sizeof(serial_reader_t) + reader->capacity;
+}
+
+static const rb_data_type_t serial_reader_type = {
+  "Cosmos::SerialReader",
+  {serial_reader_mark, serial_reader_free, serial_reader_memsize,},
+  NULL, NULL, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE serial_reader_alloc(VALUE klass)
+{
+  serial_reader_t* reader = NULL;
+  VALUE self = TypedData_Make_Struct(klass, serial_reader_t, &serial_reader_type, reader);
+  reader->fd = -1;
+  reader->stop_reader = -1;
+  reader->stop_writer = -1;
+  reader->io = Qnil;
+  return self;
+}
+
+static serial_reader_t* get_serial_reader(VALUE self)
+{
+  serial_reader_t* reader = NULL;
+  TypedData_Get_Struct(self, serial_reader_t, &serial_reader_type, reader);
+  if (!reader->ring)
+  {
+    rb_raise(rb_eRuntimeError, "uninitialized serial reader");
+  }
+  return reader;
+}
+
+/*
+ * Body of the native reader thread. Never touches Ruby objects. Reads the
+ * serial port directly into the free space of the ring buffer. Data read
+ * while the ring buffer is full is dropped and counted.
+ */
+static void* serial_reader_thread(void* ptr)
+{
+  serial_reader_t* reader = (serial_reader_t*) ptr;
+  struct pollfd fds[2];
+  char* scratch = malloc(SERIAL_READER_CHUNK);
+  char* destination = NULL;
+  size_t tail = 0;
+  size_t space = 0;
+  ssize_t result = 0;
+
+  fds[0].fd = reader->fd;
+  fds[0].events = POLLIN;
+  fds[1].fd = reader->stop_reader;
+  fds[1].events = POLLIN;
+
+  while (1)
+  {
+    fds[0].revents = 0;
+    fds[1].revents = 0;
+    if (poll(fds, 2, -1) < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      result = -errno;
+      break;
+    }
+    if (fds[1].revents)
+    {
+      result = 0;
+      break;
+    }
+
+    /* Only the reader thread adds data so the free space can only grow
+     * until this thread adds to it */
+    pthread_mutex_lock(&reader->mutex);
+    tail = (reader->head + reader->length) % reader->capacity;
+    space = reader->capacity - reader->length;
+    if (tail + space > reader->capacity)
+    {
+      space = reader->capacity - tail;
+    }
+    pthread_mutex_unlock(&reader->mutex);
+
+    if (space > SERIAL_READER_CHUNK)
+    {
+      space = SERIAL_READER_CHUNK;
+    }
+    if (space > 0)
+    {
+      destination = reader->ring + tail;
+    }
+    else
+    {
+      destination = scratch;
+      space = SERIAL_READER_CHUNK;
+    }
+
+    result = read(reader->fd, destination, space);
+    if (result < 0)
+    {
+      if ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK))
+      {
+        continue;
+      }
+      result = -errno;
+      break;
+    }
+    if (result == 0)
+    {
+      result = -1;
+      break;
+    }
+
+    pthread_mutex_lock(&reader->mutex);
+    reader->bytes_read += result;
+    if (destination == scratch)
+    {
+      reader->bytes_dropped += result;
+    }
+    else
+    {
+      reader->length += result;
+      if (reader->length > reader->high_water_mark)
+      {
+        reader->high_water_mark = reader->length;
+      }
+    }
+    pthread_cond_broadcast(&reader->data_available);
+    pthread_mutex_unlock(&reader->mutex);
+  }
+
+  if (result != 0)
+  {
+    pthread_mutex_lock(&reader->mutex);
+    reader->error = (result == -1) ? -1 : (int) -result;
+    pthread_cond_broadcast(&reader->data_available);
+    pthread_mutex_unlock(&reader->mutex);
+  }
+  free(scratch);
+  return NULL;
+}
+
+/*
+ * Starts a native thread which reads the serial port into a ring buffer
+ *
+ * @param io [IO] The open serial port
+ * @param buffer_size [Integer] Size of the ring buffer in bytes
+ */
+static VALUE serial_reader_initialize(VALUE self, VALUE io, VALUE buffer_size)
+{
+  serial_reader_t* reader = NULL;
+  rb_io_t* fptr = NULL;
+  long capacity = NUM2LONG(buffer_size);
+  int fds[2];
+  int result = 0;
+
+  TypedData_Get_Struct(self, serial_reader_t, &serial_reader_type, reader);
+  if (reader->ring)
+  {
+    rb_raise(rb_eRuntimeError, "serial reader already initialized");
+  }
+  if (capacity <= 0)
+  {
+    rb_raise(rb_eArgError, "buffer_size must be positive: %ld", capacity);
+  }
+
+  io = rb_io_get_io(io);
+  GetOpenFile(io, fptr);
+  rb_io_check_closed(fptr);
+#ifdef HAVE_RB_IO_DESCRIPTOR
+  reader->fd = rb_io_descriptor(io);
+#else
+  reader->fd = fptr->fd;
+#endif
+  reader->io = io;
+
+  if (pipe(fds) != 0)
+  {
+    rb_sys_fail("pipe");
+  }
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+  reader->stop_reader = fds[0];
+  reader->stop_writer = fds[1];
+
+  reader->capacity = capacity;
+  reader->ring = ALLOC_N(char, capacity);
+  pthread_mutex_init(&reader->mutex, NULL);
+  pthread_cond_init(&reader->data_available, NULL);
+
+  result = pthread_create(&reader->thread, NULL, serial_reader_thread, reader);
+  if (result != 0)
+  {
+    errno = result;
+    rb_sys_fail("pthread_create");
+  }
+  reader->running = 1;
+  return self;
+}
+
+static void* serial_reader_wait(void* ptr)
+{
+  serial_reader_wait_t* wait = (serial_reader_wait_t*) ptr;
+  serial_reader_t* reader = wait->reader;
+  struct timeval now;
+  struct timespec deadline;
+  double seconds = 0.0;
+
+  if (wait->timeout >= 0.0)
+  {
+    gettimeofday(&now, NULL);
+    seconds = now.tv_sec + (now.tv_usec / 1000000.0) + wait->timeout;
+    deadline.tv_sec = (time_t) seconds;
+    deadline.tv_nsec = (long) ((seconds - deadline.tv_sec) * 1000000000.0);
+  }
+
+  pthread_mutex_lock(&reader->mutex);
+  while ((reader->length == 0) && (reader->error == 0) && !reader->interrupted)
+  {
+    if (wait->timeout >= 0.0)
+    {
+      if (pthread_cond_timedwait(&reader->data_available, &reader->mutex, &deadline) == ETIMEDOUT)
+      {
+        break;
+      }
+    }
+    else
+    {
+      pthread_cond_wait(&reader->data_available, &reader->mutex);
+    }
+  }
+  pthread_mutex_unlock(&reader->mutex);
+  return NULL;
+}
+
+static void serial_reader_unblock(void* ptr)
+{
+  serial_reader_t* reader = (serial_reader_t*) ptr;
+  pthread_mutex_lock(&reader->mutex);
+  reader->interrupted = 1;
+  pthread_cond_broadcast(&reader->data_available);
+  pthread_mutex_unlock(&reader->mutex);
+}
+
+/*
+ * Removes all the buffered data from the ring buffer. Raises the error which
+ * stopped the reader thread once the buffered data has been returned.
+ */
+static VALUE serial_reader_take(serial_reader_t* reader)
+{
+  VALUE data = Qnil;
+  size_t first = 0;
+  int error = 0;
+
+  pthread_mutex_lock(&reader->mutex);
+  if (reader->length > 0)
+  {
+    data = rb_str_new(NULL, reader->length);
+    first = reader->capacity - reader->head;
+    if (first > reader->length)
+    {
+      first = reader->length;
+    }
+    memcpy(RSTRING_PTR(data), reader->ring + reader->head, first);
+    memcpy(RSTRING_PTR(data) + first, reader->ring, reader->length - first);
+    reader->head = (reader->head + reader->length) % reader->capacity;
+    reader->length = 0;
+  }
+  error = reader->error;
+  pthread_mutex_unlock(&reader->mutex);
+
+  if (NIL_P(data) && (error != 0))
+  {
+    if (error == -1)
+    {
+      rb_raise(rb_eEOFError, "end of file reached");
+    }
+    errno = error;
+    rb_sys_fail("read");
+  }
+  return data;
+}
+
+/*
+ * Waits for data from the reader thread without holding the GVL
+ *
+ * @param timeout [Float|nil] Maximum number of seconds to wait or nil to
+ *   wait until data arrives
+ * @return [String|nil] All the data buffered since the last read or nil if
+ *   the timeout expired
+ */
+static VALUE serial_reader_read(int argc, VALUE* argv, VALUE self)
+{
+  VALUE timeout = Qnil;
+  VALUE data = Qnil;
+  serial_reader_t* reader = get_serial_reader(self);
+  serial_reader_wait_t wait;
+
+  rb_scan_args(argc, argv, "01", &timeout);
+  wait.reader = reader;
+  wait.timeout = NIL_P(timeout) ? -1.0 : NUM2DBL(timeout);
+  if (!NIL_P(timeout) && (wait.timeout < 0.0))
+  {
+    wait.timeout = 0.0;
+  }
+
+  while (1)
+  {
+    data = serial_reader_take(reader);
+    if (!NIL_P(data))
+    {
+      return data;
+    }
+    reader->interrupted = 0;
+    rb_thread_call_without_gvl(serial_reader_wait, &wait, serial_reader_unblock, reader);
+    data = serial_reader_take(reader);
+    if (!NIL_P(data))
+    {
+      return data;
+    }
+    if (reader->interrupted)
+    {
+      /* Run any pending interrupts such as Thread#kill then keep waiting */
+      rb_thread_check_ints();
+      continue;
+    }
+    return Qnil;
+  }
+}
+
+/*
+ * @return [String] All the data buffered since the last read. Empty if no
+ *   data is buffered.
+ */
+static VALUE serial_reader_read_nonblock(VALUE self)
+{
+  VALUE data = serial_reader_take(get_serial_reader(self));
+  if (NIL_P(data))
+  {
+    data = rb_str_new(NULL, 0);
+  }
+  return data;
+}
+
+/*
+ * Stops the reader thread. Buffered data can still be read.
+ */
+static VALUE serial_reader_stop(VALUE self)
+{
+  serial_reader_t* reader = get_serial_reader(self);
+  rb_thread_call_without_gvl(serial_reader_stop_thread, reader, RUBY_UBF_IO, NULL);
+  return Qnil;
+}
+
+/*
+ * @return [Hash] :bytes_read, :bytes_dropped (read while the ring buffer was
+ *   full) and :high_water_mark (most bytes buffered at once)
+ */
+static VALUE serial_reader_stats(VALUE self)
+{
+  serial_reader_t* reader = get_serial_reader(self);
+  VALUE stats = rb_hash_new();
+  unsigned long long bytes_read = 0;
+  unsigned long long bytes_dropped = 0;
+  size_t high_water_mark = 0;
+
+  pthread_mutex_lock(&reader->mutex);
+  bytes_read = reader->bytes_read;
+  bytes_dropped = reader->bytes_dropped;
+  high_water_mark = reader->high_water_mark;
+  pthread_mutex_unlock(&reader->mutex);
+
+  rb_hash_aset(stats, ID2SYM(id_bytes_read), ULL2NUM(bytes_read));
+  rb_hash_aset(stats, ID2SYM(id_bytes_dropped), ULL2NUM(bytes_dropped));
+  rb_hash_aset(stats, ID2SYM(id_high_water_mark), SIZET2NUM(high_water_mark));
+  return stats;
+}
+
+/*
+ * @return [Hash|nil] The error counters kept by the serial driver. The keys
+ *   are :frame, :overrun (characters lost by the UART), :parity, :break and
+ *   :buffer_overrun (characters lost by the tty buffer). nil if the driver
+ *   does not keep counters.
+ */
+static VALUE serial_reader_error_counts(VALUE self)
+{
+#if defined(HAVE_LINUX_SERIAL_H) && defined(TIOCGICOUNT)
+  serial_reader_t* reader = get_serial_reader(self);
+  struct serial_icounter_struct counters;
+  VALUE counts = Qnil;
+
+  memset(&counters, 0, sizeof(counters));
+  if (ioctl(reader->fd, TIOCGICOUNT, &counters) != 0)
+  {
+    return Qnil;
+  }
+  counts = rb_hash_new();
+  rb_hash_aset(counts, ID2SYM(id_frame), INT2NUM(counters.frame));
+  rb_hash_aset(counts, ID2SYM(id_overrun), INT2NUM(counters.overrun));
+  rb_hash_aset(counts, ID2SYM(id_parity), INT2NUM(counters.parity));
+  rb_hash_aset(counts, ID2SYM(id_break), INT2NUM(counters.brk));
+  rb_hash_aset(counts, ID2SYM(id_buffer_overrun), INT2NUM(counters.buf_overrun));
+  return counts;
+#else
+  get_serial_reader(self);
+  return Qnil;
+#endif
+}
+
+#endif /* COSMOS_NATIVE_SERIAL_READER */
+
+void Init_serial_reader(void)
+{
+  mCosmos = rb_define_module("Cosmos");
+
+#ifdef COSMOS_NATIVE_SERIAL_READER
+  id_bytes_read = rb_intern("bytes_read");
+  id_bytes_dropped = rb_intern("bytes_dropped");
+  id_high_water_mark = rb_intern("high_water_mark");
+  id_frame = rb_intern("frame");
+  id_overrun = rb_intern("overrun");
+  id_parity = rb_intern("parity");
+  id_break = rb_intern("break");
+  id_buffer_overrun = rb_intern("buffer_overrun");
+
+  cSerialReader = rb_define_class_under(mCosmos, "SerialReader", rb_cObject);
+  rb_define_alloc_func(cSerialReader, serial_reader_alloc);
+  rb_define_method(cSerialReader, "initialize", serial_reader_initialize, 2);
+  rb_define_method(cSerialReader, "read", serial_reader_read, -1);
+  rb_define_method(cSerialReader, "read_nonblock", serial_reader_read_nonblock, 0);
+  rb_define_method(cSerialReader, "stop", serial_reader_stop, 0);
+  rb_define_method(cSerialReader, "stats", serial_reader_stats, 0);
+  rb_define_method(cSerialReader, "error_counts", serial_reader_error_counts, 0);
+#endif
+}
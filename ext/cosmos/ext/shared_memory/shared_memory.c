@@ -0,0 +1,395 @@
+/*
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+*/
+
+#include "ruby.h"
+#include "stdio.h"
+#include "string.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+  #define MEMORY_BARRIER() MemoryBarrier()
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <sched.h>
+  #define MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+VALUE mCosmos = Qnil;
+VALUE cSharedMemory = Qnil;
+
+/* Number of times a reader retries while a packet slot is being written */
+#define MAX_READ_ATTEMPTS 1000
+
+/*
+ * Header at the start of each packet slot. The packet buffer immediately
+ * follows the header. The sequence number is odd while the writer is updating
+ * the slot and even when the slot is consistent. A sequence of 0 means the
+ * slot has never been written.
+ */
+typedef struct {
+  volatile unsigned int sequence;
+  unsigned int length;
+  unsigned int received_count;
+  unsigned int reserved;
+  long long time_sec;
+  long long time_usec;
+} packet_slot_t;
+
+typedef struct {
+  unsigned char* data;
+  long size;
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE mapping;
+#else
+  int fd;
+#endif
+} shared_memory_t;
+
+static void shared_memory_unmap(shared_memory_t* memory)
+{
+  if (memory->data)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile(memory->data);
+    CloseHandle(memory->mapping);
+    CloseHandle(memory->file);
+#else
+    munmap(memory->data, memory->size);
+    close(memory->fd);
+#endif
+    memory->data = NULL;
+    memory->size = 0;
+  }
+}
+
+static void shared_memory_free(void* ptr)
+{
+  shared_memory_t* memory = (shared_memory_t*) ptr;
+  shared_memory_unmap(memory);
+  xfree(memory);
+}
+
+static size_t shared_memory_memsize(const void* ptr)
+{
+  return sizeof(shared_memory_t);
+}
+
+static const rb_data_type_t shared_memory_type = {
+  "Cosmos::SharedMemory",
+  {NULL, shared_memory_free, shared_memory_memsize,},
+  NULL, NULL, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE shared_memory_alloc(VALUE klass)
+{
+  shared_memory_t* memory = NULL;
+  VALUE self = TypedData_Make_Struct(klass, shared_memory_t, &shared_memory_type, memory);
+  memory->data = NULL;
+  memory->size = 0;
+  return self;
+}
+
+static shared_memory_t* get_memory(VALUE self)
+{
+  shared_memory_t* memory = NULL;
+  TypedData_Get_Struct(self, shared_memory_t, &shared_memory_type, memory);
+  if (!memory->data)
+  {
+    rb_raise(rb_eIOError, "shared memory closed");
+  }
+  return memory;
+}
+
+static void check_range(shared_memory_t* memory, long offset, long length)
+{
+  if ((offset < 0) || (length < 0) || ((offset + length) > memory->size))
+  {
+    rb_raise(rb_eArgError, "offset %ld length %ld outside of shared memory of size %ld", offset, length, memory->size);
+  }
+}
+
+/*
+ * Map a file into memory so it can be shared between processes. The file is
+ * created if it does not exist and extended to size bytes if it is smaller.
+ *
+ * @param filename [String] File to map
+ * @param size [Integer] Number of bytes to map
+ */
+static VALUE shared_memory_initialize(VALUE self, VALUE filename, VALUE size)
+{
+  shared_memory_t* memory = NULL;
+  long map_size = NUM2LONG(size);
+  TypedData_Get_Struct(self, shared_memory_t, &shared_memory_type, memory);
+
+  FilePathValue(filename);
+  if (map_size <= 0)
+  {
+    rb_raise(rb_eArgError, "size must be greater than 0: %ld", map_size);
+  }
+
+#ifdef _WIN32
+  memory->file = CreateFileA(RSTRING_PTR(filename), GENERIC_READ | GENERIC_WRITE,
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (memory->file == INVALID_HANDLE_VALUE)
+  {
+    rb_raise(rb_eIOError, "Unable to open %s", RSTRING_PTR(filename));
+  }
+  memory->mapping = CreateFileMappingA(memory->file, NULL, PAGE_READWRITE, 0, (DWORD) map_size, NULL);
+  if (!memory->mapping)
+  {
+    CloseHandle(memory->file);
+    rb_raise(rb_eIOError, "Unable to map %s", RSTRING_PTR(filename));
+  }
+  memory->data = (unsigned char*) MapViewOfFile(memory->mapping, FILE_MAP_ALL_ACCESS, 0, 0, map_size);
+  if (!memory->data)
+  {
+    CloseHandle(memory->mapping);
+    CloseHandle(memory->file);
+    rb_raise(rb_eIOError, "Unable to map %s", RSTRING_PTR(filename));
+  }
+#else
+  {
+    struct stat file_stat;
+    void* data = NULL;
+
+    memory->fd = open(RSTRING_PTR(filename), O_RDWR | O_CREAT, 0644);
+    if (memory->fd < 0)
+    {
+      rb_sys_fail(RSTRING_PTR(filename));
+    }
+    if ((fstat(memory->fd, &file_stat) != 0) ||
+        ((file_stat.st_size < map_size) && (ftruncate(memory->fd, map_size) != 0)))
+    {
+      close(memory->fd);
+      rb_sys_fail(RSTRING_PTR(filename));
+    }
+    data = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, memory->fd, 0);
+    if (data == MAP_FAILED)
+    {
+      close(memory->fd);
+      rb_sys_fail(RSTRING_PTR(filename));
+    }
+    memory->data = (unsigned char*) data;
+  }
+#endif
+
+  memory->size = map_size;
+  return self;
+}
+
+/*
+ * @return [Integer] Number of bytes mapped
+ */
+static VALUE shared_memory_size(VALUE self)
+{
+  return LONG2NUM(get_memory(self)->size);
+}
+
+/*
+ * Unmap the shared memory. Further calls raise IOError.
+ */
+static VALUE shared_memory_close(VALUE self)
+{
+  shared_memory_t* memory = NULL;
+  TypedData_Get_Struct(self, shared_memory_t, &shared_memory_type, memory);
+  shared_memory_unmap(memory);
+  return Qnil;
+}
+
+/*
+ * @return [Boolean] Whether the shared memory has been closed
+ */
+static VALUE shared_memory_closed(VALUE self)
+{
+  shared_memory_t* memory = NULL;
+  TypedData_Get_Struct(self, shared_memory_t, &shared_memory_type, memory);
+  return memory->data ? Qfalse : Qtrue;
+}
+
+/*
+ * Read bytes from the shared memory
+ *
+ * @param offset [Integer] Byte offset to read from
+ * @param length [Integer] Number of bytes to read
+ * @return [String] The bytes read
+ */
+static VALUE shared_memory_read(VALUE self, VALUE offset, VALUE length)
+{
+  shared_memory_t* memory = get_memory(self);
+  long start = NUM2LONG(offset);
+  long count = NUM2LONG(length);
+  check_range(memory, start, count);
+  return rb_str_new((char*) (memory->data + start), count);
+}
+
+/*
+ * Write bytes to the shared memory
+ *
+ * @param offset [Integer] Byte offset to write to
+ * @param data [String] The bytes to write
+ */
+static VALUE shared_memory_write(VALUE self, VALUE offset, VALUE data)
+{
+  shared_memory_t* memory = get_memory(self);
+  long start = NUM2LONG(offset);
+  StringValue(data);
+  check_range(memory, start, RSTRING_LEN(data));
+  memcpy(memory->data + start, RSTRING_PTR(data), RSTRING_LEN(data));
+  return Qnil;
+}
+
+/*
+ * Write a packet into a packet slot protected by a sequence lock. Only one
+ * process may write to a given slot.
+ *
+ * @param offset [Integer] Byte offset of the packet slot
+ * @param capacity [Integer] Maximum packet length the slot can hold
+ * @param buffer [String] Packet buffer
+ * @param received_count [Integer] Packet received count
+ * @param time_sec [Integer] Received time seconds
+ * @param time_usec [Integer] Received time microseconds
+ * @return [Boolean] false if the buffer is larger than the slot capacity
+ */
+static VALUE shared_memory_write_packet(VALUE self, VALUE offset, VALUE capacity, VALUE buffer, VALUE received_count, VALUE time_sec, VALUE time_usec)
+{
+  shared_memory_t* memory = get_memory(self);
+  long start = NUM2LONG(offset);
+  long slot_capacity = NUM2LONG(capacity);
+  long length = 0;
+  packet_slot_t* slot = NULL;
+  unsigned int sequence = 0;
+
+  StringValue(buffer);
+  length = RSTRING_LEN(buffer);
+  check_range(memory, start, sizeof(packet_slot_t) + slot_capacity);
+  if (length > slot_capacity)
+  {
+    return Qfalse;
+  }
+
+  slot = (packet_slot_t*) (memory->data + start);
+  sequence = slot->sequence;
+  if (sequence & 1)
+  {
+    /* A previous writer died mid update */
+    sequence++;
+  }
+
+  slot->sequence = sequence + 1;
+  MEMORY_BARRIER();
+  slot->length = (unsigned int) length;
+  slot->received_count = NUM2UINT(received_count);
+  slot->time_sec = NUM2LL(time_sec);
+  slot->time_usec = NUM2LL(time_usec);
+  memcpy(((unsigned char*) slot) + sizeof(packet_slot_t), RSTRING_PTR(buffer), length);
+  MEMORY_BARRIER();
+  slot->sequence = sequence + 2;
+
+  return Qtrue;
+}
+
+/*
+ * Read a packet from a packet slot protected by a sequence lock
+ *
+ * @param offset [Integer] Byte offset of the packet slot
+ * @param capacity [Integer] Maximum packet length the slot can hold
+ * @param last_sequence [Integer] Sequence number returned by the previous
+ *   read of this slot or 0
+ * @return [Array|nil] nil if the slot has not been written since
+ *   last_sequence. Otherwise an Array containing the sequence number, packet
+ *   buffer, received count, received time seconds and received time
+ *   microseconds.
+ */
+static VALUE shared_memory_read_packet(VALUE self, VALUE offset, VALUE capacity, VALUE last_sequence)
+{
+  shared_memory_t* memory = get_memory(self);
+  long start = NUM2LONG(offset);
+  long slot_capacity = NUM2LONG(capacity);
+  unsigned int previous_sequence = NUM2UINT(last_sequence);
+  packet_slot_t* slot = NULL;
+  unsigned int sequence = 0;
+  unsigned int length = 0;
+  unsigned int received_count = 0;
+  long long time_sec = 0;
+  long long time_usec = 0;
+  volatile VALUE buffer = Qnil;
+  int attempt = 0;
+
+  check_range(memory, start, sizeof(packet_slot_t) + slot_capacity);
+  slot = (packet_slot_t*) (memory->data + start);
+
+  for (attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++)
+  {
+    sequence = slot->sequence;
+    MEMORY_BARRIER();
+    if ((sequence == 0) || (sequence == previous_sequence))
+    {
+      return Qnil;
+    }
+    if (sequence & 1)
+    {
+      /* Writer is updating the slot */
+#ifdef _WIN32
+      SwitchToThread();
+#else
+      sched_yield();
+#endif
+      continue;
+    }
+
+    /* Only allocate once the slot is known to have changed */
+    if (NIL_P(buffer))
+    {
+      buffer = rb_str_buf_new(slot_capacity);
+    }
+    length = slot->length;
+    if (length > slot_capacity)
+    {
+      length = slot_capacity;
+    }
+    received_count = slot->received_count;
+    time_sec = slot->time_sec;
+    time_usec = slot->time_usec;
+    memcpy(RSTRING_PTR(buffer), ((unsigned char*) slot) + sizeof(packet_slot_t), length);
+    MEMORY_BARRIER();
+    if (slot->sequence == sequence)
+    {
+      rb_str_set_len(buffer, length);
+      return rb_ary_new3(5, UINT2NUM(sequence), buffer, UINT2NUM(received_count), LL2NUM(time_sec), LL2NUM(time_usec));
+    }
+  }
+
+  /* The writer is updating faster than we can read. Report no change. */
+  return Qnil;
+}
+
+/*
+ * Initialize methods for SharedMemory
+ */
+void Init_shared_memory(void)
+{
+  mCosmos = rb_define_module("Cosmos");
+
+  cSharedMemory = rb_define_class_under(mCosmos, "SharedMemory", rb_cObject);
+  rb_define_alloc_func(cSharedMemory, shared_memory_alloc);
+  rb_define_const(cSharedMemory, "PACKET_HEADER_SIZE", INT2FIX(sizeof(packet_slot_t)));
+  rb_define_method(cSharedMemory, "initialize", shared_memory_initialize, 2);
+  rb_define_method(cSharedMemory, "size", shared_memory_size, 0);
+  rb_define_method(cSharedMemory, "close", shared_memory_close, 0);
+  rb_define_method(cSharedMemory, "closed?", shared_memory_closed, 0);
+  rb_define_method(cSharedMemory, "read", shared_memory_read, 2);
+  rb_define_method(cSharedMemory, "write", shared_memory_write, 2);
+  rb_define_method(cSharedMemory, "write_packet", shared_memory_write_packet, 6);
+  rb_define_method(cSharedMemory, "read_packet", shared_memory_read_packet, 3);
+}
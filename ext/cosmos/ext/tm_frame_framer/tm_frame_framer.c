@@ -0,0 +1,494 @@
+/*
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+*/
+
+#include "ruby.h"
+#include "ruby/encoding.h"
+#include "stdio.h"
+#include "string.h"
+#include "../receive_buffer/receive_buffer.h"
+
+VALUE mCosmos = Qnil;
+VALUE cTmFrameFramer = Qnil;
+
+/*
+ * TM transfer frame primary header fields and the values of the first
+ * header pointer which do not point to a packet
+ */
+#define TM_PRIMARY_HEADER_LENGTH 6
+#define TM_NUM_VIRTUAL_CHANNELS 8
+#define TM_FHP_NO_PACKET_START 0x7FF
+#define TM_FHP_IDLE 0x7FE
+#define TM_OCF_LENGTH 4
+#define TM_FECF_LENGTH 2
+/* The frame error control field is a CRC-16-CCITT */
+#define TM_FECF_POLY 0x1021
+#define TM_FECF_SEED 0xFFFF
+/* CCSDS space packet primary header length, length field offset and idle APID */
+#define SPACE_PACKET_HEADER_LENGTH 6
+#define SPACE_PACKET_LENGTH_OFFSET 7
+#define SPACE_PACKET_IDLE_APID 0x7FF
+
+/*
+ * Virtual channel state. A space packet which continues into the next frame
+ * of the virtual channel is collected in partial until it is complete.
+ * packet_length is 0 until the packet's primary header has been collected.
+ */
+typedef struct {
+  char* partial;
+  long partial_length;
+  long partial_capacity;
+  long packet_length;
+  int in_packet;
+  int frame_count;
+  unsigned long long frames;
+  unsigned long long lost_frames;
+  unsigned long long packets;
+  unsigned long long discarded;
+  unsigned long long idle_frames;
+} tm_virtual_channel_t;
+
+typedef struct {
+  long frame_length;
+  int fecf;
+  char* sync_pattern;
+  long sync_length;
+  int master_frame_count;
+  unsigned long long master_frames;
+  unsigned long long master_lost_frames;
+  unsigned long long fecf_errors;
+  tm_virtual_channel_t virtual_channels[TM_NUM_VIRTUAL_CHANNELS];
+} tm_frame_framer_t;
+
+static unsigned short tm_fecf_table[256];
+
+static void tm_fecf_table_init(void)
+{
+  int index = 0;
+  int bit = 0;
+  unsigned short crc = 0;
+  for (index = 0; index < 256; index++)
+  {
+    crc = (unsigned short) (index << 8);
+    for (bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 0x8000) ? (unsigned short) ((crc << 1) ^ TM_FECF_POLY) : (unsigned short) (crc << 1);
+    }
+    tm_fecf_table[index] = crc;
+  }
+}
+
+static unsigned short tm_fecf_calculate(const unsigned char* data, long length)
+{
+  unsigned short crc = TM_FECF_SEED;
+  long index = 0;
+  for (index = 0; index < length; index++)
+  {
+    crc = (unsigned short) ((crc << 8) ^ tm_fecf_table[((crc >> 8) ^ data[index]) & 0xFF]);
+  }
+  return crc;
+}
+
+static VALUE new_binary_string(const char* ptr, long length)
+{
+  VALUE string = rb_str_new(ptr, length);
+  rb_enc_associate(string, rb_ascii8bit_encoding());
+  return string;
+}
+
+static void tm_frame_framer_free(void* ptr)
+{
+  tm_frame_framer_t* framer = (tm_frame_framer_t*) ptr;
+  int vcid = 0;
+  for (vcid = 0; vcid < TM_NUM_VIRTUAL_CHANNELS; vcid++)
+  {
+    if (framer->virtual_channels[vcid].partial)
+    {
+      xfree(framer->virtual_channels[vcid].partial);
+    }
+  }
+  if (framer->sync_pattern)
+  {
+    xfree(framer->sync_pattern);
+  }
+  xfree(framer);
+}
+
+static size_t tm_frame_framer_memsize(const void* ptr)
+{
+  const tm_frame_framer_t* framer = (const tm_frame_framer_t*) ptr;
+  size_t size = sizeof(tm_frame_framer_t) + framer->sync_length;
+  int vcid = 0;
+  for (vcid = 0; vcid < TM_NUM_VIRTUAL_CHANNELS; vcid++)
+  {
+    size += framer->virtual_channels[vcid].partial_capacity;
+  }
+  return size;
+}
+
+static const rb_data_type_t tm_frame_framer_type = {
+  "Cosmos::TmFrameFramer",
+  {NULL, tm_frame_framer_free, tm_frame_framer_memsize,},
+  NULL, NULL, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE tm_frame_framer_alloc(VALUE klass)
+{
+  tm_frame_framer_t* framer = NULL;
+  /* TypedData_Make_Struct zeroes the virtual channel state */
+  return TypedData_Make_Struct(klass, tm_frame_framer_t, &tm_frame_framer_type, framer);
+}
+
+static tm_frame_framer_t* get_tm_frame_framer(VALUE self)
+{
+  tm_frame_framer_t* framer = NULL;
+  TypedData_Get_Struct(self, tm_frame_framer_t, &tm_frame_framer_type, framer);
+  return framer;
+}
+
+/* Drop the space packets being collected and the expected frame counts */
+static void tm_frame_framer_resync(tm_frame_framer_t* framer)
+{
+  int vcid = 0;
+  framer->master_frame_count = -1;
+  for (vcid = 0; vcid < TM_NUM_VIRTUAL_CHANNELS; vcid++)
+  {
+    framer->virtual_channels[vcid].in_packet = 0;
+    framer->virtual_channels[vcid].partial_length = 0;
+    framer->virtual_channels[vcid].packet_length = 0;
+    framer->virtual_channels[vcid].frame_count = -1;
+  }
+}
+
+/*
+ * @param frame_length [Integer] Length of each transfer frame in bytes not
+ *   including the sync pattern
+ * @param sync_pattern [String|nil] Sync pattern every frame starts with
+ * @param fecf [Boolean] Whether each frame ends with a frame error control
+ *   field. Frames whose FECF does not match are dropped.
+ */
+static VALUE tm_frame_framer_initialize(VALUE self, VALUE frame_length, VALUE sync_pattern, VALUE fecf)
+{
+  tm_frame_framer_t* framer = get_tm_frame_framer(self);
+
+  framer->frame_length = NUM2LONG(frame_length);
+  framer->fecf = RTEST(fecf);
+  if (framer->frame_length < (TM_PRIMARY_HEADER_LENGTH + (framer->fecf ? TM_FECF_LENGTH : 0) + 1))
+  {
+    rb_raise(rb_eArgError, "frame_length is too small to hold a transfer frame: %ld", framer->frame_length);
+  }
+
+  if (framer->sync_pattern)
+  {
+    xfree(framer->sync_pattern);
+    framer->sync_pattern = NULL;
+    framer->sync_length = 0;
+  }
+  if (RTEST(sync_pattern))
+  {
+    StringValue(sync_pattern);
+    framer->sync_length = RSTRING_LEN(sync_pattern);
+    framer->sync_pattern = ALLOC_N(char, framer->sync_length);
+    memcpy(framer->sync_pattern, RSTRING_PTR(sync_pattern), framer->sync_length);
+  }
+
+  tm_frame_framer_resync(framer);
+  return self;
+}
+
+static void tm_discard_packet(tm_virtual_channel_t* channel)
+{
+  if (channel->in_packet)
+  {
+    channel->discarded++;
+  }
+  channel->in_packet = 0;
+  channel->partial_length = 0;
+  channel->packet_length = 0;
+}
+
+static void tm_emit_packet(tm_virtual_channel_t* channel, VALUE frames, const unsigned char* packet, long length)
+{
+  int apid = ((packet[0] & 0x07) << 8) | packet[1];
+  if (apid != SPACE_PACKET_IDLE_APID)
+  {
+    rb_ary_push(frames, new_binary_string((const char*) packet, length));
+    channel->packets++;
+  }
+}
+
+static long tm_collect(tm_virtual_channel_t* channel, const unsigned char* data, long length, long needed)
+{
+  long count = (needed < length) ? needed : length;
+  if ((channel->partial_length + count) > channel->partial_capacity)
+  {
+    channel->partial_capacity = channel->partial_length + count;
+    if (channel->partial_capacity < 1024)
+    {
+      channel->partial_capacity = 1024;
+    }
+    REALLOC_N(channel->partial, char, channel->partial_capacity);
+  }
+  memcpy(channel->partial + channel->partial_length, data, count);
+  channel->partial_length += count;
+  return count;
+}
+
+/*
+ * Add data to the space packet being collected by a virtual channel and emit
+ * the packet once it is complete. Returns the number of bytes used.
+ */
+static long tm_continue_packet(tm_virtual_channel_t* channel, VALUE frames, const unsigned char* data, long length)
+{
+  long used = 0;
+  const unsigned char* header = NULL;
+
+  if (channel->packet_length == 0)
+  {
+    used += tm_collect(channel, data, length, SPACE_PACKET_HEADER_LENGTH - channel->partial_length);
+    if (channel->partial_length < SPACE_PACKET_HEADER_LENGTH)
+    {
+      return used;
+    }
+    header = (const unsigned char*) channel->partial;
+    channel->packet_length = (((long) header[4] << 8) | header[5]) + SPACE_PACKET_LENGTH_OFFSET;
+  }
+
+  used += tm_collect(channel, data + used, length - used, channel->packet_length - channel->partial_length);
+  if (channel->partial_length == channel->packet_length)
+  {
+    tm_emit_packet(channel, frames, (const unsigned char*) channel->partial, channel->packet_length);
+    channel->in_packet = 0;
+    channel->partial_length = 0;
+    channel->packet_length = 0;
+  }
+  return used;
+}
+
+/* Extract the space packets from the data field of one frame */
+static void tm_process_frame(tm_frame_framer_t* framer, VALUE frames, const unsigned char* frame)
+{
+  tm_virtual_channel_t* channel = NULL;
+  const unsigned char* data_field = NULL;
+  long data_start = TM_PRIMARY_HEADER_LENGTH;
+  long data_end = framer->frame_length;
+  long data_length = 0;
+  long position = 0;
+  long packet_length = 0;
+  long fecf_offset = 0;
+  int vcid = (frame[1] >> 1) & 0x07;
+  int ocf = frame[1] & 0x01;
+  int master_frame_count = frame[2];
+  int frame_count = frame[3];
+  int secondary_header = frame[4] >> 7;
+  int sync_flag = (frame[4] >> 6) & 0x01;
+  int first_header_pointer = ((frame[4] & 0x07) << 8) | frame[5];
+
+  if (framer->fecf)
+  {
+    fecf_offset = framer->frame_length - TM_FECF_LENGTH;
+    if (tm_fecf_calculate(frame, fecf_offset) != (((unsigned short) frame[fecf_offset] << 8) | frame[fecf_offset + 1]))
+    {
+      /* None of the header can be trusted. The frame is treated as lost by
+       * its virtual channel when the next frame arrives. */
+      framer->fecf_errors++;
+      return;
+    }
+  }
+
+  framer->master_frames++;
+  if (framer->master_frame_count >= 0)
+  {
+    framer->master_lost_frames += (master_frame_count - framer->master_frame_count + 255) & 0xFF;
+  }
+  framer->master_frame_count = master_frame_count;
+
+  channel = &framer->virtual_channels[vcid];
+  channel->frames++;
+  if ((channel->frame_count >= 0) && (frame_count != ((channel->frame_count + 1) & 0xFF)))
+  {
+    /* The packet being collected is missing data */
+    channel->lost_frames += (frame_count - channel->frame_count + 255) & 0xFF;
+    tm_discard_packet(channel);
+  }
+  channel->frame_count = frame_count;
+
+  if (secondary_header)
+  {
+    data_start += (frame[TM_PRIMARY_HEADER_LENGTH] & 0x3F) + 1;
+  }
+  if (ocf)
+  {
+    data_end -= TM_OCF_LENGTH;
+  }
+  if (framer->fecf)
+  {
+    data_end -= TM_FECF_LENGTH;
+  }
+  /* Frames which do not hold space packets are only counted */
+  if ((data_end <= data_start) || sync_flag)
+  {
+    return;
+  }
+  if (first_header_pointer == TM_FHP_IDLE)
+  {
+    channel->idle_frames++;
+    return;
+  }
+
+  data_field = frame + data_start;
+  data_length = data_end - data_start;
+  if (first_header_pointer == TM_FHP_NO_PACKET_START)
+  {
+    if (channel->in_packet)
+    {
+      tm_continue_packet(channel, frames, data_field, data_length);
+    }
+    return;
+  }
+  if (first_header_pointer >= data_length)
+  {
+    tm_discard_packet(channel);
+    return;
+  }
+
+  /* The data before the first header pointer finishes the packet being
+   * collected */
+  if (channel->in_packet)
+  {
+    if ((tm_continue_packet(channel, frames, data_field, first_header_pointer) != first_header_pointer) || channel->in_packet)
+    {
+      tm_discard_packet(channel);
+    }
+  }
+
+  position = first_header_pointer;
+  while (position < data_length)
+  {
+    if ((data_length - position) >= SPACE_PACKET_HEADER_LENGTH)
+    {
+      packet_length = (((long) data_field[position + 4] << 8) | data_field[position + 5]) + SPACE_PACKET_LENGTH_OFFSET;
+      if (packet_length <= (data_length - position))
+      {
+        tm_emit_packet(channel, frames, data_field + position, packet_length);
+        position += packet_length;
+        continue;
+      }
+    }
+    /* The packet continues in the next frame */
+    channel->in_packet = 1;
+    channel->partial_length = 0;
+    channel->packet_length = 0;
+    tm_continue_packet(channel, frames, data_field + position, data_length - position);
+    break;
+  }
+}
+
+/*
+ * Remove every complete transfer frame from the front of a receive buffer and
+ * append the space packets completed by them. Packets which span frames are
+ * collected separately for each virtual channel.
+ *
+ * @param buffer [ReceiveBuffer] The received data
+ * @param frames [Array<String>] Array the space packets are appended to
+ * @return [Integer] Number of unread bytes needed before the next frame can
+ *   be removed or 0 if the unread data does not start with the sync pattern
+ */
+static VALUE tm_frame_framer_frame(VALUE self, VALUE buffer_value, VALUE frames)
+{
+  tm_frame_framer_t* framer = get_tm_frame_framer(self);
+  receive_buffer_t* buffer = NULL;
+  long total_length = framer->sync_length + framer->frame_length;
+  long framed = 0;
+
+  buffer = receive_buffer_get(buffer_value);
+  Check_Type(frames, T_ARRAY);
+
+  while ((buffer->end - buffer->start) >= total_length)
+  {
+    const unsigned char* data = (const unsigned char*) (buffer->data + buffer->start);
+    if (framer->sync_length && (memcmp(data, framer->sync_pattern, framer->sync_length) != 0))
+    {
+      /* Frames before the lost sync are returned first */
+      if (framed == 0)
+      {
+        return INT2FIX(0);
+      }
+      break;
+    }
+    tm_process_frame(framer, frames, data + framer->sync_length);
+    buffer->start += total_length;
+    framed++;
+  }
+  return LONG2NUM(total_length);
+}
+
+/*
+ * Drop the space packets being collected and restart the frame counters.
+ * The statistics are kept.
+ */
+static VALUE tm_frame_framer_reset(VALUE self)
+{
+  tm_frame_framer_resync(get_tm_frame_framer(self));
+  return Qnil;
+}
+
+/*
+ * @param vcid [Integer|nil] Virtual channel or nil for the master channel
+ * @return [Hash] Statistics for the channel. The master channel has :frames,
+ *   :lost_frames and :fecf_errors. Virtual channels have :frames,
+ *   :lost_frames, :packets, :discarded (packets dropped because of lost
+ *   frames), :idle_frames and :in_progress_bytes.
+ */
+static VALUE tm_frame_framer_stats(int argc, VALUE* argv, VALUE self)
+{
+  tm_frame_framer_t* framer = get_tm_frame_framer(self);
+  tm_virtual_channel_t* channel = NULL;
+  volatile VALUE stats = rb_hash_new();
+  int vcid = 0;
+
+  if (argc > 1)
+  {
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+  }
+  if ((argc == 0) || (argv[0] == Qnil))
+  {
+    rb_hash_aset(stats, ID2SYM(rb_intern("frames")), ULL2NUM(framer->master_frames));
+    rb_hash_aset(stats, ID2SYM(rb_intern("lost_frames")), ULL2NUM(framer->master_lost_frames));
+    rb_hash_aset(stats, ID2SYM(rb_intern("fecf_errors")), ULL2NUM(framer->fecf_errors));
+    return stats;
+  }
+
+  vcid = NUM2INT(argv[0]);
+  if ((vcid < 0) || (vcid >= TM_NUM_VIRTUAL_CHANNELS))
+  {
+    rb_raise(rb_eArgError, "Virtual channel must be from 0 to %d: %d", TM_NUM_VIRTUAL_CHANNELS - 1, vcid);
+  }
+  channel = &framer->virtual_channels[vcid];
+  rb_hash_aset(stats, ID2SYM(rb_intern("frames")), ULL2NUM(channel->frames));
+  rb_hash_aset(stats, ID2SYM(rb_intern("lost_frames")), ULL2NUM(channel->lost_frames));
+  rb_hash_aset(stats, ID2SYM(rb_intern("packets")), ULL2NUM(channel->packets));
+  rb_hash_aset(stats, ID2SYM(rb_intern("discarded")), ULL2NUM(channel->discarded));
+  rb_hash_aset(stats, ID2SYM(rb_intern("idle_frames")), ULL2NUM(channel->idle_frames));
+  rb_hash_aset(stats, ID2SYM(rb_intern("in_progress_bytes")), LONG2NUM(channel->partial_length));
+  return stats;
+}
+
+void Init_tm_frame_framer(void)
+{
+  mCosmos = rb_define_module("Cosmos");
+
+  tm_fecf_table_init();
+  cTmFrameFramer = rb_define_class_under(mCosmos, "TmFrameFramer", rb_cObject);
+  rb_define_alloc_func(cTmFrameFramer, tm_frame_framer_alloc);
+  rb_define_method(cTmFrameFramer, "initialize", tm_frame_framer_initialize, 3);
+  rb_define_method(cTmFrameFramer, "frame", tm_frame_framer_frame, 2);
+  rb_define_method(cTmFrameFramer, "reset", tm_frame_framer_reset, 0);
+  rb_define_method(cTmFrameFramer, "stats", tm_frame_framer_stats, -1);
+}
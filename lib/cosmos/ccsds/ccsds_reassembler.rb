@@ -0,0 +1,63 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'cosmos/ext/ccsds'
+
+module Cosmos
+
+  # Unsegments CCSDS packets from any number of interleaved APIDs. Unlike
+  # {CcsdsParser} the reassembly state is kept separately for each APID and
+  # the primary header is parsed natively. The segments are kept without
+  # being copied and are concatenated once when the last segment arrives.
+  # The reassembled data is the first segment followed by the data of the
+  # remaining segments, as returned by {CcsdsParser#unsegment_packet}.
+  #
+  # Segments which are out of sequence are counted in {#stats} for their
+  # APID rather than raising an error.
+  class CcsdsReassembler
+
+    # @!method unsegment(data)
+    #   Reassemble a segment of a CCSDS packet. Implemented in C for speed.
+    #
+    #   @param data [String] A complete CCSDS packet including the primary
+    #     header
+    #   @return [String|nil] The reassembled packet once the last segment is
+    #     received, the data of a standalone packet or nil if the packet is
+    #     not yet complete or was discarded
+
+    # @!method stats(apid)
+    #   @param apid [Integer] The APID
+    #   @return [Hash|nil] Reassembly statistics for the APID or nil if no
+    #     packets have been received with the APID. The keys are :packets,
+    #     :completed, :missing (sequence counts skipped), :discarded
+    #     (partially reassembled packets dropped), :unexpected (segments
+    #     received out of order) and :in_progress_bytes.
+
+    # @!method apids
+    #   @return [Array<Integer>] The APIDs which have been received
+
+    # @!method in_progress?(apid)
+    #   @param apid [Integer] The APID
+    #   @return [Boolean] Whether a packet is being reassembled for the APID
+
+    # @!method reset(apid = nil)
+    #   Drop the packets being reassembled and clear the statistics
+    #
+    #   @param apid [Integer|nil] The APID to reset or nil to reset every APID
+
+    # @param packet [Packet] A CCSDS packet
+    # @return (see #unsegment)
+    def unsegment_packet(packet)
+      unsegment(packet.buffer(false))
+    end
+
+  end # class CcsdsReassembler
+
+end # module Cosmos
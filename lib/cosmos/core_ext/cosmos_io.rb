@@ -26,4 +26,14 @@ module CosmosIO
   # @param length_num_bytes [Integer] Number of bytes in the length field
   # @return [String] A String of "length field" number of bytes
   # def read_length_bytes(length_num_bytes)
+
+  # Writes an Array of Strings with a single system call without blocking
+  # and without joining them first. Raises IO::EAGAINWaitWritable if the IO
+  # is not ready for writing. Unlike IO#write_nonblock the mode of the file
+  # descriptor is not changed. Only defined where writev is available.
+  #
+  # @param segments [Array<String>] Strings to write in order
+  # @return [Integer] Number of bytes written which may be less than the
+  #   total length of the segments
+  # def writev_nonblock(segments)
 end
@@ -84,6 +84,34 @@ module Cosmos
     # @return [Hash<option name, option values>] Hash of options supplied to interface/router
     attr_accessor :options
 
+    # @return [Integer] Maximum number of packets queued for the router write
+    #   thread. 0 writes packets synchronously from the interface thread.
+    #   (when used as a Router)
+    attr_accessor :async_write_queue_depth
+
+    # @return [Symbol] What happens when the router write queue is full. See
+    #   {RingBufferQueue::OVERFLOW_POLICIES}. (when used as a Router)
+    attr_accessor :async_write_queue_overflow
+
+    # @return [RouterWriteThread] Thread writing queued packets
+    #   (when used as a Router)
+    attr_accessor :async_writer
+
+    # @return [Boolean] Whether the interface reads and identifies packets in
+    #   a separate worker process. See {InterfaceWorker}.
+    attr_accessor :worker_process
+
+    # @return [LatencyStats] Packet processing latency histograms. Created
+    #   by the {InterfaceThread}.
+    attr_accessor :latency_stats
+
+    # The default maximum number of packets returned by {#read_batch}
+    DEFAULT_READ_BATCH_SIZE = 100
+
+    # The default number of packets queued for each router. Routers write
+    # synchronously unless a WRITE_QUEUE is configured.
+    DEFAULT_ASYNC_WRITE_QUEUE_DEPTH = 0
+
     # Initialize default attribute values
     def initialize
       @name = self.class.to_s
@@ -108,6 +136,11 @@ module Cosmos
       @write_allowed = true
       @write_raw_allowed = true
       @options = {}
+      @async_write_queue_depth = DEFAULT_ASYNC_WRITE_QUEUE_DEPTH
+      @async_write_queue_overflow = :DROP_OLDEST
+      @async_writer = nil
+      @worker_process = false
+      @latency_stats = nil
     end
 
     # Connects the interface to its target(s). Must be implemented by a
@@ -134,12 +167,46 @@ module Cosmos
       raise "Interface read method not implemented"
     end
 
+    # Retrieves the next packets from the interface. Blocks until at least
+    # one packet is available. Subclasses which can return several packets
+    # already received should override this method. The default returns the
+    # packet from a single call to {#read}.
+    #
+    # @param max_packets [Integer] Maximum number of packets to return
+    # @return [Array<Packet>|nil] The packets read or nil if the interface
+    #   disconnected
+    def read_batch(max_packets = DEFAULT_READ_BATCH_SIZE)
+      packet = read()
+      return nil unless packet
+      [packet]
+    end
+
     # Method to send a packet on the interface. Must be implemented by a
     # subclass.
     def write(packet)
       raise "Interface write method not implemented"
     end
 
+    # Writes several packets to the interface. Subclasses which can write
+    # several packets with fewer system calls should override this method.
+    # The default calls {#write} for each packet. A packet which fails to
+    # write does not keep the rest of the batch from being written.
+    #
+    # @param packets [Array<Packet>] Packets to write in order
+    # @raise The error of the first packet which failed to write once every
+    #   packet has been written
+    def write_batch(packets)
+      error = nil
+      packets.each do |packet|
+        begin
+          write(packet)
+        rescue => err
+          error ||= err
+        end
+      end
+      raise error if error
+    end
+
     # Writes preformatted data onto the interface. Malformed data may cause
     # problems. Must be implemented by a subclass.
     def write_raw(data)
@@ -178,8 +245,8 @@ module Cosmos
     end
 
     # Copy settings from this interface to another interface. All instance
-    # variables are copied except for thread, num_clients, read_queue_size,
-    # and write_queue_size since these are all specific to the operation of the
+    # variables are copied except for thread, async_writer, num_clients,
+    # read_queue_size, and write_queue_size since these are all specific to the operation of the
     # interface rather than its instantiation.
     #
     # @param other_interface [Interface] The other interface to copy to
@@ -203,6 +270,10 @@ module Cosmos
       # write_queue_size is the number of packets in the queue so don't copy
       other_interface.interfaces = self.interfaces.clone
       other_interface.options = self.options.clone
+      other_interface.async_write_queue_depth = self.async_write_queue_depth
+      other_interface.async_write_queue_overflow = self.async_write_queue_overflow
+      # The other interface has its own async_writer
+      other_interface.worker_process = self.worker_process
     end
 
     # Set an interface or router specific option
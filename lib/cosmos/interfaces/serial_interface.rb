@@ -50,6 +50,8 @@ module Cosmos
       @stop_bits = stop_bits
       @write_timeout = write_timeout
       @read_timeout = read_timeout
+      @read_buffer_size = nil
+      @inter_byte_timeout = nil
 
       @write_allowed     = false unless @write_port_name
       @write_raw_allowed = false unless @write_port_name
@@ -66,11 +68,38 @@ module Cosmos
         @parity,
         @stop_bits,
         @write_timeout,
-        @read_timeout)
+        @read_timeout,
+        @read_buffer_size,
+        @inter_byte_timeout)
       stream.raw_logger_pair = @raw_logger_pair
       @stream_protocol.connect(stream)
     end
 
+    # @return [Hash|nil] Error counters of the read port while connected. See
+    #   {SerialDriver#error_counts}.
+    def error_counts
+      stream = @stream_protocol.stream
+      stream ? stream.error_counts : nil
+    end
+
+    # Supported Options
+    # READ_BUFFER_SIZE - Size in bytes of the buffer the read port is read
+    #   into by a native thread. Data received while the buffer is full is
+    #   dropped and logged. By default the port is read in the interface
+    #   thread.
+    # INTER_BYTE_TIMEOUT - Seconds of silence after which a partial read is
+    #   returned. Allows the driver to read up to 255 bytes per system call.
+    # (see StreamInterface#set_option)
+    def set_option(option_name, option_values)
+      super(option_name, option_values)
+      case option_name.upcase
+      when 'READ_BUFFER_SIZE'
+        @read_buffer_size = Integer(option_values[0])
+      when 'INTER_BYTE_TIMEOUT'
+        @inter_byte_timeout = Float(option_values[0])
+      end
+    end
+
   end # class SerialInterface
 
 end # module Cosmos
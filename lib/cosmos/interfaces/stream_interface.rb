@@ -17,6 +17,8 @@ require 'cosmos/streams/length_stream_protocol'
 require 'cosmos/streams/preidentified_stream_protocol'
 require 'cosmos/streams/template_stream_protocol'
 require 'cosmos/streams/terminated_stream_protocol'
+require 'cosmos/streams/tmframe_stream_protocol'
+require 'cosmos/streams/crc_check'
 
 module Cosmos
 
@@ -58,6 +60,18 @@ module Cosmos
       packet
     end
 
+    # Read all the complete packets buffered by the stream protocol
+    #
+    # @param max_packets (see Interface#read_batch)
+    # @return (see Interface#read_batch)
+    def read_batch(max_packets = DEFAULT_READ_BATCH_SIZE)
+      # Subclasses which process each packet in read must be called per packet
+      return super(max_packets) unless method(:read).owner == StreamInterface
+      packets = @stream_protocol.read_batch(max_packets)
+      @read_count += packets.length if packets
+      packets
+    end
+
     # Write a packet to the stream protocol
     #
     # @param packet [Packet]
@@ -114,6 +128,26 @@ module Cosmos
       @stream_protocol.bytes_written = bytes_written
     end
 
+    # @return [Integer] The number of packets which failed the CRC check
+    def crc_failures
+      if @stream_protocol.crc_check
+        @stream_protocol.crc_check.failures
+      else
+        0
+      end
+    end
+
+    # Supported Options
+    # CRC - Validate a CRC in each packet read. The values are passed to
+    #   {CrcCheck#initialize}.
+    # (see Interface#set_option)
+    def set_option(option_name, option_values)
+      super(option_name, option_values)
+      if option_name.upcase == 'CRC'
+        @stream_protocol.crc_check = CrcCheck.new(*option_values)
+      end
+    end
+
     # These methods do not exist in StreamInterface but can be implemented by
     # subclasses and will be called by the {StreamProtocol} when processing
     # the data in the {Stream}.
@@ -40,6 +40,7 @@ module Cosmos
       @read_allowed = false unless @read_port
       @write_allowed = false unless @write_port
       @write_raw_allowed = false unless @write_port
+      @local_socket = false
     end
 
     # Connects the {StreamProtocol} to a {TcpipClientStream} by passing the
@@ -50,11 +51,27 @@ module Cosmos
         @write_port,
         @read_port,
         @write_timeout,
-        @read_timeout)
+        @read_timeout,
+        5.0,
+        @local_socket)
       stream.raw_logger_pair = @raw_logger_pair
       @stream_protocol.connect(stream)
     end
 
+    # Supported Options
+    # LOCAL_SOCKET - Whether to connect to the Unix domain socket of a
+    #   TcpipServer on a loopback hostname when it is listening on one owned
+    #   by the same user. TCP is used otherwise or if the connection fails.
+    #   - Default: FALSE
+    # (see Interface#set_option)
+    def set_option(option_name, option_values)
+      super(option_name, option_values)
+      case option_name.upcase
+      when 'LOCAL_SOCKET'
+        @local_socket = ConfigParser.handle_true_false(option_values[0])
+      end
+    end
+
   end # class TcpipClientInterface
 
 end # module Cosmos
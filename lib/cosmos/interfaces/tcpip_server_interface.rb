@@ -129,6 +129,11 @@ module Cosmos
       @tcpip_server.num_clients
     end
 
+    # (see TcpipServer#client_stats)
+    def client_stats
+      @tcpip_server.client_stats
+    end
+
     # Number of packets buffered in the read queue
     def read_queue_size
       @tcpip_server.read_queue_size
@@ -151,11 +156,26 @@ module Cosmos
 
     # Supported Options
     # LISTEN_ADDRESS - Ip address of the interface to accept connections on - Default: 0.0.0.0
+    # EVENT_LOOP - Whether to serve all clients from a single event loop thread - Default: FALSE
+    # CLIENT_BUFFER_SIZE - Maximum bytes queued for each client by the event loop or NIL for no limit - Default: 4 MB
+    # CLIENT_OVERFLOW - DISCONNECT or SAMPLE when a client's buffer is full - Default: DISCONNECT
+    # LOCAL_SOCKET - Whether to also accept local clients on a Unix domain socket - Default: FALSE
     # (see Interface#set_option)
     def set_option(option_name, option_values)
       super(option_name, option_values)
-      if option_name.upcase == 'LISTEN_ADDRESS'
+      case option_name.upcase
+      when 'LISTEN_ADDRESS'
         @tcpip_server.listen_address = option_values[0]
+      when 'EVENT_LOOP'
+        @tcpip_server.event_loop = ConfigParser.handle_true_false(option_values[0])
+      when 'CLIENT_BUFFER_SIZE'
+        size = ConfigParser.handle_nil(option_values[0])
+        size = Integer(size) if size
+        @tcpip_server.max_output_bytes = size
+      when 'CLIENT_OVERFLOW'
+        @tcpip_server.overflow_policy = option_values[0]
+      when 'LOCAL_SOCKET'
+        @tcpip_server.local_socket = ConfigParser.handle_true_false(option_values[0])
       end
     end
 
@@ -61,6 +61,7 @@ module Cosmos
       @read_timeout = @read_timeout.to_f if @read_timeout
       @bind_address = ConfigParser.handle_nil(bind_address)
       @bind_address = '127.0.0.1' if @bind_address and @bind_address.upcase == 'LOCALHOST'
+      @receive_buffer_size = nil
       @write_socket = nil
       @read_socket = nil
       @read_allowed = false unless @read_port
@@ -78,7 +79,11 @@ module Cosmos
                                          @interface_address,
                                          @ttl,
                                          @bind_address) if @write_dest_port
-      @read_socket = UdpReadSocket.new(@read_port, @hostname, @interface_address, @bind_address) if @read_port
+      @read_socket = UdpReadSocket.new(@read_port,
+                                       @hostname,
+                                       @interface_address,
+                                       @bind_address,
+                                       @receive_buffer_size) if @read_port
     end
 
     # @return [Boolean] Whether the active ports (read and/or write) have
@@ -126,6 +131,41 @@ module Cosmos
       end
     end
 
+    # If the read port was given, every datagram waiting on the read_socket
+    # is read and returned as a {Packet}. The received time of each packet is
+    # the time the kernel received the datagram where the platform reports
+    # it. bytes_read and read_count are updated.
+    #
+    # @param max_packets (see Interface#read_batch)
+    # @return (see Interface#read_batch)
+    def read_batch(max_packets = DEFAULT_READ_BATCH_SIZE)
+      # Subclasses which process each packet in read must be called per packet
+      return super(max_packets) unless method(:read).owner == UdpInterface
+      if @read_port
+        begin
+          datagrams, times = @read_socket.read_batch(max_packets, @read_timeout)
+        rescue IOError
+          # Disconnected
+          Thread.stop
+        end
+
+        packets = []
+        datagrams.each_with_index do |data, index|
+          @raw_logger_pair.read_logger.write(data) if @raw_logger_pair
+          @bytes_read += data.length
+          packet = Packet.new(nil, nil, :BIG_ENDIAN, nil, data)
+          packet.received_time = times[index] if times[index]
+          packets << packet
+        end
+        @read_count += packets.length
+
+        return packets
+      else
+        # Write only interface so stop the thread which calls read
+        Thread.stop
+      end
+    end
+
     # If the write_dest_port was given, the write_socket is written with the
     # packet data. bytes_written and write_count are updated.
     #
@@ -161,6 +201,52 @@ module Cosmos
       end
     end
 
+    # If the write_dest_port was given, the packets are written to the
+    # write_socket with as few system calls as possible. bytes_written and
+    # write_count are updated for the packets which were sent.
+    #
+    # @param packets [Array<Packet>] Packets to write in order
+    # @raise The error of the first packet which failed to send once every
+    #   packet has been written
+    def write_batch(packets)
+      # Subclasses which process each packet in write must be called per packet
+      return super(packets) unless method(:write).owner == UdpInterface
+      if @write_dest_port
+        if connected?()
+          datagrams = packets.map {|packet| packet.buffer(false) }
+          errors = @write_socket.write_batch(datagrams, @write_timeout)
+          datagrams.each_with_index do |data, index|
+            next if errors[index]
+            @bytes_written += data.length
+            @write_count += 1
+            @raw_logger_pair.write_logger.write(data) if @raw_logger_pair
+          end
+          raise errors.values.first unless errors.empty?
+        else
+          raise "Interface not connected"
+        end
+      else
+        raise "Attempt to write to read only interface"
+      end
+    end
+
+    # @return [Integer] The number of datagrams dropped by the read socket
+    #   because its receive buffer was full
+    def datagrams_dropped
+      @read_socket ? @read_socket.dropped : 0
+    end
+
+    # Supported Options
+    # RECEIVE_BUFFER_SIZE - Size of the read socket receive buffer in bytes.
+    #   Takes effect the next time the interface connects.
+    # (see Interface#set_option)
+    def set_option(option_name, option_values)
+      super(option_name, option_values)
+      if option_name.upcase == 'RECEIVE_BUFFER_SIZE'
+        @receive_buffer_size = Integer(option_values[0])
+      end
+    end
+
   end # class UdpInterface
 
 end # module Cosmos
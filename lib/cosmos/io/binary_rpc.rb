@@ -0,0 +1,54 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Lesser General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'cosmos/ext/binary_rpc'
+
+module Cosmos
+
+  # Binary encoding of JSON-RPC messages which can be used by {JsonDRb}
+  # instead of JSON. Objects are encoded in the MessagePack format so binary
+  # strings are sent as raw bytes instead of arrays of integers, integers and
+  # floats keep their binary form and Time objects keep their type.
+  #
+  # Binary messages start with {MARKER} which is never the first byte of a
+  # JSON message or a MessagePack object. This lets a server answer each
+  # message in the encoding it was sent in.
+  module BinaryRpc
+    # First byte of every binary message
+    MARKER = "\xC1".freeze
+    # MessagePack extension type of Time
+    TIME_EXT = -1
+    # MessagePack extension type of integers which do not fit in 64 bits.
+    # The value is the integer in decimal.
+    BIGNUM_EXT = 1
+
+    # @param data [String] A message received by JsonDRb
+    # @return [Boolean] Whether the message is binary encoded
+    def self.message?(data)
+      data.getbyte(0) == 0xC1
+    end
+
+    # Objects are encoded as MessagePack nil, boolean, integer, float, str,
+    # bin, array and map types with extensions for Time and integers which do
+    # not fit in 64 bits. Hash keys are converted to strings as they are in
+    # JSON. Exceptions and JsonRpc objects are encoded as their to_h value and
+    # other objects as their as_json value.
+    #
+    # @param object [Object] The object to encode
+    # @return [String] The binary message
+    # def self.dump(object)
+
+    # @param data [String] A binary message created by {.dump}
+    # @return [Object] The decoded object
+    # def self.load(data)
+
+  end # module BinaryRpc
+
+end # module Cosmos
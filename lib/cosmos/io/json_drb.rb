@@ -23,6 +23,10 @@ module Cosmos
   # provides methods to install an access control list to control access to the
   # API. It also limits the available methods to a known list of allowable API
   # methods.
+  #
+  # Requests may also be encoded with {BinaryRpc} instead of JSON. Each
+  # response is encoded the same way as its request so clients choose the
+  # encoding and JSON clients are unaffected.
   class JsonDRb
     MINIMUM_REQUEST_TIME = 0.0001
     FAST_READ = (RUBY_VERSION > "2.1")
@@ -329,9 +333,15 @@ module Cosmos
     # @param my_socket [Socket] The socket to send the response out on
     # @param start_time [Time] The time when the initial request was received
     def process_request(request_data, my_socket, start_time)
-      STDOUT.puts request_data if JsonDRb.debug?
+      binary = BinaryRpc.message?(request_data)
+      STDOUT.puts request_data if JsonDRb.debug? and !binary
       begin
-        request = JsonRpcRequest.from_json(request_data)
+        if binary
+          request = JsonRpcRequest.from_binary(request_data)
+          STDOUT.puts request.to_json(:allow_nan => true) if JsonDRb.debug?
+        else
+          request = JsonRpcRequest.from_json(request_data)
+        end
         response = nil
 
         if (@method_whitelist and @method_whitelist.include?(request.method)) or
@@ -361,17 +371,21 @@ module Cosmos
               JsonRpcError.new(-1, "Cannot call unauthorized methods"), request.id)
           end
         end
-        process_response(response, my_socket, start_time) if response
+        process_response(response, my_socket, start_time, binary) if response
       rescue => error
         response = JsonRpcErrorResponse.new(JsonRpcError.new(-32600, "Invalid Request", error), nil)
-        process_response(response, my_socket, start_time)
+        process_response(response, my_socket, start_time, binary)
       end
       true
     end
 
-    def process_response(response, socket, start_time)
-      response_data = response.to_json(:allow_nan => true)
-      STDOUT.puts response_data if JsonDRb.debug?
+    def process_response(response, socket, start_time, binary = false)
+      STDOUT.puts response.to_json(:allow_nan => true) if JsonDRb.debug?
+      if binary
+        response_data = response.to_binary
+      else
+        response_data = response.to_json(:allow_nan => true)
+      end
       JsonDRb.send_data(socket, response_data)
       end_time = Time.now
       request_time = end_time - start_time
@@ -29,11 +29,23 @@ module Cosmos
   #   server = JsonDRbObject('127.0.0.1', 7777)
   #   server.cmd(*args)
   #
+  # Requests are JSON encoded unless the :binary encoding is given. Binary
+  # requests are sent with {BinaryRpc} until a server answers one with JSON
+  # which means the server does not support them. JSON is then used for the
+  # rest of the requests.
   class JsonDRbObject
+    # Supported request encodings
+    ENCODINGS = [:json, :binary]
+
+    # @return [Symbol] The encoding used for requests. One of {ENCODINGS}.
+    attr_reader :encoding
+
     # @param hostname [String] The name of the machine which has started
     #   the JSON service
     # @param port [Integer] The port number of the JSON service
-    def initialize(hostname, port, connect_timeout = 1.0)
+    # @param connect_timeout [Float] Seconds to wait for the connection
+    # @param encoding [Symbol] One of {ENCODINGS}
+    def initialize(hostname, port, connect_timeout = 1.0, encoding = :json)
       hostname = '127.0.0.1' if (hostname.to_s.upcase == 'LOCALHOST')
       begin
         @addr = Socket.pack_sockaddr_in(port, hostname)
@@ -54,6 +66,8 @@ module Cosmos
       @connect_timeout = connect_timeout
       @connect_timeout = @connect_timeout.to_f if @connect_timeout
       @shutdown = false
+      @encoding = encoding.to_s.downcase.intern
+      raise ArgumentError, "Invalid encoding: #{encoding}. Must be one of #{ENCODINGS.join(', ')}." unless ENCODINGS.include?(@encoding)
     end
 
     # Disconnects from the JSON server
@@ -98,6 +112,11 @@ module Cosmos
             first_try = false
             next if was_first_try
           end
+          if response and @encoding == :binary and !BinaryRpc.message?(response)
+            # The server could not parse the binary request so use JSON
+            @encoding = :json
+            next
+          end
           return handle_response(response)
         end # loop
       end # @mutex.synchronize
@@ -156,16 +175,20 @@ module Cosmos
       request = JsonRpcRequest.new(method_name, method_params, @id)
       @id += 1
 
-      request_data = request.to_json(:allow_nan => true)
+      if @encoding == :binary
+        request_data = request.to_binary
+      else
+        request_data = request.to_json(:allow_nan => true)
+      end
       begin
         STDOUT.puts "Request:\n" if JsonDRb.debug?
-        STDOUT.puts request_data if JsonDRb.debug?
+        STDOUT.puts request.to_json(:allow_nan => true) if JsonDRb.debug?
         @request_in_progress = true
         JsonDRb.send_data(@socket, request_data)
         response_data = JsonDRb.receive_message(@socket, '', @pipe_reader)
         @request_in_progress = false
         STDOUT.puts "\nResponse:\n" if JsonDRb.debug?
-        STDOUT.puts response_data if JsonDRb.debug?
+        STDOUT.puts response_data if JsonDRb.debug? and response_data and !BinaryRpc.message?(response_data)
       rescue => e
         disconnect()
         @socket = nil
@@ -178,7 +201,11 @@ module Cosmos
     def handle_response(response_data)
       # The code below will always either raise or return breaking out of the loop
       if response_data
-        response = JsonRpcResponse.from_json(response_data)
+        if BinaryRpc.message?(response_data)
+          response = JsonRpcResponse.from_binary(response_data)
+        else
+          response = JsonRpcResponse.from_json(response_data)
+        end
         if JsonRpcErrorResponse === response
           if response.error.data
             raise Exception.from_hash(response.error.data)
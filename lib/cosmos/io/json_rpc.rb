@@ -9,6 +9,7 @@
 # attribution addendums as found in the LICENSE.txt
 
 require 'json'
+require 'cosmos/io/binary_rpc'
 
 class Object
   def as_json(options = nil) #:nodoc:
@@ -103,7 +104,7 @@ class DateTime
 end
 
 class Exception
-  def as_json(*a)
+  def to_h
     hash = {}
     hash['class'] = self.class.name
     hash['message'] = self.message
@@ -113,7 +114,11 @@ class Exception
       instance_vars[instance_var_name.to_s] = self.instance_variable_get(instance_var_name.to_s.intern)
     end
     hash['instance_variables'] = instance_vars
-    hash.as_json(*a)
+    hash
+  end
+
+  def as_json(*a)
+    to_h.as_json(*a)
   end
 
   def to_json(*a)
@@ -171,6 +176,16 @@ module Cosmos
     def to_json(*a)
       as_json(*a).to_json(*a)
     end
+
+    # @return [Hash] The members of the object
+    def to_h
+      @hash
+    end
+
+    # @return [String] The {BinaryRpc} encoded String
+    def to_binary
+      BinaryRpc.dump(@hash)
+    end
   end
 
   # Represents a JSON Remote Procedure Call Request
@@ -223,6 +238,21 @@ module Cosmos
       end
     end
 
+    # Creates a JsonRpcRequest object from a {BinaryRpc} encoded String with
+    # the same members as the JSON request.
+    #
+    # @param request_data [String] Binary string representing the request
+    # @return [JsonRpcRequest]
+    def self.from_binary(request_data)
+      begin
+        hash = BinaryRpc.load(request_data)
+        raise unless (hash['jsonrpc'.freeze] == "2.0".freeze && hash['method'.freeze] && hash['id'.freeze])
+        self.from_hash(hash)
+      rescue
+        raise "Invalid JSON-RPC 2.0 Request"
+      end
+    end
+
     # Creates a JsonRpcRequest object from a Hash
     #
     # @param hash [Hash] Hash containing the following keys: method, params,
@@ -250,12 +280,38 @@ module Cosmos
     # @param response_data [String] JSON encoded string representing the response
     # @return [JsonRpcResponse]
     def self.from_json(response_data)
-      msg = "Invalid JSON-RPC 2.0 Response"
       begin
         hash = JSON.parse(response_data, :allow_nan => true, :create_additions => true)
       rescue
-        raise msg
+        raise "Invalid JSON-RPC 2.0 Response"
+      end
+      JsonRpcResponse.from_hash(hash)
+    end
+
+    # Creates a JsonRpcResponse object from a {BinaryRpc} encoded String with
+    # the same members as the JSON response.
+    #
+    # @param response_data [String] Binary string representing the response
+    # @return [JsonRpcResponse]
+    def self.from_binary(response_data)
+      begin
+        hash = BinaryRpc.load(response_data)
+      rescue
+        raise "Invalid JSON-RPC 2.0 Response"
       end
+      JsonRpcResponse.from_hash(hash)
+    end
+
+    # Creates a JsonRpcSuccessResponse or JsonRpcErrorResponse object from a
+    # Hash. The version must be 2.0 and the Hash must include the id key. It
+    # must also include either result for success or error for failure but
+    # never both.
+    #
+    # @param hash [Hash] Hash containing the response keys
+    # @return [JsonRpcResponse]
+    def self.from_hash(hash)
+      msg = "Invalid JSON-RPC 2.0 Response"
+      raise msg unless Hash === hash
 
       # Verify the jsonrpc version is correct and there is an ID
       raise msg unless hash['jsonrpc'.freeze] == "2.0".freeze and hash.key?('id'.freeze)
@@ -0,0 +1,92 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'cosmos/ext/poller'
+
+module Cosmos
+
+  # Waits for any number of IOs to become readable or writable from a single
+  # thread. The native implementation uses epoll where available and poll
+  # elsewhere. This IO.select based implementation is only used on platforms
+  # without either.
+  unless defined? Poller
+    class Poller
+      # Event returned when an IO is ready to read
+      READABLE = 1
+      # Event returned when an IO is ready to write
+      WRITABLE = 2
+      # The mechanism used to wait for events
+      BACKEND = :select
+
+      def initialize
+        @ios = {}
+        @wakeup_reader, @wakeup_writer = IO.pipe
+      end
+
+      # @param io [IO] The IO to watch. Registering an IO which is already
+      #   registered changes the events it is watched for.
+      # @param events [Integer] READABLE, WRITABLE or both OR'd together
+      def register(io, events)
+        @ios[io] = events
+        io
+      end
+
+      # @param io [IO] The IO to stop watching
+      def deregister(io)
+        @ios.delete(io) ? io : nil
+      end
+
+      # @param timeout [Float|nil] Maximum number of seconds to wait or nil to
+      #   wait until an IO is ready or {#wakeup} is called
+      # @return [Array<Array(IO, Integer)>] Each ready IO and the events it is
+      #   ready for
+      def wait(timeout = nil)
+        readers = [@wakeup_reader]
+        writers = []
+        @ios.each do |io, events|
+          readers << io if (events & READABLE) != 0
+          writers << io if (events & WRITABLE) != 0
+        end
+        readable, writable, _ = IO.select(readers, writers, nil, timeout)
+        return [] unless readable
+
+        if readable.delete(@wakeup_reader)
+          begin
+            @wakeup_reader.read_nonblock(64) while true
+          rescue IO::WaitReadable, EOFError
+          end
+        end
+        events = Hash.new(0)
+        readable.each {|io| events[io] |= READABLE }
+        writable.each {|io| events[io] |= WRITABLE }
+        events.to_a
+      end
+
+      # Wake up a thread blocked in {#wait}
+      def wakeup
+        @wakeup_writer.write_nonblock('.') rescue nil
+        nil
+      end
+
+      # @return [Integer] The number of registered IOs
+      def size
+        @ios.length
+      end
+
+      # Stop watching every IO. The registered IOs are not closed.
+      def close
+        @ios.clear
+        @wakeup_reader.close unless @wakeup_reader.closed?
+        @wakeup_writer.close unless @wakeup_writer.closed?
+      end
+    end
+  end
+
+end # module Cosmos
@@ -11,19 +11,38 @@
 require 'fcntl'
 require 'termios' # Requires ruby-termios gem
 require 'timeout' # For Timeout::Error
+require 'cosmos/ext/serial_reader'
 
 module Cosmos
 
-  # Serial driver for use on Posix serial ports found on UNIX based systems
+  # Serial driver for use on Posix serial ports found on UNIX based systems.
+  #
+  # When a read buffer size is given and the native {SerialReader} is
+  # available the port is read by a native thread into a ring buffer so data
+  # keeps arriving while the Ruby thread processes it. Each {#read} returns
+  # everything buffered since the last read.
   class PosixSerialDriver
+    # Most bytes written by one system call. A serial port reports it is
+    # writable while only a few hundred bytes are queued so a write this size
+    # does not block long past the write timeout even at low baud rates.
+    WRITE_CHUNK_SIZE = 256
 
     # (see SerialDriver#initialize)
+    # @param read_buffer_size [Integer|nil] Size of the native read ring
+    #   buffer in bytes. Data which arrives while the buffer is full is dropped
+    #   and logged. 0 or nil reads in the calling thread.
+    # @param inter_byte_timeout [Float|nil] Seconds of silence after which a
+    #   partial read is returned. Reads otherwise wait for 255 bytes which
+    #   reduces the number of system calls at high baud rates. nil returns
+    #   every byte as soon as it arrives.
     def initialize(port_name = '/dev/ttyS0',
                    baud_rate = 9600,
                    parity = :NONE,
                    stop_bits = 1,
                    write_timeout = 10.0,
-                   read_timeout = nil)
+                   read_timeout = nil,
+                   read_buffer_size = nil,
+                   inter_byte_timeout = nil)
 
       # Convert Baud Rate into Termios constant
       begin
@@ -61,16 +80,32 @@ module Cosmos
       tio.oflag = 0
       tio.cflag = cflags
       tio.lflag = 0
-      tio.cc[Termios::VTIME] = 0
-      tio.cc[Termios::VMIN] = 1
+      if inter_byte_timeout
+        # VTIME is in tenths of a second and only starts after the first byte
+        tio.cc[Termios::VTIME] = [[(inter_byte_timeout.to_f * 10).ceil, 1].max, 255].min
+        tio.cc[Termios::VMIN] = 255
+      else
+        tio.cc[Termios::VTIME] = 0
+        tio.cc[Termios::VMIN] = 1
+      end
       tio.ispeed = baud_rate
       tio.ospeed = baud_rate
       @handle.tcflush(Termios::TCIOFLUSH)
       @handle.tcsetattr(Termios::TCSANOW, tio)
+
+      @port_name = port_name
+      @reader = nil
+      @bytes_dropped = 0
+      read_buffer_size = Integer(read_buffer_size || 0)
+      @reader = SerialReader.new(@handle, read_buffer_size) if defined? SerialReader and read_buffer_size > 0
     end
 
     # (see SerialDriver#close)
     def close
+      if @reader
+        @reader.stop
+        @reader = nil
+      end
       if @handle
         # Close the serial Port
         @handle.close
@@ -89,6 +124,10 @@ module Cosmos
 
     # (see SerialDriver#write)
     def write(data)
+      # write_nonblock would set O_NONBLOCK on the port which makes the reader
+      # thread's reads ignore VMIN and VTIME
+      return write_blocking(data) if @reader
+
       num_bytes_to_send = data.length
       total_bytes_sent = 0
       bytes_sent = 0
@@ -113,6 +152,13 @@ module Cosmos
 
     # (see SerialDriver#read)
     def read
+      if @reader
+        data = @reader.read(@read_timeout)
+        raise Timeout::Error, "Read Timeout" unless data
+        log_dropped_bytes()
+        return data
+      end
+
       begin
         data = @handle.read_nonblock(65535)
       rescue Errno::EAGAIN, Errno::EWOULDBLOCK
@@ -129,6 +175,11 @@ module Cosmos
 
     # (see SerialDriver#read_nonblock)
     def read_nonblock
+      if @reader
+        data = @reader.read_nonblock
+        log_dropped_bytes()
+        return data
+      end
       data = ''
 
       begin
@@ -140,6 +191,44 @@ module Cosmos
       data
     end
 
+    # (see SerialDriver#error_counts)
+    def error_counts
+      return nil unless @reader
+      counts = @reader.error_counts || {}
+      counts.merge(@reader.stats)
+    end
+
+    protected
+
+    # Write with blocking system calls once the port is writable so the
+    # port is never put in non-blocking mode. The data is written in chunks
+    # of {WRITE_CHUNK_SIZE} bytes and the write timeout is checked before
+    # each chunk.
+    def write_blocking(data)
+      deadline = Process.clock_gettime(Process::CLOCK_MONOTONIC) + @write_timeout if @write_timeout
+      total_bytes_sent = 0
+      while total_bytes_sent < data.length
+        timeout = nil
+        if deadline
+          timeout = deadline - Process.clock_gettime(Process::CLOCK_MONOTONIC)
+          raise Timeout::Error, "Write Timeout" if timeout <= 0
+        end
+        result = IO.fast_select(nil, [@handle], nil, timeout)
+        raise Timeout::Error, "Write Timeout" unless result
+        total_bytes_sent += @handle.syswrite(data[total_bytes_sent, WRITE_CHUNK_SIZE])
+      end
+    end
+
+    # Log the data the native reader dropped since the last read because
+    # its ring buffer was full
+    def log_dropped_bytes
+      bytes_dropped = @reader.stats[:bytes_dropped]
+      if bytes_dropped > @bytes_dropped
+        Logger.warn "#{@port_name}: Dropped #{bytes_dropped - @bytes_dropped} bytes because the read buffer was full"
+        @bytes_dropped = bytes_dropped
+      end
+    end
+
   end # class PosixSerialDriver
 
 end # module Cosmos
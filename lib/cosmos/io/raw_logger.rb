@@ -11,11 +11,20 @@
 require 'thread'
 require 'socket' # For gethostname
 require 'cosmos/config/config_parser'
+require 'cosmos/io/raw_logger_writer'
 
 module Cosmos
 
   # Creates a log file of raw data for either reads or writes. Can automatically
   # cycle the log based on when the log file reaches a predefined size.
+  #
+  # An asynchronous logger appends data to an in memory buffer which is
+  # written to the file by a {RawLoggerWriter} thread so the thread reading or
+  # writing the interface is not delayed by the disk. The writer swaps the
+  # full buffer for an empty one and writes it in a single call once the
+  # buffer is half full or the flush interval passes. Clones share the
+  # writer thread. Data which does not fit in the buffer is dropped, counted
+  # in {#bytes_dropped} and logged.
   class RawLogger
 
     # @return [String] The filename of the log
@@ -30,6 +39,12 @@ module Cosmos
     # @retuen [String] Original name passed to raw logger
     attr_reader :orig_name
 
+    # @return [Integer] The most bytes which have been buffered at once
+    attr_reader :high_water_mark
+
+    # @return [Integer] Number of bytes dropped because the buffer was full
+    attr_reader :bytes_dropped
+
     # The allowable log types
     LOG_TYPES = [:READ, :WRITE]
 
@@ -37,6 +52,13 @@ module Cosmos
     # granularity.
     CYCLE_TIME_INTERVAL = 60
 
+    # The default maximum number of bytes buffered for the writer thread
+    DEFAULT_BUFFER_SIZE = 4000000
+
+    # The default maximum number of seconds data is buffered before it is
+    # written
+    DEFAULT_FLUSH_INTERVAL = 1.0
+
     # @param log_name [String] The name of the raw logger.  Typically matches the
     #    name of the corresponding interface
     # @param log_type [Symbol] The type of log to create. Must be :READ
@@ -49,12 +71,22 @@ module Cosmos
     #   independently.
     # @param log_directory [String] The directory to store the log files.
     #   Passing nil will use the system default 'LOGS' directory.
+    # @param asynchronous [Boolean] Whether to buffer the data and write it to
+    #   the log from a writer thread rather than in the caller's thread.
+    #   Asynchronous loggers drop data when the buffer is full.
+    # @param buffer_size [Integer] Maximum number of bytes buffered when
+    #   asynchronous. Data written while the buffer is full is dropped.
+    # @param flush_interval [Float] Maximum number of seconds data is buffered
+    #   when asynchronous
     def initialize(
       log_name,
       log_type,
       logging_enabled = false,
       cycle_size = 2000000000,
-      log_directory = nil
+      log_directory = nil,
+      asynchronous = false,
+      buffer_size = DEFAULT_BUFFER_SIZE,
+      flush_interval = DEFAULT_FLUSH_INTERVAL
     )
       raise "log_type must be :READ or :WRITE" unless LOG_TYPES.include? log_type
       @log_type = log_type
@@ -72,6 +104,10 @@ module Cosmos
       @filename = nil
       @start_time = Time.now
       @logging_enabled = ConfigParser.handle_true_false(logging_enabled)
+      @asynchronous = ConfigParser.handle_true_false(asynchronous)
+      @buffer_size = Integer(buffer_size)
+      @flush_interval = Float(flush_interval)
+      reset_buffers()
     end
 
     # Set the raw logger name
@@ -81,30 +117,46 @@ module Cosmos
       @log_name = (log_name.to_s.downcase + '_raw_' + @log_type.to_s.downcase + '_' + self.object_id.to_s).freeze
     end
 
-    # Write data to the log file.
+    # Write data to the log file. If the logger is asynchronous the data is
+    # copied into the buffer and written by the writer thread. Otherwise the
+    # data is written in the caller's thread context.
     #
     # If no log file currently exists in the filesystem, a new file will be
     # created.
     #
-    # Writing a log file is a critical operation so the entire method is
-    # wrapped with a rescue and handled with handle_critical_exception
-    #
     # @param data [String] The data to write to the log file
     def write(data)
       if @logging_enabled
         return if !data or data.length <= 0
-        need_new_file = false
-        @mutex.synchronize do
-          if !@file or (@cycle_size and (@file.stat.size + data.length) > @cycle_size)
-            need_new_file = true
-          end
+        if @asynchronous
+          buffer_data(data)
+        else
+          write_data(data)
         end
-        start_new_file() if need_new_file
-        @mutex.synchronize { @file.write(data) if @file }
       end
-    rescue => err
-      Logger.instance.error "Error writing #{@filename} : #{err.formatted}"
-      Cosmos.handle_critical_exception(err)
+    end
+
+    # Write any buffered data to the log file. Returns once the data has been
+    # written.
+    def flush
+      @flush_mutex.synchronize do
+        @buffer_mutex.synchronize do
+          @buffer, @back_buffer = @back_buffer, @buffer
+          # Stay quiet about dropped data until a whole buffer fits
+          @overloaded = @dropping
+          @dropping = false
+        end
+        unless @back_buffer.empty?
+          write_data(@back_buffer, true)
+          @back_buffer.clear
+        end
+      end
+    end
+
+    # @return [Integer] The number of bytes buffered which have not been
+    #   written to the log file
+    def bytes_buffered
+      @buffer_mutex.synchronize { @buffer.length }
     end
 
     # Starts a new log file by closing the existing log file. New log files are
@@ -115,21 +167,107 @@ module Cosmos
       @mutex.synchronize { @logging_enabled = true }
     end
 
-    # Stops all logging and closes the current log file.
+    # Stops all logging, writes any buffered data and closes the current log
+    # file.
     def stop
       @mutex.synchronize { @logging_enabled = false }
+      stop_writing()
+      flush()
       close_file()
     end
 
-    # Create a clone of this object with a new name
+    # Forget the data buffered and the writer thread started by the parent
+    # process. Must be called by a forked child before it writes. The parent
+    # writes the data it buffered and the writer thread does not exist in the
+    # child.
+    def reset_after_fork
+      reset_buffers()
+    end
+
+    # Create a clone of this object with a new name. The clone has its own
+    # log file and buffer but shares the writer thread.
     def clone
       raw_logger = super()
       raw_logger.name = raw_logger.orig_name
+      raw_logger.send(:reset_buffers, @writer)
       raw_logger
     end
 
     protected
 
+    # @param writer [RawLoggerWriter|nil] The writer to share or nil to
+    #   create one
+    def reset_buffers(writer = nil)
+      @buffer = ''
+      @back_buffer = ''
+      @buffer_mutex = Mutex.new
+      @flush_mutex = Mutex.new
+      @writer = writer || RawLoggerWriter.new(@flush_interval)
+      @writing = false
+      @overloaded = false
+      @dropping = false
+      @high_water_mark = 0
+      @bytes_dropped = 0
+    end
+
+    def buffer_data(data)
+      dropped = false
+      # Binary data from a string in another encoding
+      data = data.b unless data.encoding == Encoding::ASCII_8BIT
+      @buffer_mutex.synchronize do
+        unless @writing
+          @writer.add(self)
+          @writing = true
+        end
+        if (@buffer.length + data.length) > @buffer_size
+          @bytes_dropped += data.length
+          dropped = !@overloaded
+          @overloaded = true
+          @dropping = true
+        else
+          @buffer << data
+          @high_water_mark = @buffer.length if @buffer.length > @high_water_mark
+          @writer.signal if @buffer.length >= (@buffer_size / 2)
+        end
+      end
+      Logger.instance.error "Raw log buffer full for #{@log_name}. Dropping data." if dropped
+    end
+
+    # Stop the writer from flushing this logger
+    def stop_writing
+      writing = false
+      @buffer_mutex.synchronize do
+        writing = @writing
+        @writing = false
+      end
+      @writer.remove(self) if writing
+    end
+
+    # Writing a log file is a critical operation so the entire method is
+    # wrapped with a rescue and handled with handle_critical_exception
+    #
+    # @param data [String] The data to write
+    # @param flush [Boolean] Whether to flush the file so the data reaches the
+    #   disk without waiting for more data
+    def write_data(data, flush = false)
+      need_new_file = false
+      @mutex.synchronize do
+        if !@file or (@cycle_size and (@file.stat.size + data.length) > @cycle_size)
+          need_new_file = true
+        end
+      end
+      start_new_file() if need_new_file
+      @mutex.synchronize do
+        if @file
+          @file.write(data)
+          @file.flush if flush
+        end
+      end
+    rescue => err
+      Logger.instance.error "Error writing #{@filename} : #{err.formatted}"
+      Cosmos.handle_critical_exception(err)
+    end
+
     # Starting a new log file is a critical operation so the entire method is
     # wrapped with a rescue and handled with handle_critical_exception
     def start_new_file
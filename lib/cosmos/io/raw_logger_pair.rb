@@ -56,6 +56,13 @@ module Cosmos
       @write_logger.stop
     end
 
+    # Forget the buffered data and writer threads inherited from the parent
+    # process after a fork
+    def reset_after_fork
+      @read_logger.reset_after_fork
+      @write_logger.reset_after_fork
+    end
+
     # Clone the raw logger pair
     def clone
       raw_logger_pair = super()
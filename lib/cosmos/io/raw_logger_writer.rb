@@ -0,0 +1,101 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'thread'
+
+module Cosmos
+
+  # Writes the buffered data of asynchronous {RawLogger}s from a single
+  # thread. A {RawLogger} shares its writer with its clones so a server which
+  # logs each client to its own file only needs one writer thread.
+  class RawLoggerWriter
+
+    # @param flush_interval [Float] Maximum number of seconds data is
+    #   buffered before it is written
+    def initialize(flush_interval)
+      @flush_interval = flush_interval
+      @mutex = Mutex.new
+      @condition = ConditionVariable.new
+      # Held while the loggers are flushed so a removed logger is never
+      # flushed after {#remove} returns
+      @write_mutex = Mutex.new
+      @loggers = []
+      @thread = nil
+      @pending = false
+    end
+
+    # Write the buffer of the logger from the writer thread. Starts the
+    # thread if it is not running.
+    #
+    # @param raw_logger [RawLogger] The logger to write
+    def add(raw_logger)
+      @mutex.synchronize do
+        @loggers << raw_logger unless @loggers.include?(raw_logger)
+        @thread ||= Cosmos.safe_thread("Raw log writer") { writer_thread_body() }
+      end
+    end
+
+    # Stop writing the buffer of the logger. The writer thread is stopped
+    # once no loggers remain. Data still buffered must be flushed by the
+    # caller.
+    #
+    # @param raw_logger [RawLogger] The logger to stop writing
+    def remove(raw_logger)
+      thread = nil
+      @mutex.synchronize do
+        @loggers.delete(raw_logger)
+        if @loggers.empty?
+          thread = @thread
+          @thread = nil
+        end
+      end
+      if thread
+        Cosmos.kill_thread(self, thread)
+      else
+        @write_mutex.synchronize {}
+      end
+    end
+
+    # Wake the writer thread because a buffer is half full
+    def signal
+      @mutex.synchronize do
+        @pending = true
+        @condition.signal
+      end
+    end
+
+    def graceful_kill
+      @mutex.synchronize { @condition.signal }
+    end
+
+    protected
+
+    def writer_thread_body
+      while true
+        @mutex.synchronize do
+          if !@pending and @thread == Thread.current
+            @condition.wait(@mutex, @flush_interval)
+          end
+          @pending = false
+        end
+        @write_mutex.synchronize do
+          loggers = @mutex.synchronize do
+            # The thread is stopped by remove
+            return if @thread != Thread.current
+            @loggers.dup
+          end
+          loggers.each {|raw_logger| raw_logger.flush }
+        end
+      end
+    end
+
+  end # class RawLoggerWriter
+
+end # module Cosmos
@@ -31,12 +31,18 @@ module Cosmos
     #   complete or nil to block
     # @param read_timeout [Float|nil] Number of seconds to wait for the read to
     #   complete or nil to block
+    # @param read_buffer_size [Integer|nil] Size of the native read buffer
+    #   or nil to read without one. Only used by the {PosixSerialDriver}.
+    # @param inter_byte_timeout [Float|nil] Seconds of silence after which a
+    #   partial read is returned. Only used by the {PosixSerialDriver}.
     def initialize(port_name,
                    baud_rate,
                    parity = :NONE,
                    stop_bits = 1,
                    write_timeout = 10.0,
-                   read_timeout = nil)
+                   read_timeout = nil,
+                   read_buffer_size = nil,
+                   inter_byte_timeout = nil)
       raise(ArgumentError, "Invalid parity: #{parity}") unless VALID_PARITY.include? parity
       if Kernel.is_windows?
         @driver = Win32SerialDriver.new(port_name,
@@ -51,7 +57,9 @@ module Cosmos
                                         parity,
                                         stop_bits,
                                         write_timeout,
-                                        read_timeout)
+                                        read_timeout,
+                                        read_buffer_size,
+                                        inter_byte_timeout)
       end
     end
 
@@ -80,6 +88,15 @@ module Cosmos
       @driver.read_nonblock
     end
 
+    # @return [Hash|nil] Error counters for the serial port or nil if the
+    #   driver does not keep them. The {PosixSerialDriver} reports :frame,
+    #   :overrun, :parity, :break and :buffer_overrun from the operating
+    #   system where available and :bytes_read, :bytes_dropped and
+    #   :high_water_mark for its read buffer.
+    def error_counts
+      @driver.respond_to?(:error_counts) ? @driver.error_counts : nil
+    end
+
   end # class SerialDriver
 
 end # module Cosmos
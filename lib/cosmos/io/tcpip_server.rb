@@ -12,6 +12,8 @@ require 'socket'
 require 'thread' # For Mutex
 require 'timeout' # For Timeout::Error
 require 'cosmos/streams/tcpip_socket_stream'
+require 'cosmos/streams/buffered_tcpip_socket_stream'
+require 'cosmos/io/poller'
 require 'cosmos/config/config_parser'
 
 module Cosmos
@@ -23,7 +25,38 @@ module Cosmos
   # available by calling the TcpipServer read method. For each connection to the
   # write port, a thread is spawned that calls the write method from the stream
   # protocol when data is send to the TcpipServer via the write method.
+  #
+  # When {#event_loop} is set a single thread instead accepts connections,
+  # reads from every client and writes to every client using non-blocking
+  # sockets and a {Poller}. Each client has an output buffer so a slow client
+  # does not delay the others and the number of threads does not grow with
+  # the number of clients. The output buffers can be limited with
+  # {#max_output_bytes} and {#overflow_policy}.
+  #
+  # Each packet written is encoded once and the same data is written to every
+  # client whose stream protocol has a {StreamProtocol#shared_encoding?}.
+  #
+  # When {#local_socket} is set each port is also served on a Unix domain
+  # socket at {TcpipSocketStream.local_socket_path} so clients on the same
+  # machine can skip the TCP/IP stack.
   class TcpipServer
+    # Maximum number of seconds the event loop waits before checking for
+    # packets to write and client timeouts
+    EVENT_LOOP_PERIOD = 0.1
+
+    # Client connection served by the event loop. read_time is when data was
+    # last read and writable is whether the socket is watched for writes.
+    EventClient = Struct.new(:stream_protocol, :hostname, :host_ip, :port, :listen_read, :read_time, :writable,
+                             :packets_written, :packets_dropped)
+
+    # What to do when writing a packet would exceed a client's output buffer
+    # limit. DISCONNECT drops the client and SAMPLE skips the packet for that
+    # client until its output buffer drains below the limit.
+    OVERFLOW_POLICIES = [:DISCONNECT, :SAMPLE]
+
+    # Default maximum number of bytes queued for each client by the event
+    # loop so a client which stops reading can not exhaust memory
+    DEFAULT_MAX_OUTPUT_BYTES = 4 * 1024 * 1024
 
     # Callback method to call when a new client connects to the write port.
     # This method will be called with the StreamProtocol as the only argument.
@@ -40,6 +73,18 @@ module Cosmos
     attr_accessor :raw_logger_pair
     # @return [String] The ip address to bind to.  Default to ANY (0.0.0.0)
     attr_accessor :listen_address
+    # @return [Boolean] Whether to serve every client from a single event loop
+    #   thread. Takes effect on the next connect.
+    attr_accessor :event_loop
+    # @return [Integer|nil] Maximum number of bytes queued for each client by
+    #   the event loop or nil for no limit. Defaults to
+    #   {DEFAULT_MAX_OUTPUT_BYTES}.
+    attr_accessor :max_output_bytes
+    # @return [Symbol] One of {OVERFLOW_POLICIES}
+    attr_reader :overflow_policy
+    # @return [Boolean] Whether to also listen on a Unix domain socket for
+    #   each port. Takes effect on the next connect.
+    attr_accessor :local_socket
 
     # @param write_port [Integer] The server write port. Clients should connect
     #   and expect to receive data from this port.
@@ -74,6 +119,7 @@ module Cosmos
       @stream_protocol_args = stream_protocol_args
 
       @listen_sockets = []
+      @local_socket_paths = []
       @listen_pipes = []
       @listen_threads = []
       @read_threads = []
@@ -96,6 +142,12 @@ module Cosmos
       @interface = nil
       @connection_mutex = Mutex.new
       @listen_address = Socket::INADDR_ANY
+      @event_loop = false
+      @max_output_bytes = DEFAULT_MAX_OUTPUT_BYTES
+      @overflow_policy = :DISCONNECT
+      @local_socket = false
+      @event_thread = nil
+      @poller = nil
 
       @connected = false
     end
@@ -119,7 +171,9 @@ module Cosmos
         rescue
         end
       end
-      if @write_port == @read_port
+      if @event_loop
+        start_event_loop_thread()
+      elsif @write_port == @read_port
         # Handle one socket case
         start_listen_thread(@read_port, true, true)
       else
@@ -132,7 +186,7 @@ module Cosmos
         end
       end
 
-      if @write_port
+      if @write_port and !@event_loop
         # Start write thread
         @write_thread = Thread.new do
           begin
@@ -178,6 +232,17 @@ module Cosmos
       end
       @listen_pipes.clear
 
+      # Shutdown Event Loop Thread
+      if @event_thread
+        @poller.wakeup
+        Cosmos.kill_thread(self, @event_thread)
+        @event_thread = nil
+      end
+      if @poller
+        @poller.close
+        @poller = nil
+      end
+
       # Shutdown Listen Thread(s)
       @listen_threads.each do |listen_thread|
         Cosmos.kill_thread(self, listen_thread)
@@ -193,6 +258,10 @@ module Cosmos
         end
       end
       @listen_sockets.clear
+      @local_socket_paths.each do |path|
+        File.delete(path) if File.socket?(path)
+      end
+      @local_socket_paths.clear
 
       # Shutdown Read Stream Protocols - This should unblock read threads
       @connection_mutex.synchronize do
@@ -249,6 +318,7 @@ module Cosmos
       @write_queue << packet.clone
       @bytes_written += packet.buffer.length
       @write_condition_variable.broadcast
+      @poller.wakeup if @poller
     end
 
     # @param data [String] Data to write to all clients connected to the
@@ -260,6 +330,7 @@ module Cosmos
       @write_queue << packet
       @bytes_written += data.length
       @write_condition_variable.broadcast
+      @poller.wakeup if @poller
     end
 
     # @return [Integer] The number of packets waiting on the read queue
@@ -280,6 +351,35 @@ module Cosmos
       end
     end
 
+    # @param overflow_policy [String|Symbol] One of {OVERFLOW_POLICIES}
+    def overflow_policy=(overflow_policy)
+      overflow_policy = overflow_policy.to_s.upcase.intern
+      raise ArgumentError, "Invalid overflow policy: #{overflow_policy}. Must be one of #{OVERFLOW_POLICIES.join(', ')}." unless OVERFLOW_POLICIES.include?(overflow_policy)
+      @overflow_policy = overflow_policy
+    end
+
+    # @return [Array<Hash>] Output statistics of each client served by the
+    #   event loop with the keys :hostname, :host_ip, :port, :bytes_queued,
+    #   :max_bytes_queued, :lag (seconds since the oldest data still queued
+    #   was written to the server), :packets_written and :packets_dropped
+    #   (packets skipped by the SAMPLE overflow policy). Empty unless
+    #   {#event_loop} is set.
+    def client_stats
+      return [] unless @event_clients
+      now = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      @event_clients.values.map do |client|
+        stream = client.stream_protocol.stream
+        { :hostname => client.hostname,
+          :host_ip => client.host_ip,
+          :port => client.port,
+          :bytes_queued => stream.bytes_queued,
+          :max_bytes_queued => stream.max_bytes_queued,
+          :lag => stream.lag(now),
+          :packets_written => client.packets_written,
+          :packets_dropped => client.packets_dropped }
+      end
+    end
+
     # @return [Integer] The number of connected clients
     def num_clients
       clients = []
@@ -321,6 +421,36 @@ module Cosmos
     protected
 
     def start_listen_thread(port, listen_write = false, listen_read = false)
+      create_listen_sockets(port).each do |listen_socket|
+        # Start Listen Thread
+        @listen_threads << Thread.new do
+          begin
+            thread_reader, thread_writer = IO.pipe
+            @listen_pipes << thread_writer
+            while true
+              listen_thread_body(listen_socket, listen_write, listen_read, thread_reader)
+              break if @cancel_threads
+            end
+          rescue Exception => err
+            Logger.instance.error("Tcpip server listen thread unexpectedly died")
+            Logger.instance.error(err.formatted)
+          end
+        end
+      end
+    end
+
+    # @param port [Integer] Port to listen for connections on
+    # @return [Array<Socket>] The TCP listening socket followed by the Unix
+    #   domain listening socket if {#local_socket} is set
+    def create_listen_sockets(port)
+      listen_sockets = [create_listen_socket(port)]
+      listen_sockets << create_local_listen_socket(port) if @local_socket
+      listen_sockets
+    end
+
+    # @param port [Integer] Port to listen for connections on
+    # @return [Socket] The listening socket
+    def create_listen_socket(port)
       # Create a socket to accept connections from clients
       addr = Socket.pack_sockaddr_in(port, @listen_address)
       listen_socket = Socket.new(Socket::AF_INET, Socket::SOCK_STREAM, 0)
@@ -338,21 +468,37 @@ module Cosmos
       listen_socket.listen(5)
 
       @listen_sockets << listen_socket
+      listen_socket
+    end
 
-      # Start Listen Thread
-      @listen_threads << Thread.new do
-        begin
-          thread_reader, thread_writer = IO.pipe
-          @listen_pipes << thread_writer
-          while true
-            listen_thread_body(listen_socket, listen_write, listen_read, thread_reader)
-            break if @cancel_threads
-          end
-        rescue Exception => err
-          Logger.instance.error("Tcpip server listen thread unexpectedly died")
-          Logger.instance.error(err.formatted)
-        end
+    # Create a Unix domain socket at {TcpipSocketStream.local_socket_path} to
+    # accept connections from clients on the same machine. This must be called
+    # after the TCP port is bound so a path left behind by a server which is no
+    # longer running is the only kind removed.
+    #
+    # @param port [Integer] Port the path is created for
+    # @return [Socket] The listening socket
+    def create_local_listen_socket(port)
+      raise "Local sockets are not supported on Windows" if Kernel.is_windows?
+      TcpipSocketStream.create_local_socket_dir
+      path = TcpipSocketStream.local_socket_path(port)
+      File.delete(path) if File.socket?(path)
+      listen_socket = Socket.new(Socket::AF_UNIX, Socket::SOCK_STREAM, 0)
+      # Create the socket file without group or other access
+      umask = File.umask(0177)
+      begin
+        listen_socket.bind(Socket.pack_sockaddr_un(path))
+      rescue SystemCallError => err
+        Cosmos.close_socket(listen_socket)
+        raise "Error binding to local socket #{path}: #{err.message}"
+      ensure
+        File.umask(umask)
       end
+      listen_socket.listen(5)
+
+      @listen_sockets << listen_socket
+      @local_socket_paths << path
+      listen_socket
     end
 
     def listen_thread_body(listen_socket, listen_write, listen_read, thread_reader)
@@ -367,49 +513,11 @@ module Cosmos
         end
       end
 
-      port, host_ip = Socket.unpack_sockaddr_in(address)
-      hostname = ''
-      hostname = Socket.lookup_hostname_from_ip(host_ip) if System.instance.use_dns
-      if System.instance.acl
-        addr = ["AF_INET", 10, "lc630", host_ip.to_s]
-        if not System.instance.acl.allow_addr?(addr)
-          # Reject connection
-          Cosmos.close_socket(socket)
-          Logger.instance.info "Tcpip server rejected connection from #{hostname}(#{host_ip}):#{port}"
-          return
-        end
-      end
-
-      # Configure TCP_NODELAY option
-      socket.setsockopt(Socket::IPPROTO_TCP, Socket::TCP_NODELAY, 1)
-
-      # Accept Connection
-      write_socket = nil
-      read_socket = nil
-      write_socket = socket if listen_write
-      read_socket = socket if listen_read
-      stream = TcpipSocketStream.new(write_socket, read_socket, @write_timeout, @read_timeout)
-      if @raw_logger_pair
-        stream.raw_logger_pair = @raw_logger_pair.clone
-        stream.raw_logger_pair.start if @raw_logging_enabled
-      end
+      client = setup_connection(socket, address, listen_write, listen_read, TcpipSocketStream)
+      return unless client
+      stream_protocol, hostname, host_ip, port = client
 
-      stream_protocol = @stream_protocol_class.new(*@stream_protocol_args)
-      stream_protocol.interface = @interface if @interface
-      stream_protocol.connect(stream)
-
-      if listen_write
-        @write_connection_callback.call(stream_protocol) if @write_connection_callback
-        @connection_mutex.synchronize do
-          @write_stream_protocols << [stream_protocol, hostname, host_ip, port]
-        end
-      end
       if listen_read
-        @read_connection_callback.call(stream_protocol) if @read_connection_callback
-        @connection_mutex.synchronize do
-          @read_stream_protocols << [stream_protocol, hostname, host_ip, port]
-        end
-
         # Start read thread
         @read_threads << Thread.new do
           index_to_delete = nil
@@ -448,8 +556,285 @@ module Cosmos
           end
         end
       end
+    end
+
+    # Accept a client connection and add its stream protocol to the write
+    # and read stream protocols
+    #
+    # @param socket [Socket] The accepted socket
+    # @param address [String] The packed client address
+    # @param listen_write [Boolean] Whether packets are written to the client
+    # @param listen_read [Boolean] Whether packets are read from the client
+    # @param stream_class [Class] The {TcpipSocketStream} class for the client
+    # @return [Array|nil] The stream protocol, hostname, host ip and port of
+    #   the client or nil if the connection was rejected
+    def setup_connection(socket, address, listen_write, listen_read, stream_class)
+      if address.respond_to?(:unix?) and address.unix?
+        # Local clients are only limited by the file permissions of the socket
+        hostname = 'localhost'
+        host_ip = 'local'
+        port = socket.fileno
+      else
+        port, host_ip = Socket.unpack_sockaddr_in(address)
+        hostname = ''
+        hostname = Socket.lookup_hostname_from_ip(host_ip) if System.instance.use_dns
+        if System.instance.acl
+          addr = ["AF_INET", 10, "lc630", host_ip.to_s]
+          if not System.instance.acl.allow_addr?(addr)
+            # Reject connection
+            Cosmos.close_socket(socket)
+            Logger.instance.info "Tcpip server rejected connection from #{hostname}(#{host_ip}):#{port}"
+            return nil
+          end
+        end
+
+        # Configure TCP_NODELAY option
+        socket.setsockopt(Socket::IPPROTO_TCP, Socket::TCP_NODELAY, 1)
+      end
+
+      # Accept Connection
+      write_socket = nil
+      read_socket = nil
+      write_socket = socket if listen_write
+      read_socket = socket if listen_read
+      stream = stream_class.new(write_socket, read_socket, @write_timeout, @read_timeout)
+      if @raw_logger_pair
+        # Each client logs to its own files. Asynchronous clones share the
+        # writer threads of the server's loggers.
+        stream.raw_logger_pair = @raw_logger_pair.clone
+        stream.raw_logger_pair.start if @raw_logging_enabled
+      end
+
+      stream_protocol = @stream_protocol_class.new(*@stream_protocol_args)
+      stream_protocol.interface = @interface if @interface
+      stream_protocol.connect(stream)
+
+      if listen_write
+        @write_connection_callback.call(stream_protocol) if @write_connection_callback
+        @connection_mutex.synchronize do
+          @write_stream_protocols << [stream_protocol, hostname, host_ip, port]
+        end
+      end
+      if listen_read
+        @read_connection_callback.call(stream_protocol) if @read_connection_callback
+        @connection_mutex.synchronize do
+          @read_stream_protocols << [stream_protocol, hostname, host_ip, port]
+        end
+      end
 
       Logger.instance.info "Tcpip server accepted connection from #{hostname}(#{host_ip}):#{port}"
+      [stream_protocol, hostname, host_ip, port]
+    end
+
+    def start_event_loop_thread
+      @poller = Poller.new
+      @listeners = {}
+      @event_clients = {}
+      if @write_port == @read_port
+        create_listen_sockets(@read_port).each {|listen_socket| @listeners[listen_socket] = [true, true] }
+      else
+        create_listen_sockets(@write_port).each {|listen_socket| @listeners[listen_socket] = [true, false] } if @write_port
+        create_listen_sockets(@read_port).each {|listen_socket| @listeners[listen_socket] = [false, true] } if @read_port
+      end
+      @listeners.each_key {|listen_socket| @poller.register(listen_socket, Poller::READABLE) }
+
+      @event_thread = Thread.new do
+        begin
+          while true
+            event_loop_body()
+            break if @cancel_threads
+          end
+        rescue Exception => err
+          Logger.instance.error("Tcpip server event loop thread unexpectedly died")
+          Logger.instance.error(err.formatted)
+        ensure
+          @event_clients.values.each {|client| drop_client(client, false) }
+        end
+      end
+    end
+
+    # Processes every ready socket and then writes any packets waiting on the
+    # write queue
+    def event_loop_body
+      @poller.wait(EVENT_LOOP_PERIOD).each do |io, events|
+        break if @cancel_threads
+        listener = @listeners[io]
+        if listener
+          accept_clients(io, *listener)
+        else
+          client = @event_clients[io]
+          next unless client
+          read_client(client) if (events & Poller::READABLE) != 0
+          flush_client(client) if (events & Poller::WRITABLE) != 0 and @event_clients[io]
+        end
+      end
+      return if @cancel_threads
+
+      if @write_queue
+        while true
+          begin
+            packet = @write_queue.pop(true)
+          rescue ThreadError
+            break
+          end
+          packet = write_thread_hook(packet)
+          write_clients(packet) if packet
+        end
+      end
+      check_client_timeouts()
+    end
+
+    def accept_clients(listen_socket, listen_write, listen_read)
+      while true
+        begin
+          socket, address = listen_socket.accept_nonblock
+        rescue Errno::EAGAIN, Errno::ECONNABORTED, Errno::EINTR, Errno::EWOULDBLOCK
+          return
+        end
+        connection = setup_connection(socket, address, listen_write, listen_read, BufferedTcpipSocketStream)
+        next unless connection
+        client = EventClient.new(*connection, listen_read, Process.clock_gettime(Process::CLOCK_MONOTONIC), false, 0, 0)
+        @event_clients[socket] = client
+        # Clients on a write only port are still watched for reads to detect
+        # when they disconnect
+        @poller.register(socket, Poller::READABLE)
+        # The connection callbacks may have written to the client
+        flush_client(client)
+      end
+    end
+
+    def read_client(client)
+      stream_protocol = client.stream_protocol
+      stream = stream_protocol.stream
+      # Write only clients are read to detect when they disconnect
+      data = (stream.read_socket || stream.write_socket).read_nonblock(65535, exception: false)
+      return if data == :wait_readable
+      unless data and client.listen_read
+        # Client has disconnected (or is invalidly sending data on the socket)
+        drop_client(client)
+        return
+      end
+      stream.raw_logger_pair.read_logger.write(data) if stream.raw_logger_pair
+      client.read_time = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      stream_protocol.receive(data).each do |packet|
+        read_thread_hook(packet)
+      end
+    rescue Errno::ECONNRESET, Errno::ECONNABORTED, IOError, Errno::ENOTSOCK
+      drop_client(client)
+    rescue Exception => err
+      Logger.instance.error "Tcpip server error reading from client: #{err.class} #{err.message}"
+      drop_client(client)
+    end
+
+    def write_clients(packet)
+      # Queue the packet for each client and then write as much as each
+      # client accepts
+      encodings = {}
+      @event_clients.values.each do |client|
+        stream_protocol = client.stream_protocol
+        stream = stream_protocol.stream
+        next unless stream.write_socket
+        begin
+          data, length = encode_packet(stream_protocol, packet, encodings)
+          next unless data
+          if @max_output_bytes and (stream.bytes_queued + length) > @max_output_bytes
+            if @overflow_policy == :SAMPLE
+              client.packets_dropped += 1
+              next
+            end
+            Logger.instance.error "Tcpip server output buffer full with #{stream.bytes_queued} bytes for #{client.hostname}(#{client.host_ip}):#{client.port}"
+            drop_client(client)
+            next
+          end
+          stream_protocol.write_encoded(packet, data)
+          client.packets_written += 1
+        rescue Exception => err
+          Logger.instance.error "Error sending to client: #{err.class} #{err.message}"
+          drop_client(client)
+          next
+        end
+        flush_client(client)
+      end
+    end
+
+    # Encode a packet once for all the stream protocols which share an
+    # encoding. The encoded strings are frozen as they are queued for many
+    # clients.
+    #
+    # @param stream_protocol [StreamProtocol] Protocol the packet is written to
+    # @param packet [Packet] The packet to encode
+    # @param encodings [Hash] The encodings of the packet so far
+    # @return [Array(String|Array<String>, Integer)|nil] The encoded data and
+    #   its length or nil if the write was aborted
+    def encode_packet(stream_protocol, packet, encodings)
+      key = stream_protocol.shared_encoding? ? stream_protocol.class : stream_protocol
+      return encodings[key] if encodings.key?(key)
+      data = stream_protocol.encode(packet)
+      if data
+        if Array === data
+          data = data.map {|segment| segment.frozen? ? segment : segment.dup.freeze }
+          length = data.inject(0) {|sum, segment| sum + segment.length }
+        else
+          data = data.dup.freeze unless data.frozen?
+          length = data.length
+        end
+        encodings[key] = [data, length]
+      else
+        encodings[key] = nil
+      end
+    end
+
+    def flush_client(client)
+      stream = client.stream_protocol.stream
+      return unless stream.write_socket
+      # Only watch for writes while there is queued data
+      writable = !stream.flush
+      if writable != client.writable
+        @poller.register(stream.write_socket, writable ? (Poller::READABLE | Poller::WRITABLE) : Poller::READABLE)
+        client.writable = writable
+      end
+    rescue Errno::EPIPE, Errno::ECONNABORTED, IOError, Errno::ECONNRESET
+      # Client has normally disconnected
+      drop_client(client)
+    rescue Exception => err
+      Logger.instance.error "Error sending to client: #{err.class} #{err.message}"
+      drop_client(client)
+    end
+
+    # Drop clients whose writes have stalled longer than the write timeout or
+    # which have not sent data within the read timeout
+    def check_client_timeouts
+      return unless @write_timeout or @read_timeout
+      now = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      @event_clients.values.each do |client|
+        stream = client.stream_protocol.stream
+        if @write_timeout and stream.write_socket and stream.stalled_for(now) > @write_timeout
+          Logger.instance.error "Tcpip server write timeout to #{client.hostname}(#{client.host_ip}):#{client.port}"
+          drop_client(client)
+        elsif @read_timeout and client.listen_read and (now - client.read_time) > @read_timeout
+          Logger.instance.error "Timeout waiting for data to be read"
+          drop_client(client)
+        end
+      end
+    end
+
+    # @param client [EventClient] The client to disconnect
+    # @param lost [Boolean] Whether the connection was lost rather than closed
+    #   by the server disconnecting
+    def drop_client(client, lost = true)
+      stream_protocol = client.stream_protocol
+      socket = stream_protocol.stream.write_socket || stream_protocol.stream.read_socket
+      @event_clients.delete(socket)
+      @poller.deregister(socket)
+      if lost
+        Logger.instance.info "Tcpip server lost #{client.listen_read ? 'read' : 'write'} connection to #{client.hostname}(#{client.host_ip}):#{client.port}"
+      end
+      stream_protocol.disconnect
+      stream_protocol.stream.raw_logger_pair.stop if stream_protocol.stream.raw_logger_pair
+      @connection_mutex.synchronize do
+        @write_stream_protocols.delete_if {|write_stream_protocol, _, _, _| write_stream_protocol == stream_protocol }
+        @read_stream_protocols.delete_if {|read_stream_protocol, _, _, _| read_stream_protocol == stream_protocol }
+      end
     end
 
     def write_thread_body
@@ -516,10 +901,12 @@ module Cosmos
           # Send data to each client - On error drop the client
           indexes_to_delete = []
           index = 0
+          encodings = {}
           @write_stream_protocols.each do |stream_protocol, hostname, host_ip, port|
             need_disconnect = false
             begin
-              stream_protocol.write(packet)
+              data, _ = encode_packet(stream_protocol, packet, encodings)
+              stream_protocol.write_encoded(packet, data) if data
             rescue Errno::EPIPE, Errno::ECONNABORTED, IOError, Errno::ECONNRESET
               # Client has normally disconnected
               need_disconnect = true
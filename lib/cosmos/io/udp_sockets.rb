@@ -11,6 +11,7 @@
 require 'socket'
 require 'ipaddr'
 require 'timeout' # for Timeout::Error
+require 'cosmos/ext/datagram'
 
 # Define needed constants for Windows
 Socket::IP_MULTICAST_IF = 9 unless Socket.const_defined?('IP_MULTICAST_IF')
@@ -78,6 +79,48 @@ module Cosmos
       end
     end
 
+    # Send several datagrams with one sendmmsg call for up to 64 datagrams
+    # where supported. Otherwise each datagram is sent by {#write}. A datagram
+    # which the socket fails to send is skipped so the rest of the batch is
+    # still sent.
+    #
+    # @param datagrams [Array<String>] Binary datagrams to send in order
+    # @param write_timeout [Float] Time in seconds to wait for each part of
+    #   the batch to send
+    # @return [Hash{Integer=>SystemCallError}] The errors of the datagrams
+    #   which were not sent keyed by their index
+    def write_batch(datagrams, write_timeout = 10.0)
+      errors = {}
+      if defined? Datagram
+        offset = 0
+        while offset < datagrams.length
+          begin
+            num_sent = Datagram.send_batch(@socket, datagrams, offset)
+          rescue SystemCallError => err
+            # sendmmsg only fails if the first datagram could not be sent
+            errors[offset] = err
+            offset += 1
+            next
+          end
+          if num_sent > 0
+            offset += num_sent
+          else
+            result = IO.fast_select(nil, [@socket], nil, write_timeout)
+            raise Timeout::Error, "Write Timeout" unless result
+          end
+        end
+      else
+        datagrams.each_with_index do |data, index|
+          begin
+            write(data, write_timeout)
+          rescue SystemCallError => err
+            errors[index] = err
+          end
+        end
+      end
+      errors
+    end
+
     # Defer all methods to the UDPSocket
     def method_missing(method, *args, &block)
       @socket.__send__(method, *args, &block)
@@ -107,15 +150,24 @@ module Cosmos
 
   # Creates a UDPSocket and implements a non-blocking read.
   class UdpReadSocket
+    # Maximum number of datagrams returned by {#read_batch}
+    BATCH_SIZE = 64
 
     # @param recv_port [Integer] Port to receive data on
     # @param multicast_address [String] Address to add multicast
-    def initialize(recv_port = 0, multicast_address = nil, interface_address = nil, bind_address = "0.0.0.0")
+    # @param receive_buffer_size [Integer] Size of the socket receive buffer
+    #   in bytes or nil to use the system default. The kernel limits this to
+    #   net.core.rmem_max on Linux.
+    def initialize(recv_port = 0, multicast_address = nil, interface_address = nil, bind_address = "0.0.0.0", receive_buffer_size = nil)
       @socket = UDPSocket.new
+      @receiver = nil
 
       # Basic setup to reuse address
       @socket.setsockopt(Socket::SOL_SOCKET, Socket::SO_REUSEADDR, 1)
 
+      # Set the receive buffer before binding so no datagrams are dropped
+      @socket.setsockopt(Socket::SOL_SOCKET, Socket::SO_RCVBUF, receive_buffer_size.to_i) if receive_buffer_size
+
       # bind to port
       @socket.bind(bind_address, recv_port)
 
@@ -143,6 +195,37 @@ module Cosmos
       data
     end
 
+    # Read every datagram waiting on the socket, up to max_datagrams, with one
+    # recvmmsg call into preallocated buffers where supported. Otherwise a
+    # single datagram is read by {#read}.
+    #
+    # @param max_datagrams [Integer] Maximum number of datagrams to return.
+    #   Limited to {BATCH_SIZE}.
+    # @param read_timeout [Float] Time in seconds to wait for the first
+    #   datagram
+    # @return [Array(Array<String>, Array<Time|nil>)] The datagrams and the
+    #   time the kernel received each one. The times are nil if the kernel
+    #   does not report them.
+    def read_batch(max_datagrams = BATCH_SIZE, read_timeout = nil)
+      return [[read(read_timeout)], [nil]] unless defined? Datagram
+
+      @receiver ||= Datagram::Receiver.new(@socket, BATCH_SIZE)
+      datagrams = []
+      times = []
+      while @receiver.receive(datagrams, times, max_datagrams) == 0
+        result = IO.fast_select([@socket], nil, nil, read_timeout)
+        raise Timeout::Error, "Read Timeout" unless result
+      end
+      [datagrams, times]
+    end
+
+    # @return [Integer] The number of datagrams the kernel dropped because the
+    #   receive buffer was full. Only reported once {#read_batch} has been
+    #   called on platforms with recvmmsg, otherwise always 0.
+    def dropped
+      @receiver ? @receiver.dropped : 0
+    end
+
     # Defer all methods to the UDPSocket
     def method_missing(method, *args, &block)
       @socket.__send__(method, *args, &block)
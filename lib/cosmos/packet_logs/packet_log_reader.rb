@@ -11,6 +11,7 @@
 require 'cosmos/core_ext/io'
 require 'cosmos/packets/packet'
 require 'cosmos/io/buffered_file'
+require 'cosmos/streams/preidentified_codec'
 
 module Cosmos
 
@@ -133,12 +134,12 @@ module Cosmos
     # @return [Packet]
     def read(identify_and_define = true)
       # Read the Packet Header
-      success, target_name, packet_name, received_time = read_entry_header()
-      return nil unless success
+      success, target_name, packet_name, received_time, data_length = read_entry_header()
+      return nil unless success and data_length > 0
 
       # Read Packet Data
-      packet_data = @file.read_length_bytes(4)
-      return nil unless packet_data and packet_data.length > 0
+      packet_data = @file.read(data_length)
+      return nil unless packet_data and packet_data.length == data_length
 
       if identify_and_define
         packet = identify_and_define_packet_data(target_name, packet_name, received_time, packet_data)
@@ -290,25 +291,19 @@ module Cosmos
       end
     end
 
+    # Read the entry header and leave the file at the start of the packet
+    # data
     def read_entry_header
-      # Read Received Time
-      time_seconds = @file.read(4)
-      return [nil, nil, nil, nil] if time_seconds.nil? or time_seconds.length != 4
-      time_seconds = time_seconds.unpack('N')[0]
-      time_microseconds = @file.read(4)
-      return [nil, nil, nil, nil] if time_microseconds.nil? or time_microseconds.length != 4
-      time_microseconds = time_microseconds.unpack('N')[0]
+      header = @file.read(PreidentifiedCodec::MAX_HEADER_LENGTH)
+      return [nil, nil, nil, nil, nil] unless header
+      header_length, time_seconds, time_microseconds, target_name, packet_name, data_length = PreidentifiedCodec.decode_header(header)
+      return [nil, nil, nil, nil, nil] unless header_length
+      return [nil, nil, nil, nil, nil] unless target_name.length > 0 and packet_name.length > 0
+      # Seek back over the bytes read past the header
+      @file.seek(header_length - header.length, IO::SEEK_CUR)
       received_time = Time.at(time_seconds, time_microseconds)
 
-      # Read Target Name
-      target_name = @file.read_length_bytes(1)
-      return [nil, nil, nil, nil] unless target_name and target_name.length > 0
-
-      # Read Packet Name
-      packet_name = @file.read_length_bytes(1)
-      return [nil, nil, nil, nil] unless packet_name and packet_name.length > 0
-
-      return [true, target_name, packet_name, received_time]
+      return [true, target_name, packet_name, received_time, data_length]
     end
 
     def test
@@ -320,11 +315,10 @@ module Cosmos
       begin
         # Try to read the packet header
         # This will fail with file read errors and invalid timestamps
-        success, target_name, packet_name, _ = read_entry_header()
+        success, target_name, packet_name, _, data_length = read_entry_header()
         if success
           if target_name !~ File::NON_ASCII_PRINTABLE and packet_name !~ File::NON_ASCII_PRINTABLE
-            packet_data_length = @file.read(4)
-            if packet_data_length.length == 4 and packet_data_length.unpack('N')[0] > 0
+            if data_length > 0
               if @log_type == :TLM
                 if System.telemetry.packet(target_name, packet_name)
                   found = true
@@ -11,6 +11,7 @@
 require 'thread'
 require 'socket' # For gethostname
 require 'cosmos/config/config_parser'
+require 'cosmos/streams/preidentified_codec'
 
 module Cosmos
 
@@ -301,21 +302,19 @@ module Cosmos
     def build_entry_header(packet)
       received_time = packet.received_time
       received_time = Time.now unless received_time
-      # This is an optimization to avoid creating a new entry_header object
-      # each time we create an entry_header which we do a LOT!
-      @entry_header.clear
-      @entry_header << [received_time.tv_sec].pack('N'.freeze)
-      @entry_header << [received_time.tv_usec].pack('N'.freeze)
       target_name = packet.target_name
       target_name = 'UNKNOWN'.freeze unless target_name
-      @entry_header << target_name.length
-      @entry_header << target_name
       packet_name = packet.packet_name
       packet_name = 'UNKNOWN'.freeze unless packet_name
-      @entry_header << packet_name.length
-      @entry_header << packet_name
-      @entry_header << [packet.length].pack('N'.freeze)
-      return @entry_header
+      # This is an optimization to avoid creating a new entry_header object
+      # each time we create an entry_header which we do a LOT!
+      @entry_header.clear
+      PreidentifiedCodec.encode_header(@entry_header,
+                                       received_time.tv_sec,
+                                       received_time.tv_usec,
+                                       target_name,
+                                       packet_name,
+                                       packet.length)
     end
 
   end # class PacketLogWriter
@@ -0,0 +1,158 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'cosmos/ext/shared_memory'
+require 'cosmos/utilities/crc'
+
+module Cosmos
+
+  # Current value table stored in a memory mapped file so it can be shared
+  # between the Command and Telemetry Server and tools running on the same
+  # host. The file starts with a header followed by one slot per telemetry
+  # packet. Slots are laid out in target and packet name order using the
+  # defined length of each packet so the server and tools compute the same
+  # layout from the same telemetry definitions. Each slot holds the latest
+  # buffer, received time and received count of the packet and is protected
+  # by a sequence lock so readers never block the writer.
+  class SharedCvt
+    # Identifies a shared current value table file
+    MAGIC = 'COSMOSCV'
+    # Version of the file layout
+    LAYOUT_VERSION = 1
+    # Number of bytes in the file header
+    HEADER_SIZE = 64
+
+    # @return [String] The memory mapped file
+    attr_reader :filename
+
+    # @param filename [String] The memory mapped file
+    # @param telemetry [Telemetry] The telemetry definitions used to lay out
+    #   the file. Packets read from the file are updated in these definitions.
+    # @param writer [Boolean] Whether this is the single process which
+    #   publishes packets to the file. Readers raise an error if the file does
+    #   not exist or was laid out from different telemetry definitions.
+    def initialize(filename, telemetry, writer = false)
+      @filename = filename
+      @telemetry = telemetry
+      @writer = writer
+      @oversize_packets = {}
+      build_layout()
+
+      raise "Shared CVT #{@filename} does not exist" if !writer and !File.exist?(@filename)
+      @memory = SharedMemory.new(@filename, @size)
+      begin
+        if writer
+          # Clear the slots left by a previous writer so readers do not
+          # present its packets as current
+          @memory.write(HEADER_SIZE, "\x00" * (@size - HEADER_SIZE))
+          @memory.write(0, header())
+        elsif @memory.read(0, HEADER_SIZE) != header()
+          raise "Shared CVT #{@filename} does not match the telemetry definitions"
+        end
+      rescue
+        @memory.close
+        raise
+      end
+    end
+
+    # Publish the latest buffer, received time and received count of a
+    # packet. Packets larger than their defined length are not published.
+    #
+    # @param packet [Packet] The identified telemetry packet
+    def write(packet)
+      slot = slot(packet.target_name, packet.packet_name)
+      return unless slot
+      received_time = packet.received_time
+      received_time ||= Time.now
+      unless @memory.write_packet(slot[0], slot[1], packet.buffer(false), packet.received_count,
+                                  received_time.tv_sec, received_time.tv_usec)
+        unless @oversize_packets[slot]
+          Logger.warn "#{packet.target_name} #{packet.packet_name} is larger than its defined length and will not be published to the shared CVT"
+          @oversize_packets[slot] = true
+        end
+      end
+    end
+
+    # Update a packet in the telemetry definitions from the file if it has
+    # been written since it was last read. Limits are checked on updated
+    # packets.
+    #
+    # @param target_name [String] The target name
+    # @param packet_name [String] The packet name
+    # @return [Boolean] Whether the packet was updated
+    def read(target_name, packet_name)
+      slot = slot(target_name, packet_name)
+      return false unless slot
+      result = @memory.read_packet(slot[0], slot[1], slot[2])
+      return false unless result
+
+      sequence, buffer, received_count, time_sec, time_usec = result
+      slot[2] = sequence
+      packet = slot[3]
+      packet.buffer = buffer
+      packet.received_time = Time.at(time_sec, time_usec)
+      packet.received_count = received_count
+      packet.check_limits(System.limits_set)
+      return true
+    end
+
+    # Update all the packets of a target from the file
+    #
+    # @param target_name [String] The target name
+    def read_target(target_name)
+      target_slots = @slots[target_name.to_s.upcase]
+      return unless target_slots
+      target_slots.each {|packet_name, _| read(target_name, packet_name) }
+    end
+
+    # Unmap the file
+    def close
+      @memory.close
+    end
+
+    protected
+
+    def slot(target_name, packet_name)
+      target_slots = @slots[target_name.to_s.upcase]
+      return nil unless target_slots
+      return target_slots[packet_name.to_s.upcase]
+    end
+
+    def build_layout
+      # Each slot is [offset, capacity, last sequence read, packet]
+      @slots = {}
+      layout = ''
+      offset = HEADER_SIZE
+      @telemetry.config.telemetry.keys.sort.each do |target_name|
+        target_slots = {}
+        packets = @telemetry.packets(target_name)
+        packets.keys.sort.each do |packet_name|
+          packet = packets[packet_name]
+          # Keep every slot 8 byte aligned
+          capacity = (packet.defined_length + 7) & ~7
+          target_slots[packet_name] = [offset, capacity, 0, packet]
+          layout << "#{target_name} #{packet_name} #{capacity}\n"
+          offset += SharedMemory::PACKET_HEADER_SIZE + capacity
+        end
+        @slots[target_name] = target_slots
+      end
+      @size = offset
+      @layout_crc = Crc32.new.calc(layout)
+    end
+
+    def header
+      header = [MAGIC, LAYOUT_VERSION, @slots.length, @layout_crc, @size].pack('a8NNNN')
+      header << ("\x00" * (HEADER_SIZE - header.length))
+      return header
+    end
+
+  end # class SharedCvt
+
+end # module Cosmos
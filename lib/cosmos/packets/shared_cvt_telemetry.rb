@@ -0,0 +1,86 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'cosmos/packets/telemetry'
+require 'cosmos/packets/shared_cvt'
+
+module Cosmos
+
+  # Telemetry which reads the current value of packets from the shared
+  # current value table published by a Command and Telemetry Server running
+  # on the same host. Packets are updated from the table each time they are
+  # accessed so values are read directly from memory rather than through the
+  # JSON API.
+  class SharedCvtTelemetry < Telemetry
+    # @return [SharedCvt] The shared current value table
+    attr_reader :shared_cvt
+
+    # @param config [PacketConfig] Packet configuration to use to access the
+    #   telemetry. Must be the same configuration used by the server.
+    # @param filename [String] The shared current value table file
+    def initialize(config, filename)
+      super(config)
+      @shared_cvt = SharedCvt.new(filename, self)
+    end
+
+    # (see Telemetry#packets)
+    def packets(target_name)
+      @shared_cvt.read_target(target_name) if @shared_cvt
+      super(target_name)
+    end
+
+    # (see Telemetry#packet)
+    def packet(target_name, packet_name)
+      refresh(target_name, packet_name)
+      super(target_name, packet_name)
+    end
+
+    # (see Telemetry#packet_and_item)
+    def packet_and_item(target_name, packet_name, item_name)
+      refresh(target_name, packet_name)
+      super(target_name, packet_name, item_name)
+    end
+
+    # (see Telemetry#value)
+    def value(target_name, packet_name, item_name, value_type = :CONVERTED)
+      refresh(target_name, packet_name)
+      super(target_name, packet_name, item_name, value_type)
+    end
+
+    # (see Telemetry#values_and_limits_states)
+    def values_and_limits_states(item_array, value_types = :CONVERTED)
+      item_array.each {|target_name, packet_name, _| refresh(target_name, packet_name) }
+      super(item_array, value_types)
+    end
+
+    # (see Telemetry#latest_packets)
+    def latest_packets(target_name, item_name)
+      @shared_cvt.read_target(target_name)
+      super(target_name, item_name)
+    end
+
+    # Unmap the shared current value table
+    def close
+      @shared_cvt.close
+    end
+
+    protected
+
+    def refresh(target_name, packet_name)
+      if packet_name.to_s.upcase == LATEST_PACKET_NAME
+        @shared_cvt.read_target(target_name)
+      else
+        @shared_cvt.read(target_name, packet_name)
+      end
+    end
+
+  end # class SharedCvtTelemetry
+
+end # module Cosmos
@@ -10,6 +10,7 @@
 
 require 'cosmos/packets/packet_config'
 require 'cosmos/ext/telemetry'
+require 'cosmos/utilities/timer_wheel'
 
 module Cosmos
 
@@ -32,6 +33,12 @@ module Cosmos
     #   telemetry
     def initialize(config)
       @config = config
+      # Staleness deadline of each received packet
+      @stale_wheel = TimerWheel.new
+      # Stale packets hashed by target name and then packet. Built the first
+      # time stale packets are requested.
+      @stale_packets = nil
+      @stale_mutex = Mutex.new
     end
 
     # (see PacketConfig#warnings)
@@ -196,6 +203,7 @@ module Cosmos
         end
         break if identified_packet
       end
+      schedule_stale(identified_packet) if identified_packet
       return identified_packet
     end
 
@@ -213,6 +221,7 @@ module Cosmos
     def update!(target_name, packet_name, packet_data)
       identified_packet = packet(target_name, packet_name)
       identified_packet.buffer = packet_data
+      schedule_stale(identified_packet)
       return identified_packet
     end
 
@@ -242,19 +251,27 @@ module Cosmos
     #   the red, yellow, and green (if given) limits values.
     # def values_and_limits_states(item_array, value_types = :CONVERTED)
 
-    # Iterates through all the telemetry packets and marks them stale if they
-    # haven't been received for over the System.staleness_seconds value.
+    # Marks packets stale if they haven't been received for over the
+    # System.staleness_seconds value. Only packets updated through {#update!}
+    # or {#identify!} whose staleness deadline has passed are checked. The
+    # deadline is armed when the packet is updated so a packet with an older
+    # received time goes stale at the deadline rather than immediately.
     #
-    # @return [Array(Packet)] Array of the stale packets
+    # @return [Array(Packet)] Array of the packets which became stale
     def check_stale
       stale = []
       time = Time.now
-      @config.telemetry.each do |target_name, target_packets|
-        target_packets.each do |packet_name, packet|
-          if packet.received_time and (!packet.stale) and (time - packet.received_time > System.staleness_seconds)
-            packet.set_stale
-            stale << packet
-          end
+      staleness_seconds = System.staleness_seconds
+      @stale_wheel.advance(time.to_f).each do |packet|
+        received_time = packet.received_time
+        next if !received_time or packet.stale
+        if time - received_time > staleness_seconds
+          packet.set_stale
+          stale << packet
+          add_stale(packet)
+        else
+          # Received time was set after the packet was last updated
+          schedule_stale(packet, received_time.to_f + staleness_seconds)
         end
       end
       stale
@@ -270,13 +287,19 @@ module Cosmos
         raise "Telemetry target '#{target.upcase}' does not exist"
       end
       stale = []
-      @config.telemetry.each do |target_name, target_packets|
-        next if (target && target != target_name)
-        next if target_name == 'UNKNOWN'
-        target_packets.each do |packet_name, packet|
-          if packet.stale
-            next if (with_limits_only && packet.limits_items.empty?)
-            stale << packet
+      @stale_mutex.synchronize do
+        build_stale() unless @stale_packets
+        @stale_packets.each do |target_name, target_packets|
+          next if (target && target != target_name)
+          next if target_name == 'UNKNOWN'
+          # Packets are no longer stale once their limits are checked
+          target_packets.delete_if do |packet, _|
+            if packet.stale
+              stale << packet unless (with_limits_only && packet.limits_items.empty?)
+              false
+            else
+              true
+            end
           end
         end
       end
@@ -299,6 +322,8 @@ module Cosmos
           packet.reset
         end
       end
+      @stale_wheel.clear
+      @stale_mutex.synchronize { @stale_packets = nil }
     end
 
     # Returns the first non-hidden packet
@@ -345,6 +370,35 @@ module Cosmos
       @config.telemetry
     end
 
+    protected
+
+    # Arm the staleness deadline of a packet
+    def schedule_stale(packet, deadline = Time.now.to_f + System.staleness_seconds)
+      @stale_wheel.schedule(packet, deadline)
+    end
+
+    def add_stale(packet)
+      @stale_mutex.synchronize do
+        if @stale_packets
+          target_packets = (@stale_packets[packet.target_name] ||= {})
+          target_packets[packet] = true
+        end
+      end
+    end
+
+    # Scan every packet once to find the packets which are stale because
+    # they have never been received. Must be called with the stale mutex held.
+    def build_stale
+      @stale_packets = {}
+      @config.telemetry.each do |target_name, target_packets|
+        stale_target_packets = {}
+        target_packets.each do |packet_name, packet|
+          stale_target_packets[packet] = true if packet.stale
+        end
+        @stale_packets[target_name] = stale_target_packets
+      end
+    end
+
   end # class Telemetry
 
 end # module Cosmos
@@ -29,6 +29,18 @@ module Cosmos
       return $cmd_tlm_server.interface_state(interface_name)
     end
 
+    def get_interface_latency(interface_name)
+      return $cmd_tlm_server.get_interface_latency(interface_name)
+    end
+
+    def set_latency_instrumentation(enabled)
+      return $cmd_tlm_server.set_latency_instrumentation(enabled)
+    end
+
+    def get_latency_instrumentation
+      return $cmd_tlm_server.get_latency_instrumentation
+    end
+
     def map_target_to_interface(target_name, interface_name)
       return $cmd_tlm_server.map_target_to_interface(target_name, interface_name)
     end
@@ -49,6 +61,14 @@ module Cosmos
       return $cmd_tlm_server.router_state(router_name)
     end
 
+    def get_router_info(router_name)
+      return $cmd_tlm_server.get_router_info(router_name)
+    end
+
+    def get_shared_cvt_filename
+      return $cmd_tlm_server.get_shared_cvt_filename
+    end
+
     def get_cmd_log_filename(packet_log_writer_name = 'DEFAULT')
       return $cmd_tlm_server.get_cmd_log_filename(packet_log_writer_name)
     end
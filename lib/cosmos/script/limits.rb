@@ -93,6 +93,22 @@ module Cosmos
 
     def get_limits_event(id, non_block = false)
       result = $cmd_tlm_server.get_limits_event(id, non_block)
+      _convert_limits_event(result)
+    end
+
+    # Get up to max_events limits events in one call. Blocks for up to
+    # timeout seconds (forever if nil) waiting for the first event.
+    # Usage:
+    #   events = get_limits_event_batch(id, <max_events>, <timeout>)
+    def get_limits_event_batch(id, max_events = CmdTlmServer::DEFAULT_BATCH_SIZE, timeout = nil)
+      results = $cmd_tlm_server.get_limits_event_batch(id, max_events, timeout)
+      results.each {|result| _convert_limits_event(result) } if results
+      results
+    end
+
+    private
+
+    def _convert_limits_event(result)
       if result
         result[0] = result[0].to_s.intern
         if result[0] == :LIMITS_CHANGE
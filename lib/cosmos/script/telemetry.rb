@@ -125,9 +125,22 @@ module Cosmos
     # Subscribe to one or more telemetry packets. The queue ID is returned for
     # use in get_packet_data and unsubscribe_packet_data.
     # Usage:
-    #   id = subscribe_packet_data([[target_name,packet_name], ...], <queue_size>)
-    def subscribe_packet_data(packets, queue_size = CmdTlmServer::DEFAULT_PACKET_DATA_QUEUE_SIZE)
-      result = $cmd_tlm_server.subscribe_packet_data(packets, queue_size)
+    #   id = subscribe_packet_data([[target_name,packet_name], ...], <queue_size>, <overflow>)
+    def subscribe_packet_data(packets,
+                              queue_size = CmdTlmServer::DEFAULT_PACKET_DATA_QUEUE_SIZE,
+                              overflow = CmdTlmServer::DEFAULT_PACKET_DATA_QUEUE_OVERFLOW)
+      result = $cmd_tlm_server.subscribe_packet_data(packets, queue_size, overflow)
+      result
+    end
+
+    # Get the status of a packet data queue. Returns an array containing the
+    # number of queued packets, the queue size, the overflow policy and the
+    # number of packets dropped because the queue was full.
+    # Usage:
+    #   length, queue_size, overflow, dropped_count = get_packet_data_queue_stats(id)
+    def get_packet_data_queue_stats(id)
+      result = $cmd_tlm_server.get_packet_data_queue_stats(id)
+      result[2] = result[2].to_s.intern
       result
     end
 
@@ -150,6 +163,24 @@ module Cosmos
       results
     end
 
+    # Get up to max_packets packet data entries in one call. Blocks for up to
+    # timeout seconds (forever if nil) waiting for the first packet. Each
+    # entry is in the same format as get_packet_data.
+    # Usage:
+    #   entries = get_packet_data_batch(id, <max_packets>, <timeout>)
+    def get_packet_data_batch(id, max_packets = CmdTlmServer::DEFAULT_BATCH_SIZE, timeout = nil)
+      results = $cmd_tlm_server.get_packet_data_batch(id, max_packets, timeout)
+      if results
+        results.each do |result|
+          if Array === result and result[3] and result[4]
+            result[3] = Time.at(result[3], result[4])
+            result.delete_at(4)
+          end
+        end
+      end
+      results
+    end
+
     # Get a packet which was previously subscribed to by
     # subscribe_packet_data. This method can block waiting for new packets or
     # not based on the second parameter. It returns a single Cosmos::Packet instance
@@ -0,0 +1,154 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'cosmos/streams/tcpip_socket_stream'
+
+module Cosmos
+
+  # {TcpipSocketStream} used by an event loop which waits on many sockets
+  # from a single thread. Writes are queued in an output buffer instead of
+  # blocking and the event loop calls {#flush} when the socket is writable.
+  # The queued strings are written as they are without being joined so the
+  # same frozen strings can be queued to many streams.
+  class BufferedTcpipSocketStream < TcpipSocketStream
+    # @return [Integer] Number of bytes queued which have not been written
+    attr_reader :bytes_queued
+    # @return [Integer] The most bytes which have been queued at once
+    attr_reader :max_bytes_queued
+
+    # (see TcpipSocketStream#initialize)
+    def initialize(write_socket, read_socket, write_timeout, read_timeout)
+      super(write_socket, read_socket, write_timeout, read_timeout)
+      @output = []
+      # Bytes of the first queued string which have already been written
+      @output_offset = 0
+      @bytes_queued = 0
+      @max_bytes_queued = 0
+      @stalled_time = nil
+      # Total bytes ever queued and written and the time each write was
+      # queued as pairs of the total queued after the write and the time
+      @total_queued = 0
+      @total_written = 0
+      @queue_times = []
+    end
+
+    # Queue data to be written by {#flush}
+    #
+    # @param data [String] A binary string of data to write to the socket
+    def write(data)
+      writev([data])
+    end
+
+    # Queue strings to be written in order by {#flush}
+    #
+    # @param segments [Array<String>] Binary strings to write to the socket
+    def writev(segments)
+      raise "Attempt to write to read only stream" unless @write_socket
+      @write_mutex.synchronize do
+        segments.each do |segment|
+          next if segment.length <= 0
+          @output << segment
+          @bytes_queued += segment.length
+          @total_queued += segment.length
+        end
+        @max_bytes_queued = @bytes_queued if @bytes_queued > @max_bytes_queued
+        unless @queue_times[-1] and @queue_times[-1][0] == @total_queued
+          @queue_times << [@total_queued, Process.clock_gettime(Process::CLOCK_MONOTONIC)]
+        end
+      end
+    end
+
+    # Write as much of the queued data as the socket accepts without blocking
+    #
+    # @return [Boolean] Whether all the queued data has been written
+    def flush
+      @write_mutex.synchronize do
+        until @output.empty?
+          if @write_socket.respond_to?(:writev_nonblock)
+            segments = @output.first(64)
+            segments[0] = segments[0][@output_offset..-1] if @output_offset > 0
+            begin
+              bytes_sent = @write_socket.writev_nonblock(segments)
+            rescue Errno::EAGAIN, Errno::EWOULDBLOCK
+              bytes_sent = 0
+            end
+          else
+            bytes_sent = @write_socket.write_nonblock(@output[0][@output_offset..-1], exception: false)
+            bytes_sent = 0 if bytes_sent == :wait_writable
+          end
+
+          if bytes_sent <= 0
+            @stalled_time ||= Process.clock_gettime(Process::CLOCK_MONOTONIC)
+            return false
+          end
+          @stalled_time = nil
+          @bytes_queued -= bytes_sent
+          @total_written += bytes_sent
+          @queue_times.shift while @queue_times[0] and @queue_times[0][0] <= @total_written
+          consume(bytes_sent)
+        end
+      end
+      true
+    end
+
+    # @return [Boolean] Whether there is queued data which has not been
+    #   written
+    def write_pending?
+      !@output.empty?
+    end
+
+    # @param now [Float] The current monotonic clock time
+    # @return [Float] Seconds since the socket stopped accepting queued data or
+    #   0 if it is accepting data
+    def stalled_for(now = Process.clock_gettime(Process::CLOCK_MONOTONIC))
+      @stalled_time ? now - @stalled_time : 0.0
+    end
+
+    # @param now [Float] The current monotonic clock time
+    # @return [Float] Seconds since the oldest data which has not been written
+    #   was queued or 0 if all the queued data has been written
+    def lag(now = Process.clock_gettime(Process::CLOCK_MONOTONIC))
+      oldest = @queue_times[0]
+      oldest ? now - oldest[1] : 0.0
+    end
+
+    # Disconnect and drop any queued data
+    def disconnect
+      super()
+      @write_mutex.synchronize do
+        @output.clear
+        @queue_times.clear
+        @output_offset = 0
+        @bytes_queued = 0
+      end
+    end
+
+    protected
+
+    # Remove the bytes written from the front of the output buffer
+    def consume(bytes_sent)
+      until bytes_sent <= 0
+        remaining = @output[0].length - @output_offset
+        if bytes_sent >= remaining
+          segment = @output.shift
+          @raw_logger_pair.write_logger.write(@output_offset > 0 ? segment[@output_offset..-1] : segment) if @raw_logger_pair
+          @output_offset = 0
+          bytes_sent -= remaining
+        else
+          @raw_logger_pair.write_logger.write(@output[0][@output_offset, bytes_sent]) if @raw_logger_pair
+          @output_offset += bytes_sent
+          bytes_sent = 0
+        end
+      end
+    end
+
+  end # class BufferedTcpipSocketStream
+
+end # module Cosmos
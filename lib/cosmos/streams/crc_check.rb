@@ -0,0 +1,131 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'cosmos/config/config_parser'
+require 'cosmos/packets/binary_accessor'
+require 'cosmos/utilities/crc'
+
+module Cosmos
+
+  # Validates a CRC held in each frame read by a {StreamProtocol}. The CRC is
+  # calculated natively over the frame in place from the start offset up to
+  # the CRC field so no part of the frame is copied.
+  class CrcCheck
+    # Actions which can be taken when the CRC does not match
+    ACTIONS = [:ERROR, :DISCARD, :WARN]
+
+    # @return [Integer] The number of frames whose CRC did not match
+    attr_accessor :failures
+    # @return [Symbol] The action taken when the CRC does not match. One of
+    #   {ACTIONS}.
+    attr_reader :action
+    # @return [Crc] The CRC algorithm
+    attr_reader :crc
+
+    # @param bit_size [Integer] Size of the CRC in bits. Must be 16, 32 or 64.
+    # @param poly [Integer|nil] Polynomial or nil to use the default for the
+    #   CRC size
+    # @param seed [Integer|nil] Seed or nil to use the default for the CRC size
+    # @param xor [Boolean|nil] Whether to XOR the result or nil to use the
+    #   default for the CRC size
+    # @param reflect [Boolean|nil] Whether to bit reverse each byte or nil to
+    #   use the default for the CRC size
+    # @param bit_offset [Integer|nil] Byte aligned bit offset of the CRC field
+    #   in the frame. Negative offsets are from the end of the frame. nil
+    #   places the CRC at the end of the frame.
+    # @param endianness [String] Endianness of the CRC field. Must be either
+    #   BIG_ENDIAN or LITTLE_ENDIAN.
+    # @param action [String] What to do when the CRC does not match. ERROR
+    #   raises an error which disconnects the interface, DISCARD logs an error
+    #   and drops the frame and WARN logs a warning and keeps the frame.
+    # @param start_offset [Integer] Byte offset in the frame where the CRC
+    #   calculation starts. The calculation ends at the CRC field.
+    def initialize(bit_size = 16,
+                   poly = nil,
+                   seed = nil,
+                   xor = nil,
+                   reflect = nil,
+                   bit_offset = nil,
+                   endianness = 'BIG_ENDIAN',
+                   action = 'ERROR',
+                   start_offset = 0)
+      @bit_size = Integer(bit_size)
+      case @bit_size
+      when 16
+        klass = Crc16
+      when 32
+        klass = Crc32
+      when 64
+        klass = Crc64
+      else
+        raise ArgumentError, "Invalid CRC bit size: #{bit_size}. Must be 16, 32 or 64."
+      end
+
+      poly = ConfigParser.handle_nil(poly)
+      poly = poly ? Integer(poly) : klass::DEFAULT_POLY
+      seed = ConfigParser.handle_nil(seed)
+      seed = seed ? Integer(seed) : klass::DEFAULT_SEED
+      xor = ConfigParser.handle_true_false_nil(xor)
+      reflect = ConfigParser.handle_true_false_nil(reflect)
+      default_crc = klass.new
+      xor = default_crc.xor if xor.nil?
+      reflect = default_crc.reflect if reflect.nil?
+      @crc = klass.new(poly, seed, xor, reflect)
+
+      @bit_offset = ConfigParser.handle_nil(bit_offset)
+      @bit_offset = @bit_offset ? Integer(@bit_offset) : -@bit_size
+      raise ArgumentError, "CRC bit offset must be byte aligned: #{bit_offset}" if (@bit_offset % 8) != 0
+
+      if endianness.to_s.upcase == 'LITTLE_ENDIAN'
+        @endianness = :LITTLE_ENDIAN
+      else
+        @endianness = :BIG_ENDIAN
+      end
+
+      @action = action.to_s.upcase.intern
+      raise ArgumentError, "Invalid CRC action: #{action}. Must be one of #{ACTIONS.join(', ')}." unless ACTIONS.include?(@action)
+
+      @start_offset = Integer(start_offset)
+      @failures = 0
+    end
+
+    # Check the CRC of a frame and take the configured action if it does not
+    # match
+    #
+    # @param data [String] The frame
+    # @return [Boolean] Whether the frame should be kept
+    def process(data)
+      byte_offset = @bit_offset / 8
+      byte_offset += data.length if byte_offset < 0
+      if (byte_offset >= @start_offset) and ((byte_offset + (@bit_size / 8)) <= data.length)
+        expected = BinaryAccessor.read(byte_offset * 8, @bit_size, :UINT, data, @endianness)
+        calculated = @crc.calc(data, nil, @start_offset, byte_offset - @start_offset)
+        return true if expected == calculated
+        message = sprintf("CRC mismatch: received 0x%X, calculated 0x%X", expected, calculated)
+      else
+        message = "Frame of #{data.length} bytes is too short to hold a CRC"
+      end
+
+      @failures += 1
+      case @action
+      when :ERROR
+        raise message
+      when :DISCARD
+        Logger.error(message)
+        false
+      else
+        Logger.warn(message)
+        true
+      end
+    end
+
+  end # class CrcCheck
+
+end # module Cosmos
@@ -33,6 +33,7 @@ module Cosmos
       super(discard_leading_bytes, sync_pattern, fill_sync_pattern)
       @min_id_size = Integer(min_id_size)
       @telemetry_stream = telemetry_stream
+      @identify_lengths = {}
     end
 
     # Set the received_time, target_name and packet_name which we recorded when
@@ -72,8 +73,9 @@ module Cosmos
         end
 
         identified_packet = nil
+        identify_data = @data.peek(0, identify_length(target_name, target_packets))
         target_packets.each do |packet_name, packet|
-          if (packet.identify?(@data))
+          if (packet.identify?(identify_data))
             identified_packet = packet
             if identified_packet.defined_length > @data.length
               # Need more data to finish packet
@@ -87,8 +89,7 @@ module Cosmos
             @packet_name = identified_packet.packet_name
 
             # Get the data from this packet
-            packet_data = @data[0..(identified_packet.defined_length - 1)]
-            @data.replace(@data[identified_packet.defined_length..-1])
+            packet_data = @data.shift(identified_packet.defined_length)
             break
           end
         end
@@ -99,6 +100,12 @@ module Cosmos
       packet_data
     end
 
+    # @return [Integer] The number of bytes which hold the ID items of all of
+    #   the packets in the target
+    def identify_length(target_name, target_packets)
+      @identify_lengths[target_name] ||= target_packets.values.map {|packet| packet.defined_length }.max || 0
+    end
+
     def reduce_to_single_packet
       read_minimum_size(@min_id_size)
       return nil if @data.length <= 0
@@ -10,6 +10,7 @@
 
 require 'cosmos/packets/binary_accessor'
 require 'cosmos/streams/stream_protocol'
+require 'cosmos/streams/receive_buffer'
 require 'cosmos/config/config_parser'
 
 module Cosmos
@@ -73,10 +74,31 @@ module Cosmos
       # Save max length setting
       @max_length = ConfigParser.handle_nil(max_length)
       @max_length = Integer(@max_length) if @max_length
+
+      # Byte aligned length fields are framed natively
+      @framer = nil
+      if (@length_bit_offset >= 0) and ((@length_bit_offset % 8) == 0) and
+         ((@length_bit_size % 8) == 0) and (@length_bit_size >= 8) and (@length_bit_size <= 64)
+        @framer = LengthFramer.new(@length_bit_offset,
+                                   @length_bit_size,
+                                   @length_value_offset,
+                                   @length_bytes_per_count,
+                                   @length_endianness,
+                                   @max_length,
+                                   @sync_pattern)
+      end
+
+      # When the sync pattern and length field are both within the discarded
+      # leading bytes they are written as a separate header
+      @fill_header_only = (@fill_sync_pattern and (@discard_leading_bytes > 0) and
+        (@length_bytes_needed <= @discard_leading_bytes) and
+        (!@sync_pattern or (@sync_pattern.length <= @discard_leading_bytes)))
     end
 
     # See StreamProtocol#pre_write_packet
     def pre_write_packet(packet)
+      return pre_write_header(packet) if @fill_header_only
+
       data = super(packet)
       if @fill_sync_pattern # and length
         # Fill the length field
@@ -110,7 +132,26 @@ module Cosmos
 
     protected
 
+    # Build the discarded leading bytes holding the sync pattern and length
+    # field and return them ahead of the unmodified packet buffer
+    def pre_write_header(packet)
+      data = packet.buffer(false)
+      header = "\x00" * @discard_leading_bytes
+      header[0, @sync_pattern.length] = @sync_pattern if @sync_pattern
+      length = (header.length + data.length - @length_value_offset) / @length_bytes_per_count
+      BinaryAccessor.write(length,
+        @length_bit_offset,
+        @length_bit_size,
+        :UINT,
+        header,
+        @length_endianness,
+        :ERROR)
+      [header, data]
+    end
+
     def reduce_to_single_packet
+      return reduce_with_framer(@framer) if @framer
+
       # Make sure we have at least enough data to reach the length field
       read_minimum_size(@length_bytes_needed)
       return nil if @data.length <= 0
@@ -119,7 +160,7 @@ module Cosmos
       length = BinaryAccessor.read(@length_bit_offset,
                                    @length_bit_size,
                                    :UINT,
-                                   @data,
+                                   @data.peek(0, @length_bytes_needed),
                                    @length_endianness)
       raise "Length value received larger than max_length: #{length} > #{@max_length}" if @max_length and length > @max_length
       packet_length = (length * @length_bytes_per_count) + @length_value_offset
@@ -129,10 +170,7 @@ module Cosmos
       return nil if @data.length <= 0
 
       # Reduce to packet data and setup current_data for next packet
-      packet_data = @data[0..(packet_length - 1)]
-      @data.replace(@data[packet_length..-1])
-
-      packet_data
+      @data.shift(packet_length)
     end
 
   end # class LengthStreamProtocol
@@ -0,0 +1,53 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'cosmos/ext/receive_buffer'
+
+module Cosmos
+
+  # Unread data received by a {StreamProtocol}. Bytes are consumed from the
+  # front with {#shift} and {#discard} without copying the rest.
+  #
+  # StreamProtocol subclasses written when the data was a String can still
+  # use the String methods below. Each copies the unread data so new code
+  # should use {#peek}, {#shift} and {#discard} instead.
+  class ReceiveBuffer
+    # @param args Arguments to String#[]
+    # @return [String|nil] The part of the unread data String#[] returns
+    def [](*args)
+      to_s[*args]
+    end
+    alias slice []
+
+    # Replace the unread data
+    #
+    # @param data [String] The new unread data
+    # @return [ReceiveBuffer] self
+    def replace(data)
+      data = data.to_s
+      clear()
+      self << data
+    end
+
+    # @return [String] Copy of all the unread bytes so the buffer can be
+    #   passed where a String is expected
+    def to_str
+      to_s
+    end
+
+    # Copy the unread data of another buffer so dup and clone return an
+    # independent buffer
+    def initialize_copy(other)
+      super(other)
+      self << other.to_s
+    end
+  end
+
+end # module Cosmos
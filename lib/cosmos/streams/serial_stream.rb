@@ -38,13 +38,20 @@ module Cosmos
     #   complete. Pass nil to create no timeout. The {SerialDriver} will
     #   continously try to read data until it has received data or an error
     #   occurs.
+    # @param read_buffer_size [Integer|nil] Size in bytes of the buffer the
+    #   read port is read into by a native thread or nil to read without one
+    # @param inter_byte_timeout [Float|nil] Seconds of silence after which
+    #   the read port returns a partial read or nil to return every byte as
+    #   soon as it arrives
     def initialize(write_port_name,
                    read_port_name,
                    baud_rate,
                    parity,
                    stop_bits,
                    write_timeout,
-                   read_timeout)
+                   read_timeout,
+                   read_buffer_size = nil,
+                   inter_byte_timeout = nil)
       super()
 
       # The SerialDriver class will validate the parameters
@@ -57,14 +64,22 @@ module Cosmos
       @write_timeout   = @write_timeout.to_f if @write_timeout
       @read_timeout    = ConfigParser.handle_nil(read_timeout)
       @read_timeout    = @read_timeout.to_f if @read_timeout
+      @read_buffer_size = ConfigParser.handle_nil(read_buffer_size)
+      @read_buffer_size = Integer(@read_buffer_size) if @read_buffer_size
+      @inter_byte_timeout = ConfigParser.handle_nil(inter_byte_timeout)
+      @inter_byte_timeout = @inter_byte_timeout.to_f if @inter_byte_timeout
 
       if @write_port_name
+        # A port which is only written does not need a read buffer
+        shared = (@read_port_name == @write_port_name)
         @write_serial_port = SerialDriver.new(@write_port_name,
                                               @baud_rate,
                                               @parity,
                                               @stop_bits,
                                               @write_timeout,
-                                              @read_timeout)
+                                              @read_timeout,
+                                              shared ? @read_buffer_size : 0,
+                                              shared ? @inter_byte_timeout : nil)
       else
         @write_serial_port = nil
       end
@@ -77,7 +92,9 @@ module Cosmos
                                                @parity,
                                                @stop_bits,
                                                @write_timeout,
-                                               @read_timeout)
+                                               @read_timeout,
+                                               @read_buffer_size,
+                                               @inter_byte_timeout)
         end
       else
         @read_serial_port = nil
@@ -114,6 +131,12 @@ module Cosmos
       data
     end
 
+    # @return [Hash|nil] Error counters of the read port. See
+    #   {SerialDriver#error_counts}.
+    def error_counts
+      @read_serial_port ? @read_serial_port.error_counts : nil
+    end
+
     # @param data [String] A binary string of data to write to the serial port
     def write(data)
       raise "Attempt to write to read only stream" unless @write_serial_port
@@ -123,6 +146,18 @@ module Cosmos
       end
     end
 
+    # @param segments [Array<String>] Binary strings to write to the serial
+    #   port in order
+    def writev(segments)
+      raise "Attempt to write to read only stream" unless @write_serial_port
+      @write_mutex.synchronize do
+        segments.each do |segment|
+          @write_serial_port.write(segment)
+          @raw_logger_pair.write_logger.write(segment) if @raw_logger_pair
+        end
+      end
+    end
+
     # Connect the stream
     def connect
       # N/A - Serial streams 'connect' on creation
@@ -42,6 +42,15 @@ module Cosmos
       raise "write not defined by Stream"
     end
 
+    # Expected to write each of the segments in order as one complete set of
+    # data. Streams which can send the segments without joining them first
+    # should override this method. May raise Timeout::Error or other errors.
+    #
+    # @param segments [Array<String>] Binary strings to write to the stream
+    def writev(segments)
+      write(segments.join)
+    end
+
     # Connects the stream
     def connect
       raise "connect not defined by Stream"
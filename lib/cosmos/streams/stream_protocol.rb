@@ -10,6 +10,8 @@
 
 require 'cosmos/config/config_parser'
 require 'thread'
+require 'cosmos/utilities/latency_stats'
+require 'cosmos/streams/receive_buffer'
 
 module Cosmos
 
@@ -20,11 +22,17 @@ module Cosmos
   # on a given synchronization pattern. The StreamProtocol operates at the
   # {Packet} abstraction level while the {Stream} operates on raw bytes.
   class StreamProtocol
+    # Minimum number of seconds between log messages about data discarded
+    # while searching for the sync pattern
+    DISCARD_LOG_PERIOD = 1.0
 
     # @return [Integer] The number of bytes read from the stream
     attr_accessor :bytes_read
     # @return [Integer] The number of bytes written to the stream
     attr_accessor :bytes_written
+    # @return [Integer] The number of bytes discarded while searching for
+    #   the sync pattern
+    attr_reader :bytes_discarded
     # @return [Interface] The interface associated with this
     #   StreamProtocol. The interface is a higher level abstraction and is
     #   passed down to the StreamProtocol to allow it to call the callbacks in
@@ -33,6 +41,9 @@ module Cosmos
     attr_reader :interface
     # @return [Stream] The stream this StreamProtocol is processing data from
     attr_reader :stream
+    # @return [CrcCheck|nil] Validates the CRC of each packet read before
+    #   the leading bytes are discarded
+    attr_accessor :crc_check
 
     # @return [Proc] The name of a method in the {Interface} that #read calls
     #   after reading data from the {Stream}. It should take a String binary data
@@ -65,9 +76,18 @@ module Cosmos
       @fill_sync_pattern = ConfigParser.handle_true_false(fill_sync_pattern)
 
       @stream = nil
-      @data = ''
+      # Data read from the stream which has not been reduced to a packet.
+      # Subclasses can also use the String methods of ReceiveBuffer such as
+      # [], replace and to_s.
+      @data = ReceiveBuffer.new
+      # Complete packets removed from the data by a native framer
+      @frames = []
       @bytes_read = 0
       @bytes_written = 0
+      @bytes_discarded = 0
+      @unlogged_bytes_discarded = 0
+      @discard_log_time = nil
+      @crc_check = nil
 
       @interface = nil
       @post_read_data_callback = nil
@@ -100,8 +120,8 @@ module Cosmos
     # @param stream [Stream] The stream this stream protocol should read and
     #   write to
     def connect(stream)
-      @data = ''
-      @data.force_encoding('ASCII-8BIT')
+      @data.clear
+      @frames.clear
       @stream = stream
       @stream.connect
     end
@@ -120,7 +140,12 @@ module Cosmos
     # Clears the data attribute.
     def disconnect
       @stream.disconnect if @stream
-      @data = ''
+      @data.clear
+      @frames.clear
+      if @unlogged_bytes_discarded > 0
+        Logger.error("Discarded #{@unlogged_bytes_discarded} bytes of data while searching for the sync pattern.")
+        @unlogged_bytes_discarded = 0
+      end
     end
 
     # Reads from the stream. It can look for a sync pattern before
@@ -143,6 +168,11 @@ module Cosmos
         # Reduce the data to a single packet
         packet_data = reduce_to_single_packet()
         return nil unless packet_data
+        # The packet is complete so read_buffered must not frame it again
+        commit_batch_data()
+
+        # Drop packets which fail the CRC check if configured to
+        next if @crc_check and !@crc_check.process(packet_data)
 
         # Discard leading bytes if necessary
         packet_data.replace(packet_data[@discard_leading_bytes..-1]) if @discard_leading_bytes > 0
@@ -174,6 +204,48 @@ module Cosmos
       end # loop do
     end
 
+    # Reads a packet from the stream and then frames any further packets
+    # which are already complete in the data read without reading the stream
+    # again. This allows a single stream read containing many small packets
+    # to be processed as one batch.
+    #
+    # @param max_packets [Integer] Maximum number of packets to return
+    # @return [Array<Packet>|nil] The packets read or nil if the stream was
+    #   closed
+    def read_batch(max_packets = 100)
+      packet = read()
+      return nil unless packet
+      packets = [packet]
+      while packets.length < max_packets and buffered_data?()
+        packet = read_buffered()
+        break unless packet
+        packets << packet
+      end
+      packets
+    end
+
+    # Frames the packets completed by data which has already been read from
+    # the stream. This allows an event loop which reads many streams itself
+    # to use the stream protocol without blocking in {#read}.
+    #
+    # @param data [String] Data read from the stream
+    # @return [Array<Packet>] The packets completed by the data. Errors
+    #   reading a packet are raised.
+    def receive(data)
+      @bytes_read += data.length
+      if LatencyStats.enabled and @interface and @interface.latency_stats
+        @interface.latency_stats.arrived
+      end
+      @data << data
+      packets = []
+      while buffered_data?()
+        packet = read_buffered(true)
+        break unless packet
+        packets << packet
+      end
+      packets
+    end
+
     # Writes the packet data to the stream.
     #
     # If the pre_write_packet_callback is defined (pre_write_packet is
@@ -184,34 +256,74 @@ module Cosmos
     # @param packet [Packet] Packet data to write to the stream
     def write(packet)
       @write_mutex.synchronize do
-        if @pre_write_packet_callback
-          data = @pre_write_packet_callback.call(packet)
-        else
-          data = pre_write_packet(packet)
-        end
+        data = encode(packet)
         if data
-          write_raw(data, false)
-          if @post_write_data_callback
-            @post_write_data_callback.call(packet, data)
-          else
-            post_write_data(packet, data)
-          end
+          write_encoded(packet, data, false)
         else
           # write aborted - don't write data
         end
       end
     end
 
+    # Translates a packet into the data written to the stream using the
+    # pre_write_packet_callback or pre_write_packet
+    #
+    # @param packet [Packet] Packet to translate
+    # @return [String|Array<String>|nil] The data to write or nil if the
+    #   write should be aborted
+    def encode(packet)
+      if @pre_write_packet_callback
+        @pre_write_packet_callback.call(packet)
+      else
+        pre_write_packet(packet)
+      end
+    end
+
+    # Writes data returned by {#encode} to the stream and then calls
+    # post_write_data. The data may have been encoded by another instance
+    # whose {#shared_encoding?} is true.
+    #
+    # @param packet [Packet] The packet the data was encoded from
+    # @param data [String|Array<String>] The encoded data
+    # @param take_mutex [Boolean] Whether or not to take the write_mutex
+    def write_encoded(packet, data, take_mutex = true)
+      @write_mutex.lock if take_mutex
+      begin
+        write_raw(data, false)
+        if @post_write_data_callback
+          @post_write_data_callback.call(packet, data)
+        else
+          post_write_data(packet, data)
+        end
+      ensure
+        @write_mutex.unlock if take_mutex
+      end
+    end
+
+    # @return [Boolean] Whether instances of this class with the same
+    #   configuration encode a packet to the same data. This allows a packet
+    #   written to many streams to be encoded once. Protocols which keep
+    #   state between pre_write_packet and post_write_data return false.
+    def shared_encoding?
+      true
+    end
+
     # Writes the raw binary string to the stream.
     #
-    # @param data [String] Raw binary string
+    # @param data [String|Array<String>] Raw binary string or an Array of
+    #   binary strings which are written in order without being joined
     # @param take_mutex [Boolean] Whether or not to take the write_mutex
     def write_raw(data, take_mutex = true)
       @write_mutex.lock if take_mutex
       begin
         if connected?()
-          @stream.write(data)
-          @bytes_written += data.length
+          if Array === data
+            @stream.writev(data)
+            data.each {|segment| @bytes_written += segment.length }
+          else
+            @stream.write(data)
+            @bytes_written += data.length
+          end
         else
           raise "Stream not connected for write_raw"
         end
@@ -238,8 +350,12 @@ module Cosmos
 
     # Called to perform modifications on write data before writing it out the stream
     #
+    # Subclasses which add framing around the packet may return an Array of
+    # strings such as a header followed by the packet buffer. The strings are
+    # written in order without being joined so the packet buffer is not copied.
+    #
     # @param packet [Packet] packet to write out
-    # @return [String] Potentially modified packet data
+    # @return [String|Array<String>] Potentially modified packet data
     def pre_write_packet(packet)
       data = packet.buffer(false)
       if @fill_sync_pattern
@@ -263,68 +379,117 @@ module Cosmos
     # Called to perform actions after writing data to the stream
     #
     # @param packet [Packet] packet that was written out
-    # @param data [String] binary data that was written out
+    # @param data [String|Array<String>] binary data that was written out as
+    #   returned by pre_write_packet
     def post_write_data(packet, data)
       # Default do nothing
     end
 
     protected
 
+    # Reads a packet using only the data already received. If the next
+    # packet is not complete or reducing it raises an error the data and
+    # frames consumed since the last {#commit_batch_data} are restored so the
+    # packet can be read again once more data arrives. Packets reduced before
+    # an error are not read again.
+    #
+    # @param raise_errors [Boolean] Whether to raise errors reading the packet
+    #   after restoring the data rather than leaving them for the next read
+    # @return [Packet|nil] The packet or nil if it is not complete
+    def read_buffered(raise_errors = false)
+      packet = nil
+      complete = false
+      @batch_reading = true
+      commit_batch_data()
+      begin
+        catch(:partial_packet) do
+          packet = read()
+          complete = true
+        end
+      rescue
+        rewind_batch_data()
+        raise if raise_errors
+        # Leave the error to be raised by the next read
+        return nil
+      ensure
+        @batch_reading = false
+      end
+      unless complete and packet
+        rewind_batch_data()
+        return nil
+      end
+      packet
+    end
+
+    # Keep the data and frames consumed so far when {#read_buffered} finds
+    # the next packet is not complete. Called once a packet has been reduced
+    # and for data which must not be processed again such as discarded data.
+    def commit_batch_data
+      return unless @batch_reading
+      @batch_checkpoint = @data.checkpoint
+      # Frames are only queued between commits. Each one shifted is a
+      # reduced packet which is committed.
+      @batch_frames = @frames.length
+    end
+
+    # Restore the data consumed and remove the frames queued since the last
+    # {#commit_batch_data}
+    def rewind_batch_data
+      @data.rewind(@batch_checkpoint)
+      @frames.slice!(@batch_frames..-1)
+    end
+
+    # @return [Boolean] Whether data has been received which has not yet been
+    #   returned as a packet
+    def buffered_data?
+      !@frames.empty? or @data.length > 0
+    end
+
     # @return [Boolean] Whether we successfully found a sync pattern
     def handle_sync_pattern
-      if @sync_pattern
+      # Queued frames were checked for the sync pattern by the framer
+      if @sync_pattern and @frames.empty?
         loop do
           # Make sure we have some data to look for a sync word in
           read_minimum_size(@sync_pattern.length)
           return false if @data.length <= 0
 
           # Find the beginning of the sync pattern
-          sync_index = @data.index(@sync_pattern.getbyte(0).chr)
+          sync_index = @data.index(@sync_pattern)
           if sync_index
-            # Make sure we have enough data for the whole sync pattern past this index
-            read_minimum_size(sync_index + @sync_pattern.length)
-            return false if @data.length <= 0
-
-            # Check for the rest of the sync pattern
-            found = true
-            index = sync_index
-            @sync_pattern.each_byte do |byte|
-              if @data.getbyte(index) != byte
-                found = false
-                break
-              end
-              index += 1
+            if sync_index != 0
+              log_discard(sync_index, true)
+              # Delete Data Before Sync Pattern
+              @data.discard(sync_index)
+              # Do not discard and count the data again if read_buffered rewinds
+              commit_batch_data()
             end
-
-            if found
-              if sync_index != 0
-                discard_length = @data[0..(sync_index - 1)].length
-                log_discard(discard_length, true)
-                # Delete Data Before Sync Pattern
-                @data.replace(@data[sync_index..-1])
-              end
-              return true
-
-            else # not found
-              log_discard(@data[0..sync_index].length, false)
-              # Delete Data Before and including first character of suspected sync Pattern
-              @data.replace(@data[(sync_index + 1)..-1])
-              next
-            end # if found
-
-          else # sync_index = nil
-            log_discard(@data.length, false)
-            @data.replace('')
-            next
-          end # unless sync_index.nil?
+            return true
+          else
+            # Delete everything except the bytes which could be the start of
+            # a sync pattern split across reads
+            discard_length = @data.length - @sync_pattern.length + 1
+            log_discard(discard_length, false)
+            @data.discard(discard_length)
+            commit_batch_data()
+          end
         end # end loop
       end # if @sync_pattern
 
       true
     end
 
+    # Count discarded bytes and log them at most once every
+    # {DISCARD_LOG_PERIOD} seconds so a noisy stream does not flood the log
     def log_discard(length, found)
-      Logger.error("Sync #{'not ' unless found}found. Discarding #{length} bytes of data.")
+      @bytes_discarded += length
+      @unlogged_bytes_discarded += length
+      now = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      return if @discard_log_time and (now - @discard_log_time) < DISCARD_LOG_PERIOD
+      @discard_log_time = now
+
+      Logger.error("Sync #{'not ' unless found}found. Discarding #{@unlogged_bytes_discarded} bytes of data.")
+      @unlogged_bytes_discarded = 0
       if @data.length >= 6
         Logger.error(sprintf("Starting: 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X\n",
           @data.getbyte(0), @data.getbyte(1), @data.getbyte(2), @data.getbyte(3), @data.getbyte(4), @data.getbyte(5)))
@@ -339,23 +504,46 @@ module Cosmos
       end
 
       # Reduce to packet data and clear data for next packet
-      packet_data = @data.clone
-      @data.replace('')
+      packet_data = @data.shift(@data.length)
 
       packet_data
     end
 
+    # Remove the next packet using a native framer. The framer removes every
+    # complete packet in the data at once and the rest are queued for the
+    # following reads.
+    #
+    # @param framer [#frame] Framer whose frame method takes the receive
+    #   buffer and an array to append packets to and returns the number of
+    #   bytes needed before another packet can be removed
+    # @return [String|nil] The packet data or nil if the stream was closed
+    def reduce_with_framer(framer)
+      while @frames.empty?
+        bytes_needed = framer.frame(@data, @frames)
+        if @frames.empty?
+          read_minimum_size(bytes_needed)
+          return nil if @data.length <= 0
+        end
+      end
+      @frames.shift
+    end
+
     def read_and_handle_timeout
+      # read_batch only frames packets already in the data
+      throw :partial_packet if @batch_reading
       begin
         data = @stream.read
         @bytes_read += data.length
+        if LatencyStats.enabled and @interface and @interface.latency_stats
+          @interface.latency_stats.arrived
+        end
       rescue Timeout::Error
         Logger.instance.error "Timeout waiting for data to be read"
         data = ''
       end
       # data.length == 0 means that the stream was closed.  Need to clear out @data and be done.
       if data.length == 0
-        @data.replace('')
+        @data.clear
         return
       end
       @data << data
@@ -19,6 +19,9 @@ module Cosmos
   # Data {Stream} which reads and writes to TCPIP sockets. This class creates
   # the actual sockets based on the constructor parameters. The rest of the
   # interface is implemented by the super class {TcpipSocketStream}.
+  #
+  # A local stream connects to the Unix domain sockets of a {TcpipServer}
+  # with local_socket set instead of its TCP ports.
   class TcpipClientStream < TcpipSocketStream
 
     # @param hostname [String] The host to connect to
@@ -28,7 +31,14 @@ module Cosmos
     #   a write only stream.
     # @param write_timeout (see TcpipSocketStream#initialize)
     # @param read_timeout (see TcpipSocketStream#initialize)
-    def initialize(hostname, write_port, read_port, write_timeout, read_timeout, connect_timeout = 5.0)
+    # @param connect_timeout [Float|nil] Number of seconds to wait for the
+    #   connection to complete
+    # @param local [Boolean] Whether to connect to the Unix domain sockets at
+    #   {TcpipSocketStream.local_socket_path} for the ports. Only used when
+    #   the hostname resolves to a loopback address and every socket passes
+    #   {TcpipSocketStream.local_socket?}. The TCP ports are used if
+    #   connecting to the Unix domain sockets fails.
+    def initialize(hostname, write_port, read_port, write_timeout, read_timeout, connect_timeout = 5.0, local = false)
       @hostname = hostname
       if (@hostname.to_s.upcase == 'LOCALHOST')
         @hostname = '127.0.0.1'
@@ -38,49 +48,96 @@ module Cosmos
       @read_port  = ConfigParser.handle_nil(read_port)
       @read_port  = Integer(read_port) if @read_port
 
-      write_addr = nil
-      read_addr = nil
+      @local = (local and loopback? and
+        [@write_port, @read_port].compact.all? {|port| TcpipSocketStream.local_socket?(port) })
+      create_addresses()
+      write_socket, read_socket = create_sockets()
+
+      @connect_timeout = ConfigParser.handle_nil(connect_timeout)
+      @connect_timeout = @connect_timeout.to_f if @connect_timeout
+
+      super(write_socket, read_socket, write_timeout, read_timeout)
+    end
+
+    # Connect the socket(s)
+    def connect
       begin
-        @write_addr = Socket.pack_sockaddr_in(@write_port, @hostname) if @write_port
-        @read_addr = Socket.pack_sockaddr_in(@read_port, @hostname) if @read_port
-      rescue => error
-        if error.message =~ /getaddrinfo/
-          raise "Invalid hostname: #{@hostname}"
-        else
-          raise error
+        connect_sockets()
+      rescue SystemCallError
+        raise unless @local
+        # The local server is not running or can not be accessed so connect
+        # to its TCP ports instead
+        Cosmos.close_socket(@write_socket)
+        Cosmos.close_socket(@read_socket)
+        @local = false
+        create_addresses()
+        @write_socket, @read_socket = create_sockets()
+        connect_sockets()
+      end
+      super()
+    end
+
+    protected
+
+    # @return [Boolean] Whether every address of the hostname is a loopback
+    #   address
+    def loopback?
+      addresses = Addrinfo.getaddrinfo(@hostname, nil, nil, :STREAM)
+      addresses.all? {|address| address.ipv4_loopback? or address.ipv6_loopback? }
+    rescue SocketError
+      false
+    end
+
+    def create_addresses
+      @write_addr = nil
+      @read_addr = nil
+      if @local
+        @write_addr = Socket.pack_sockaddr_un(TcpipSocketStream.local_socket_path(@write_port)) if @write_port
+        @read_addr = Socket.pack_sockaddr_un(TcpipSocketStream.local_socket_path(@read_port)) if @read_port
+      else
+        begin
+          @write_addr = Socket.pack_sockaddr_in(@write_port, @hostname) if @write_port
+          @read_addr = Socket.pack_sockaddr_in(@read_port, @hostname) if @read_port
+        rescue => error
+          if error.message =~ /getaddrinfo/
+            raise "Invalid hostname: #{@hostname}"
+          else
+            raise error
+          end
         end
       end
+    end
 
+    # @return [Array<Socket|nil>] The write and read sockets
+    def create_sockets
       write_socket = nil
-      if @write_addr
-        write_socket = Socket.new(Socket::AF_INET, Socket::SOCK_STREAM, 0)
-        write_socket.setsockopt(Socket::IPPROTO_TCP, Socket::TCP_NODELAY, 1)
-      end
+      write_socket = create_socket() if @write_addr
 
       read_socket = nil
       if @read_addr
         if @write_port != @read_port
-          read_socket = Socket.new(Socket::AF_INET, Socket::SOCK_STREAM, 0)
-          read_socket.setsockopt(Socket::IPPROTO_TCP, Socket::TCP_NODELAY, 1)
+          read_socket = create_socket()
         else
           read_socket = write_socket
         end
       end
-
-      @connect_timeout = ConfigParser.handle_nil(connect_timeout)
-      @connect_timeout = @connect_timeout.to_f if @connect_timeout
-
-      super(write_socket, read_socket, write_timeout, read_timeout)
+      return write_socket, read_socket
     end
 
-    # Connect the socket(s)
-    def connect
+    def connect_sockets
       connect_nonblock(@write_socket, @write_addr) if @write_socket
       connect_nonblock(@read_socket, @read_addr) if @read_socket and @read_socket != @write_socket
-      super()
     end
 
-    protected
+    def create_socket
+      if @local
+        Socket.new(Socket::AF_UNIX, Socket::SOCK_STREAM, 0)
+      else
+        socket = Socket.new(Socket::AF_INET, Socket::SOCK_STREAM, 0)
+        socket.setsockopt(Socket::IPPROTO_TCP, Socket::TCP_NODELAY, 1)
+        socket
+      end
+    end
 
     def connect_nonblock(socket, addr)
       begin
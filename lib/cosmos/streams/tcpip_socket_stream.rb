@@ -11,6 +11,7 @@
 require 'socket'
 require 'thread' # For Mutex
 require 'timeout' # For Timeout::Error
+require 'tmpdir'
 require 'cosmos/streams/stream'
 require 'cosmos/config/config_parser'
 
@@ -19,9 +20,62 @@ module Cosmos
   # Data {Stream} which reads and writes from Tcpip Sockets.
   class TcpipSocketStream < Stream
     attr_reader :write_socket
+    attr_reader :read_socket
 
     FAST_READ = (RUBY_VERSION > "2.1")
 
+    # @return [String] Directory of the Unix domain sockets of local
+    #   {TcpipServer}s. It is in XDG_RUNTIME_DIR if set or the temporary
+    #   directory otherwise and is named after the user id.
+    def self.local_socket_dir
+      dir = ENV['XDG_RUNTIME_DIR']
+      dir = Dir.tmpdir if dir.nil? or dir.empty?
+      File.join(dir, "cosmos-#{Process.euid}")
+    end
+
+    # Create {.local_socket_dir} with access only for the current user
+    #
+    # @return [String] The directory
+    def self.create_local_socket_dir
+      dir = local_socket_dir
+      begin
+        Dir.mkdir(dir, 0700)
+      rescue Errno::EEXIST
+        # Checked below
+      end
+      unless local_socket_dir_private?
+        raise "Local socket directory #{dir} must be a directory owned by the current user with mode 0700"
+      end
+      dir
+    end
+
+    # @return [Boolean] Whether {.local_socket_dir} is a directory owned by
+    #   the current user which no other user can access
+    def self.local_socket_dir_private?
+      stat = File.lstat(local_socket_dir)
+      stat.directory? and stat.owned? and (stat.mode & 0077) == 0
+    rescue SystemCallError
+      false
+    end
+
+    # @param port [Integer] A server port
+    # @return [String] Path of the Unix domain socket a {TcpipServer} with
+    #   local_socket set listens on next to the port
+    def self.local_socket_path(port)
+      File.join(local_socket_dir, "#{port}.sock")
+    end
+
+    # @param port [Integer] A server port
+    # @return [Boolean] Whether a socket owned by the current user is at
+    #   {.local_socket_path} in a private {.local_socket_dir}
+    def self.local_socket?(port)
+      return false unless local_socket_dir_private?
+      stat = File.lstat(local_socket_path(port))
+      stat.socket? and stat.owned?
+    rescue SystemCallError
+      false
+    end
+
     # @param write_socket [Socket] Socket to write
     # @param read_socket [Socket] Socket to read
     # @param write_timeout [Float|nil] Number of seconds to wait for the write
@@ -172,6 +226,47 @@ module Cosmos
       end
     end
 
+    # @param segments [Array<String>] Binary strings to write to the socket in
+    #   order. Where supported they are sent with writev so they do not need
+    #   to be joined first.
+    def writev(segments)
+      raise "Attempt to write to read only stream" unless @write_socket
+      return write(segments.join) unless @write_socket.respond_to?(:writev_nonblock)
+
+      @write_mutex.synchronize do
+        segments = segments.dup
+        until segments.empty?
+          begin
+            bytes_sent = @write_socket.writev_nonblock(segments)
+          rescue Errno::EAGAIN, Errno::EWOULDBLOCK
+            # Wait for the socket to be ready for writing or for the timeout
+            if IO.fast_select(nil, [@write_socket], nil, @write_timeout)
+              retry
+            else
+              raise Timeout::Error, "Write Timeout"
+            end
+          end
+
+          # Remove the segments which were completely sent and trim a
+          # partially sent segment to the bytes remaining
+          until segments.empty?
+            segment = segments[0]
+            if bytes_sent >= segment.length
+              @raw_logger_pair.write_logger.write(segment) if @raw_logger_pair and segment.length > 0
+              bytes_sent -= segment.length
+              segments.shift
+            else
+              if bytes_sent > 0
+                @raw_logger_pair.write_logger.write(segment[0, bytes_sent]) if @raw_logger_pair
+                segments[0] = segment[bytes_sent..-1]
+              end
+              break
+            end
+          end
+        end
+      end
+    end
+
     # Connect the stream
     def connect
       # If called directly this class is acting as a server and does not need to connect the sockets
@@ -70,6 +70,20 @@ module Cosmos
       end
     end
 
+    # Responses are queued one at a time by the write so they are never
+    # batched
+    def read_batch(max_packets = 100)
+      packet = read()
+      return nil unless packet
+      [packet]
+    end
+
+    # The response expected by post_write_data is saved by pre_write_packet
+    # so each write must be encoded by its own protocol
+    def shared_encoding?
+      false
+    end
+
     # See StreamProtocol#pre_write_packet
     def pre_write_packet(packet)
       # First grab the response template and response packet (if there is one)
@@ -91,8 +105,9 @@ module Cosmos
       data = super(raw_packet)
       # Scan the template for variables in brackets <VARIABLE>
       # Read these values from the packet and substitute them in the template
+      # which is the first string ahead of the termination characters
       template.scan(/<(.*?)>/).each do |variable|
-        data.gsub!("<#{variable[0]}>", packet.read(variable[0], :RAW).to_s)
+        data[0].gsub!("<#{variable[0]}>", packet.read(variable[0], :RAW).to_s)
       end
       data
     end
@@ -10,6 +10,7 @@
 
 require 'cosmos/config/config_parser'
 require 'cosmos/streams/stream_protocol'
+require 'cosmos/streams/receive_buffer'
 
 module Cosmos
 
@@ -40,40 +41,25 @@ module Cosmos
       @strip_read_termination       = ConfigParser.handle_true_false(strip_read_termination)
 
       super(discard_leading_bytes, sync_pattern, fill_sync_pattern)
+
+      @framer = TerminatedFramer.new(@read_termination_characters,
+                                     @strip_read_termination,
+                                     @sync_pattern)
     end
 
-    # See StreamProtocol#pre_write_packet
+    # See StreamProtocol#pre_write_packet. Returns the packet data and the
+    # termination characters as separate strings so the packet buffer is
+    # neither modified nor copied.
     def pre_write_packet(packet)
       data = super(packet)
       raise "Packet contains termination characters!" if data.index(@write_termination_characters)
-
-      data = data.clone # Don't want to modify the actual packet buffer with the termination characters
-      @write_termination_characters.each_byte do |byte|
-        data << byte
-      end
-      data
+      [data, @write_termination_characters]
     end
 
     protected
 
     def reduce_to_single_packet
-      while true
-        index = @data.index(@read_termination_characters)
-
-        # Reduce to packet data and setup current_data for next packet
-        if index
-          if @strip_read_termination
-            packet_data = @data[0..(index - 1)]
-          else
-            packet_data = @data[0..(index + @read_termination_characters.length - 1)]
-          end
-          @data.replace(@data[(index + @read_termination_characters.length)..-1])
-          return packet_data
-        else
-          read_and_handle_timeout()
-          return nil if @data.length <= 0
-        end
-      end
+      reduce_with_framer(@framer)
     end
 
   end # class TerminatedStreamProtocol
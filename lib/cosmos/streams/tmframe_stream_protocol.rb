@@ -0,0 +1,86 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'cosmos/config/config_parser'
+require 'cosmos/streams/stream_protocol'
+require 'cosmos/streams/tm_frame_framer'
+
+module Cosmos
+
+  # This StreamProtocol reads fixed length CCSDS TM transfer frames and
+  # returns the CCSDS space packets they carry. Each virtual channel is
+  # demultiplexed natively: its frame count is checked for gaps, the first
+  # header pointer is followed to find the packets and a packet which spans
+  # frames is collected until its virtual channel completes it. Idle frames
+  # and idle packets are dropped.
+  #
+  # Packets are written to the stream without any framing.
+  class TmframeStreamProtocol < StreamProtocol
+
+    # @param frame_length [Integer] Length of each transfer frame in bytes not
+    #   including the sync pattern
+    # @param sync_pattern [String] Hexadecimal sync pattern which precedes
+    #   every frame such as '0x1ACFFC1D'. nil if the frames are not preceded
+    #   by a sync pattern.
+    # @param fecf [Boolean] Whether each frame ends with a frame error control
+    #   field. Frames whose FECF does not match are dropped and counted in
+    #   {#frame_stats}.
+    def initialize(frame_length,
+                   sync_pattern = '0x1ACFFC1D',
+                   fecf = false)
+      super(0, sync_pattern)
+      @frame_length = Integer(frame_length)
+      @framer = TmFrameFramer.new(@frame_length,
+                                  @sync_pattern,
+                                  ConfigParser.handle_true_false(fecf))
+    end
+
+    # Drops any packets which were being collected when the stream was
+    # disconnected
+    #
+    # @param stream (see StreamProtocol#connect)
+    def connect(stream)
+      super(stream)
+      @framer.reset
+    end
+
+    # @param vcid [Integer|nil] Virtual channel from 0 to 7 or nil for the
+    #   master channel
+    # @return [Hash] Frame statistics. The master channel has :frames,
+    #   :lost_frames and :fecf_errors. Virtual channels have :frames,
+    #   :lost_frames, :packets, :discarded (packets dropped because of lost
+    #   frames), :idle_frames and :in_progress_bytes.
+    def frame_stats(vcid = nil)
+      @framer.stats(vcid)
+    end
+
+    protected
+
+    def reduce_to_single_packet
+      while @frames.empty?
+        bytes_needed = @framer.frame(@data, @frames)
+        # The frames are part of the virtual channel state once framed so
+        # read_batch must not rewind them if no packet is complete
+        commit_batch_data()
+        if bytes_needed > 0
+          if @frames.empty?
+            read_minimum_size(bytes_needed)
+            return nil if @data.length <= 0
+          end
+        else
+          return nil unless handle_sync_pattern()
+        end
+      end
+      @frames.shift
+    end
+
+  end # class TmframeStreamProtocol
+
+end # module Cosmos
@@ -63,20 +63,28 @@ module Cosmos
         'subscribe_limits_events',
         'unsubscribe_limits_events',
         'get_limits_event',
+        'get_limits_event_batch',
         'subscribe_packet_data',
         'unsubscribe_packet_data',
         'get_packet_data',
+        'get_packet_data_batch',
+        'get_packet_data_queue_stats',
         'get_interface_names',
         'connect_interface',
         'disconnect_interface',
         'interface_state',
+        'get_interface_latency',
+        'set_latency_instrumentation',
+        'get_latency_instrumentation',
         'map_target_to_interface',
         'get_router_names',
         'connect_router',
         'disconnect_router',
         'router_state',
+        'get_router_info',
         'get_cmd_log_filename',
         'get_tlm_log_filename',
+        'get_shared_cvt_filename',
         'start_logging',
         'stop_logging',
         'start_cmd_log',
@@ -726,10 +734,16 @@ module Cosmos
       CmdTlmServer.get_limits_event(id, non_block)
     end
 
+    # @see CmdTlmServer.get_limits_event_batch
+    def get_limits_event_batch(id, max_events = CmdTlmServer::DEFAULT_BATCH_SIZE, timeout = nil)
+      CmdTlmServer.get_limits_event_batch(id, max_events, timeout)
+    end
+
     # @see CmdTlmServer.subscribe_packet_data
     def subscribe_packet_data(packets,
-                              queue_size = CmdTlmServer::DEFAULT_PACKET_DATA_QUEUE_SIZE)
-      CmdTlmServer.subscribe_packet_data(packets, queue_size)
+                              queue_size = CmdTlmServer::DEFAULT_PACKET_DATA_QUEUE_SIZE,
+                              overflow = CmdTlmServer::DEFAULT_PACKET_DATA_QUEUE_OVERFLOW)
+      CmdTlmServer.subscribe_packet_data(packets, queue_size, overflow)
     end
 
     # @see CmdTlmServer.unsubscribe_packet_data
@@ -742,6 +756,16 @@ module Cosmos
       CmdTlmServer.get_packet_data(id, non_block)
     end
 
+    # @see CmdTlmServer.get_packet_data_batch
+    def get_packet_data_batch(id, max_packets = CmdTlmServer::DEFAULT_BATCH_SIZE, timeout = nil)
+      CmdTlmServer.get_packet_data_batch(id, max_packets, timeout)
+    end
+
+    # @see CmdTlmServer.get_packet_data_queue_stats
+    def get_packet_data_queue_stats(id)
+      CmdTlmServer.get_packet_data_queue_stats(id)
+    end
+
     #
     # Methods for scripting
     #
@@ -788,6 +812,27 @@ module Cosmos
       nil
     end
 
+    # @param interface_name (see #connect_interface)
+    # @return [Array<Array<String, Numeric, ...>>] For each processing stage
+    #   the stage name, number of packets, and the minimum, mean, 50th, 90th
+    #   and 99th percentile and maximum time in microseconds from the packet
+    #   data being read until the packet completed the stage
+    def get_interface_latency(interface_name)
+      CmdTlmServer.interfaces.latency(interface_name)
+    end
+
+    # @param enabled [Boolean] Whether to record packet processing latency
+    #   for all interfaces
+    def set_latency_instrumentation(enabled)
+      LatencyStats.enabled = enabled
+      nil
+    end
+
+    # @return [Boolean] Whether packet processing latency is being recorded
+    def get_latency_instrumentation
+      LatencyStats.enabled
+    end
+
     # @return [Array<String>] All the router names
     def get_router_names
       CmdTlmServer.routers.names
@@ -819,6 +864,22 @@ module Cosmos
       CmdTlmServer.routers.state(router_name)
     end
 
+    # @param router_name (see #connect_router)
+    # @return [Array<String, Numeric, ...>] The state of the router followed
+    #   by the number of clients, write queue size, read queue size, bytes
+    #   written, bytes read, packets read, packets written, packets dropped
+    #   from the write queue and bytes written per second
+    def get_router_info(router_name)
+      CmdTlmServer.routers.info(router_name)
+    end
+
+    # @return [String or nil] The shared current value table filename or nil
+    #   if the server is not publishing a shared current value table
+    def get_shared_cvt_filename
+      shared_cvt = CmdTlmServer.shared_cvt
+      return shared_cvt ? shared_cvt.filename : nil
+    end
+
     # @param packet_log_writer_name [String] The name of the packet log writer which
     #   is writing the command packet log
     # @return [String] The command packet log filename
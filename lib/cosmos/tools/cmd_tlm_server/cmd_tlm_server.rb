@@ -16,6 +16,8 @@ require 'cosmos/tools/cmd_tlm_server/commanding'
 require 'cosmos/tools/cmd_tlm_server/interfaces'
 require 'cosmos/tools/cmd_tlm_server/packet_logging'
 require 'cosmos/tools/cmd_tlm_server/routers'
+require 'cosmos/utilities/ring_buffer_queue'
+require 'cosmos/packets/shared_cvt'
 
 module Cosmos
 
@@ -45,14 +47,16 @@ module Cosmos
     instance_attr_accessor :json_drb
     # @return [String] CmdTlmServer title as set in the config file
     instance_attr_accessor :title
+    # @return [SharedCvt] Shared current value table or nil if not enabled
+    instance_attr_reader :shared_cvt
 
     # attr_reader attributes are only used by CmdTlmServer internally and are
     # thus only available as attributes on the singleton
 
     # @return [Mutex] Synchronization object around limits events
     attr_reader :limits_event_queue_mutex
-    # @return [Hash<Integer, Array<Queue, Integer>>] The limits event queues
-    #   hashed by id. Returns an array containing the queue followed by the
+    # @return [Hash<Integer, Array<RingBufferQueue, Integer>>] The limits
+    #   event queues hashed by id. Returns an array containing the queue followed by the
     #   queue size.
     attr_reader :limits_event_queues
     # @return [Integer] The next limits event queue id when
@@ -61,10 +65,16 @@ module Cosmos
     attr_accessor :next_limits_event_queue_id
     # @return [Mutex] Synchronization object around packet data events
     attr_reader :packet_data_queue_mutex
-    # @return [Hash<Integer, Array<Queue, Integer>>] The packet data queues
-    #   hashed by id. Returns an array containing the queue followed by the
-    #   queue size.
+    # @return [Hash<Integer, Array<RingBufferQueue, Array, Integer>>] The
+    #   packet data queues hashed by id. Returns an array containing the queue
+    #   followed by the subscribed packets and the queue size.
     attr_reader :packet_data_queues
+    # @return [Hash<String, Hash<String, Array<Array<Integer, RingBufferQueue>>>>]
+    #   Index of the packet data queues hashed by target name and then packet
+    #   name. Each entry is a list of [id, queue]. This hash is
+    #   rebuilt (never modified in place) whenever a subscription changes so it
+    #   can be read by {#post_packet} without holding the mutex.
+    attr_reader :packet_data_subscriptions
     # @return [Integer] The next packet data queue id when
     #   subscribe_packet_data is called. This ID must be used in the
     #   packet_data_queues hash to access the queue.
@@ -80,6 +90,12 @@ module Cosmos
     # The maximum number of packets that are queued. Used when subscribing to
     # packet data.
     DEFAULT_PACKET_DATA_QUEUE_SIZE = 1000
+    # What happens when a packet data queue is full. See
+    # {RingBufferQueue::OVERFLOW_POLICIES}.
+    DEFAULT_PACKET_DATA_QUEUE_OVERFLOW = :DISCONNECT
+    # The maximum number of packets or limits events returned by a single
+    # call to get_packet_data_batch or get_limits_event_batch
+    DEFAULT_BATCH_SIZE = 100
 
     @@instance = nil
     @@meta_callback = nil
@@ -125,6 +141,7 @@ module Cosmos
 
       @packet_data_queue_mutex = Mutex.new
       @packet_data_queues = {}
+      @packet_data_subscriptions = {}
       @next_packet_data_queue_id = 1
 
       # Process cmd_tlm_server.txt
@@ -143,6 +160,7 @@ module Cosmos
       # Don't start the DRb service or the telemetry monitoring thread
       # if we started the server in disconnect mode
       @json_drb = nil
+      @shared_cvt = nil
       start(production) unless @disconnect
     end # end def initialize
 
@@ -186,6 +204,12 @@ module Cosmos
         raise FatalError.new("Error starting JsonDRb on port #{System.ports['CTS_API']}.\nPerhaps a Command and Telemetry Server is already running?")
       end
 
+      if @config.shared_cvt_filename
+        FileUtils.mkdir_p(File.dirname(@config.shared_cvt_filename))
+        @shared_cvt = SharedCvt.new(@config.shared_cvt_filename, System.telemetry, true)
+        Logger.info "Publishing current value table to #{@config.shared_cvt_filename}"
+      end
+
       @routers.add_preidentified('PREIDENTIFIED_ROUTER', System.instance.ports['CTS_PREIDENTIFIED'])
       System.telemetry.limits_change_callback = method(:limits_change_callback)
       @interfaces.start
@@ -225,6 +249,10 @@ module Cosmos
       @routers.stop
       @interfaces.stop
       @packet_logging.shutdown
+      if @shared_cvt
+        @shared_cvt.close
+        @shared_cvt = nil
+      end
       @stop_callback.call if @stop_callback
       @message_log.stop if @message_log
 
@@ -300,20 +328,16 @@ module Cosmos
           # Post event to active queues
           @limits_event_queues.each do |id, data|
             queue = data[0]
-            queue_size = data[1]
-            queue << [event_type, event_data]
-            if queue.length > queue_size
-              # Drop queue
-              queues_to_drop << id
-            end
+            # Drop queue if it is full
+            queues_to_drop << id unless queue.push([event_type, event_data])
           end
 
           # Drop queues which are not being serviced
           queues_to_drop.each do |id|
-            # Remove the queue to stop servicing it.  Nil is added to unblock any client threads
+            # Remove the queue to stop servicing it. Closing the queue unblocks any client threads
             # that might otherwise be left blocking forever for something on the queue
             queue, queue_size = @limits_event_queues.delete(id)
-            queue << nil if queue
+            queue.close if queue
           end
         end
       end
@@ -333,7 +357,7 @@ module Cosmos
       id = nil
       @@instance.limits_event_queue_mutex.synchronize do
         id = @@instance.next_limits_event_queue_id
-        @@instance.limits_event_queues[id] = [Queue.new, queue_size]
+        @@instance.limits_event_queues[id] = [RingBufferQueue.new(queue_size, :DISCONNECT), queue_size]
         @@instance.next_limits_event_queue_id += 1
       end
       return id
@@ -348,10 +372,10 @@ module Cosmos
     def self.unsubscribe_limits_events(id)
       queue = nil
       @@instance.limits_event_queue_mutex.synchronize do
-        # Remove the queue to stop servicing it.  Nil is added to unblock any client threads
+        # Remove the queue to stop servicing it. Closing the queue unblocks any client threads
         # that might otherwise be left blocking forever for something on the queue
         queue, queue_size = @@instance.limits_event_queues.delete(id)
-        queue << nil if queue
+        queue.close if queue
       end
     end
 
@@ -378,58 +402,101 @@ module Cosmos
       end
     end
 
+    # Get multiple limits events from the queue created by
+    # {#subscribe_limits_events}. Blocks until at least one event is available
+    # or the timeout expires.
+    #
+    # @param id [Integer] The queue ID received from calling
+    #   {#subscribe_limits_events}
+    # @param max_events [Integer] The maximum number of events to return
+    # @param timeout [Float|nil] The maximum time in seconds to wait for an
+    #   event. nil waits forever and 0 returns immediately.
+    # @return [Array<Array>|nil] Array of limits events in the same format as
+    #   {#get_limits_event}. The array is empty if the timeout expired.
+    def self.get_limits_event_batch(id, max_events = DEFAULT_BATCH_SIZE, timeout = nil)
+      queue = nil
+      @@instance.limits_event_queue_mutex.synchronize do
+        queue, _ = @@instance.limits_event_queues[id]
+      end
+      if queue
+        return queue.pop_batch(max_events, timeout)
+      else
+        raise "Limits event queue with id #{id} not found"
+      end
+    end
+
     # Post packet data to all subscribed packet data listeners.
     #
     # @param packet [Packet]
     def post_packet(packet)
-      if @packet_data_queues.length > 0
-        queues_to_drop = []
+      # Grab a reference to the current index. It is replaced rather than
+      # modified when subscriptions change so no locking is required here.
+      target_subscriptions = @packet_data_subscriptions[packet.target_name]
+      return unless target_subscriptions
+      subscriptions = target_subscriptions[packet.packet_name]
+      return unless subscriptions
+
+      queues_to_drop = nil
+      received_time = packet.received_time
+      received_time ||= Time.now
+      # All subscribers share a single frozen snapshot of the buffer
+      buffer = packet.buffer.freeze
+      subscriptions.each do |id, queue|
+        unless queue.push([buffer, packet.target_name, packet.packet_name,
+            received_time.tv_sec, received_time.tv_usec, packet.received_count])
+          queues_to_drop ||= []
+          queues_to_drop << id
+        end
+      end
 
+      if queues_to_drop
         @packet_data_queue_mutex.synchronize do
-          # Post event to active queues
-          @packet_data_queues.each do |id, data|
-            queue = data[0]
-            packets = data[1]
-            queue_size = data[2]
-
-            packets.each do |target_name, packet_name|
-              if packet.target_name == target_name and packet.packet_name == packet_name
-                received_time = packet.received_time
-                received_time ||= Time.now
-                queue << [packet.buffer, target_name, packet_name,
-                  received_time.tv_sec, received_time.tv_usec, packet.received_count]
-                if queue.length > queue_size
-                  # Drop queue
-                  queues_to_drop << id
-                end
-                break
-              end
-            end
-          end
-
           # Drop queues which are not being serviced
           queues_to_drop.each do |id|
-            # Remove the queue to stop servicing it.  Nil is added to unblock any client threads
+            # Remove the queue to stop servicing it. Closing the queue unblocks any client threads
             # that might otherwise be left blocking forever for something on the queue
             queue, packets, queue_size = @packet_data_queues.delete(id)
-            queue << nil if queue
+            queue.close if queue
           end
+          update_packet_data_subscriptions()
         end
       end
     end
 
+    # Rebuild the packet data subscription index from the packet data queues.
+    # Must be called with the packet_data_queue_mutex held.
+    def update_packet_data_subscriptions
+      subscriptions = {}
+      @packet_data_queues.each do |id, data|
+        queue, packets, queue_size = data
+        packets.each do |target_name, packet_name|
+          target_subscriptions = (subscriptions[target_name] ||= {})
+          packet_subscriptions = (target_subscriptions[packet_name] ||= [])
+          # Only post once to a queue which subscribed to a packet twice
+          next if packet_subscriptions.find {|packet_id, _| packet_id == id }
+          packet_subscriptions << [id, queue]
+        end
+      end
+      @packet_data_subscriptions = subscriptions
+    end
+
     # Subscribe to one or more telemetry packets.
     #
     # @param packets [Array<Array<String,String>>] List of packets where the
     #   Strings are target name, packet name.
     # @param queue_size [Integer] The size of the queue to store packet data
+    # @param overflow [Symbol] What to do when the queue is full. :DROP_OLDEST
+    #   discards the oldest packet, :DROP_NEWEST discards the received packet
+    #   and :DISCONNECT deletes the queue.
     # @return [Integer] The queue ID returned from CmdTlmServer. Use this ID
     #   when calling {#get_packet_data} and {#unsubscribe_packet_data}.
     def self.subscribe_packet_data(packets,
-                                   queue_size = CmdTlmServer::DEFAULT_PACKET_DATA_QUEUE_SIZE)
+                                   queue_size = CmdTlmServer::DEFAULT_PACKET_DATA_QUEUE_SIZE,
+                                   overflow = CmdTlmServer::DEFAULT_PACKET_DATA_QUEUE_OVERFLOW)
       if !packets.is_a?(Array) || !packets[0].is_a?(Array)
         raise ArgumentError, "packets must be nested array: [['TGT','PKT'],...]"
       end
+      queue = RingBufferQueue.new(queue_size, overflow)
 
       id = nil
       upcase_packets = []
@@ -446,8 +513,9 @@ module Cosmos
       @@instance.packet_data_queue_mutex.synchronize do
         id = @@instance.next_packet_data_queue_id
         @@instance.packet_data_queues[id] =
-          [Queue.new, upcase_packets, queue_size]
+          [queue, upcase_packets, queue_size]
         @@instance.next_packet_data_queue_id += 1
+        @@instance.update_packet_data_subscriptions
       end
       return id
     end
@@ -458,10 +526,11 @@ module Cosmos
     #   {#subscribe_packet_data}.
     def self.unsubscribe_packet_data(id)
       @@instance.packet_data_queue_mutex.synchronize do
-        # Remove the queue to stop servicing it.  Nil is added to unblock any client threads
+        # Remove the queue to stop servicing it. Closing the queue unblocks any client threads
         # that might otherwise be left blocking forever for something on the queue
         queue, packets, queue_size = @@instance.packet_data_queues.delete(id)
-        queue << nil if queue
+        queue.close if queue
+        @@instance.update_packet_data_subscriptions
       end
       return nil
     end
@@ -489,6 +558,47 @@ module Cosmos
       end
     end
 
+    # Get multiple packets from the queue created by {#subscribe_packet_data}.
+    # Blocks until at least one packet is available or the timeout expires.
+    #
+    # @param id [Integer] The queue ID received from calling
+    #   {#subscribe_packet_data}
+    # @param max_packets [Integer] The maximum number of packets to return
+    # @param timeout [Float|nil] The maximum time in seconds to wait for a
+    #   packet. nil waits forever and 0 returns immediately.
+    # @return [Array<Array>|nil] Array of packet data in the same format as
+    #   {#get_packet_data}. The array is empty if the timeout expired.
+    def self.get_packet_data_batch(id, max_packets = DEFAULT_BATCH_SIZE, timeout = nil)
+      queue = nil
+      @@instance.packet_data_queue_mutex.synchronize do
+        queue, _, _ = @@instance.packet_data_queues[id]
+      end
+      if queue
+        return queue.pop_batch(max_packets, timeout)
+      else
+        raise "Packet data queue with id #{id} not found"
+      end
+    end
+
+    # Get the status of a queue created by {#subscribe_packet_data}.
+    #
+    # @param id [Integer] The queue ID received from calling
+    #   {#subscribe_packet_data}
+    # @return [Array<Integer, Integer, Symbol, Integer>] The number of packets
+    #   in the queue, the queue size, the overflow policy and the number of
+    #   packets dropped because the queue was full
+    def self.get_packet_data_queue_stats(id)
+      queue = nil
+      @@instance.packet_data_queue_mutex.synchronize do
+        queue, _, _ = @@instance.packet_data_queues[id]
+      end
+      if queue
+        return [queue.length, queue.capacity, queue.overflow, queue.dropped_count]
+      else
+        raise "Packet data queue with id #{id} not found"
+      end
+    end
+
     # Calls clear_counters on the System, interfaces, routers, and sets the
     # request_count on json_drb to 0.
     def self.clear_counters
@@ -507,6 +617,11 @@ module Cosmos
     # @param packet [Packet] Packet which has been identified by the interface
     def identified_packet_callback(packet)
       packet.check_limits(System.limits_set)
+      if LatencyStats.enabled
+        latency_stats = LatencyStats.current
+        latency_stats.stamp(LatencyStats::LIMITS) if latency_stats
+      end
+      @shared_cvt.write(packet) if @shared_cvt
       post_packet(packet)
     end
 
@@ -11,8 +11,10 @@
 require 'cosmos/config/config_parser'
 require 'cosmos/interfaces'
 require 'cosmos/tools/cmd_tlm_server/interface_thread'
+require 'cosmos/tools/cmd_tlm_server/interface_worker'
 require 'cosmos/packet_logs'
 require 'cosmos/io/raw_logger_pair'
+require 'cosmos/utilities/ring_buffer_queue'
 
 module Cosmos
 
@@ -34,6 +36,8 @@ module Cosmos
     attr_accessor :meta_target_name
     # @return [String or nil] Meta Packet Name
     attr_accessor :meta_packet_name
+    # @return [String or nil] Shared current value table filename
+    attr_accessor :shared_cvt_filename
 
     # Create a default pair of packet log writers and parses the
     # configuration file.
@@ -50,6 +54,7 @@ module Cosmos
       @title = nil
       @meta_target_name = nil
       @meta_packet_name = nil
+      @shared_cvt_filename = nil
       process_file(filename)
     end
 
@@ -146,7 +151,7 @@ module Cosmos
             current_interface_or_router.name = interface_name
             @interfaces[interface_name] = current_interface_or_router
 
-          when 'LOG', 'DONT_LOG', 'TARGET'
+          when 'LOG', 'DONT_LOG', 'TARGET', 'WORKER_PROCESS'
             raise parser.error("No current interface for #{keyword}") unless current_interface_or_router and current_type == :INTERFACE
 
             case keyword
@@ -174,6 +179,11 @@ module Cosmos
                 raise parser.error("Unknown target #{target_name} mapped to interface #{current_interface_or_router.name}")
               end
 
+            when 'WORKER_PROCESS'
+              parser.verify_num_parameters(0, 0, "#{keyword}")
+              raise parser.error("#{keyword} is not supported on this platform") unless InterfaceWorker.supported?
+              current_interface_or_router.worker_process = true
+
             end # end case keyword for all keywords that require a current interface
 
           when 'DONT_CONNECT', 'DONT_RECONNECT', 'RECONNECT_DELAY', 'DISABLE_DISCONNECT', 'LOG_RAW', 'ROUTER_LOG_RAW', 'OPTION'
@@ -223,6 +233,17 @@ module Cosmos
             current_interface_or_router.name = router_name
             @routers[router_name] = current_interface_or_router
 
+          when 'WRITE_QUEUE'
+            raise parser.error("No current router for #{keyword}") unless current_interface_or_router and current_type == :ROUTER
+            usage = "#{keyword} <Max Packets (0 = synchronous writes)> <Overflow Policy (DROP_OLDEST, DROP_NEWEST, DISCONNECT)>"
+            parser.verify_num_parameters(1, 2, usage)
+            current_interface_or_router.async_write_queue_depth = Integer(params[0])
+            if params[1]
+              overflow = params[1].upcase.intern
+              raise parser.error("Unknown overflow policy: #{params[1]}", usage) unless RingBufferQueue::OVERFLOW_POLICIES.include?(overflow)
+              current_interface_or_router.async_write_queue_overflow = overflow
+            end
+
           when 'ROUTE'
             raise parser.error("No current router for #{keyword}") unless current_interface_or_router and current_type == :ROUTER
             usage = "ROUTE <Interface Name>"
@@ -252,6 +273,15 @@ module Cosmos
             @meta_target_name = params[0]
             @meta_packet_name = params[1]
 
+          when 'SHARED_CVT'
+            raise parser.error("#{keyword} not allowed in target #{filename}") if recursive
+            parser.verify_num_parameters(0, 1, "#{keyword} <Filename (defaults to outputs/tmp/shared_cvt.bin)>")
+            if params[0]
+              @shared_cvt_filename = File.expand_path(params[0])
+            else
+              @shared_cvt_filename = File.join(System.paths['TMP'], 'shared_cvt.bin')
+            end
+
           else
             # blank lines will have a nil keyword and should not raise an exception
             raise parser.error("Unknown keyword: #{keyword}") unless keyword.nil?
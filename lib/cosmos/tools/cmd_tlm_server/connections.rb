@@ -118,6 +118,7 @@ module Cosmos
         connection.bytes_read = 0
         connection.write_count = 0
         connection.read_count = 0
+        connection.latency_stats.clear if connection.latency_stats
       end
     end
 
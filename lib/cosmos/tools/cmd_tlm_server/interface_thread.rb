@@ -8,11 +8,14 @@
 # as published by the Free Software Foundation; version 3 with
 # attribution addendums as found in the LICENSE.txt
 
+require 'cosmos/utilities/latency_stats'
+
 module Cosmos
 
   # Encapsulates an {Interface} in a Ruby thread. When the thread is started by
   # the {#start} method, it loops trying to connect. It then continously reads
-  # from the interface while handling the packets it receives.
+  # batches of packets from the interface while handling the packets it
+  # receives.
   class InterfaceThread
     # The number of bytes to print when an UNKNOWN packet is received
     UNKNOWN_BYTES_TO_PRINT = 36
@@ -37,6 +40,7 @@ module Cosmos
     def initialize(interface)
       @interface = interface
       @interface.thread = self
+      @interface.latency_stats ||= LatencyStats.new
       @connection_success_callback = nil
       @connection_failed_callback = nil
       @connection_lost_callback = nil
@@ -51,11 +55,13 @@ module Cosmos
 
     # Create and start the Ruby thread that will encapsulate the interface.
     # Creates a while loop that waits for {Interface#connect} to succeed. Then
-    # calls {Interface#read} and handles all the incoming packets.
+    # calls {Interface#read_batch} and handles all the incoming packets.
     def start
       @thread_sleeper = Sleeper.new
       @thread = Thread.new do
         @cancel_thread = false
+        # Allows the identified packet callback to record latency stages
+        LatencyStats.current = @interface.latency_stats
         begin
           Logger.info "Starting packet reading for #{@interface.name}"
           while true
@@ -78,8 +84,8 @@ module Cosmos
             end
 
             begin
-              packet = @interface.read
-              unless packet
+              packets = @interface.read_batch
+              unless packets
                 Logger.info "Clean disconnect from #{@interface.name} (returned nil)"
                 handle_connection_lost(nil)
                 if @cancel_thread
@@ -88,7 +94,6 @@ module Cosmos
                   next
                 end
               end
-              packet.received_time = Time.now unless packet.received_time
             rescue Exception => err
               handle_connection_lost(err)
               if @cancel_thread
@@ -98,7 +103,12 @@ module Cosmos
               end
             end
 
-            handle_packet(packet)
+            # Packets read together arrived together
+            received_time = nil
+            packets.each do |packet|
+              packet.received_time = (received_time ||= Time.now) unless packet.received_time
+              handle_packet(packet)
+            end
           end  # loop
         rescue Exception => error
           if @fatal_exception_callback
@@ -131,6 +141,13 @@ module Cosmos
     protected
 
     def handle_packet(packet)
+      if LatencyStats.enabled
+        latency_stats = @interface.latency_stats
+        latency_stats.start
+      else
+        latency_stats = nil
+      end
+
       # Identify and update packet
       if packet.identified?
         begin
@@ -174,22 +191,39 @@ module Cosmos
       target = System.targets[packet.target_name]
       target.tlm_cnt += 1 if target
       packet.received_count += 1
+      latency_stats.stamp(LatencyStats::IDENTIFY) if latency_stats
       @identified_packet_callback.call(packet) if @identified_packet_callback
+      latency_stats.stamp(LatencyStats::POST) if latency_stats
 
       # Write to routers
+      router_packet = nil
       @interface.routers.each do |router|
         begin
-          router.write(packet) if router.write_allowed? and router.connected?
+          if router.write_allowed? and router.connected?
+            if router.async_writer
+              # Routers with a write thread share one copy of the packet since
+              # the current value table packet changes as packets are received
+              router_packet ||= packet.clone
+              router.async_writer.write(router_packet)
+            else
+              router.write(packet)
+            end
+          end
         rescue => err
           Logger.error "Problem writing to router #{router.name} - #{err.class}:#{err.message}"
         end
       end
+      latency_stats.stamp(LatencyStats::ROUTE) if latency_stats
 
       # Write to packet log writers
       @interface.packet_log_writer_pairs.each do |packet_log_writer_pair|
         # Write errors are handled by the log writer
         packet_log_writer_pair.tlm_log_writer.write(packet)
       end
+      if latency_stats
+        latency_stats.stamp(LatencyStats::LOG)
+        latency_stats.finish
+      end
     end
 
     def handle_connection_failed(connect_error)
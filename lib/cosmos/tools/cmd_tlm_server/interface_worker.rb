@@ -0,0 +1,228 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'socket'
+require 'cosmos/streams/tcpip_socket_stream'
+require 'cosmos/streams/preidentified_stream_protocol'
+
+module Cosmos
+
+  # Runs an {Interface} in a forked worker process so reading the stream,
+  # framing packets and identifying them do not compete with the rest of the
+  # Command and Telemetry Server for the Ruby interpreter lock. The
+  # interface object is extended with this module in the server process. Its
+  # connect method forks the worker which calls the original interface
+  # methods. Identified telemetry packets are sent from the worker to the
+  # server, and commands from the server to the worker, in the COSMOS
+  # preidentified format over a Unix domain socket pair. The server still
+  # updates the current value table, checks limits, logs and routes every
+  # packet so the rest of the server is unaware of the worker.
+  #
+  # Worker processes are only supported on platforms which implement fork.
+  module InterfaceWorker
+    # Target name used for status messages sent between the processes
+    WORKER_TARGET_NAME = 'WORKER'
+
+    # @return [Boolean] Whether the current platform supports worker
+    #   processes
+    def self.supported?
+      Process.respond_to?(:fork)
+    end
+
+    # @return [Integer|nil] The process id of the worker process or nil if
+    #   the worker is not running
+    attr_reader :worker_pid
+
+    # Fork the worker process and wait for it to connect the interface
+    def connect
+      return super() if @worker_child
+
+      server_socket, worker_socket = UNIXSocket.pair
+      @worker_pid = Process.fork do
+        @worker_child = true
+        @raw_logger_pair.reset_after_fork if @raw_logger_pair
+        server_socket.close
+        run_worker(worker_socket)
+      end
+      worker_socket.close
+
+      @worker_protocol = PreidentifiedStreamProtocol.new
+      @worker_protocol.connect(TcpipSocketStream.new(server_socket, server_socket, nil, nil))
+      status = @worker_protocol.read
+      unless status and status.target_name == WORKER_TARGET_NAME and status.packet_name == 'CONNECTED'
+        message = status ? status.buffer : 'Worker process exited'
+        stop_worker()
+        raise "#{@name} worker process failed to connect: #{message}"
+      end
+      Logger.info "#{@name} connected in worker process #{@worker_pid}"
+    end
+
+    # @return [Boolean] Whether the worker process is connected
+    def connected?
+      return super() if @worker_child
+      @worker_protocol ? @worker_protocol.connected? : false
+    end
+
+    # Disconnect the interface by stopping the worker process
+    def disconnect
+      return super() if @worker_child
+      stop_worker()
+    end
+
+    # @return [Packet|nil] The next packet identified by the worker process or
+    #   nil if the worker process has disconnected
+    def read
+      return super() if @worker_child
+      protocol = @worker_protocol
+      return nil unless protocol
+      packet = protocol.read
+      return nil unless packet
+      if packet.target_name == WORKER_TARGET_NAME
+        raise "#{@name} worker process error: #{packet.buffer}"
+      end
+      # The worker marks packets it could not identify as UNKNOWN so they are
+      # identified again here and reported by the InterfaceThread
+      if packet.target_name == 'UNKNOWN'
+        packet.target_name = nil
+        packet.packet_name = nil
+      end
+      @read_count += 1
+      self.bytes_read = self.bytes_read + packet.length
+      packet
+    end
+
+    # Send a command to the worker process to be written to the interface
+    #
+    # @param packet [Packet] The command packet
+    def write(packet)
+      return super(packet) if @worker_child
+      raise "Interface not connected for write : #{@name}" unless connected?
+      @worker_protocol.write(packet)
+      @write_count += 1
+      self.bytes_written = self.bytes_written + packet.length
+    end
+
+    # Send raw data to the worker process to be written to the interface
+    #
+    # @param data [String] Raw binary string
+    def write_raw(data)
+      return super(data) if @worker_child
+      raise "Interface not connected for write_raw : #{@name}" unless connected?
+      @worker_protocol.write(Packet.new(WORKER_TARGET_NAME, 'RAW', :BIG_ENDIAN, nil, data))
+      @write_count += 1
+      self.bytes_written = self.bytes_written + data.length
+    end
+
+    protected
+
+    def stop_worker
+      protocol = @worker_protocol
+      @worker_protocol = nil
+      protocol.disconnect if protocol
+      pid = @worker_pid
+      @worker_pid = nil
+      if pid
+        begin
+          Process.kill('TERM', pid)
+          Process.wait(pid)
+        rescue Errno::ESRCH, Errno::ECHILD
+          # Worker already exited
+        end
+      end
+    end
+
+    # Body of the worker process. Never returns.
+    def run_worker(socket)
+      protocol = PreidentifiedStreamProtocol.new
+      protocol.connect(TcpipSocketStream.new(socket, socket, nil, nil))
+      command_thread = nil
+      begin
+        connect()
+        # Empty packets are discarded by the stream protocol so send the pid
+        send_worker_status(protocol, 'CONNECTED', Process.pid.to_s)
+        command_thread = Thread.new do
+          run_worker_commands(protocol)
+          # The server process closed the socket or a write failed
+          Process.kill('TERM', Process.pid)
+        end
+        while true
+          packet = read()
+          break unless packet
+          packet.received_time = Time.now unless packet.received_time
+          protocol.write(identify_worker_packet(packet))
+        end
+      rescue Exception => err
+        send_worker_status(protocol, 'ERROR', "#{err.class}:#{err.message}")
+      end
+    ensure
+      command_thread.kill if command_thread
+      begin
+        disconnect()
+      rescue Exception
+        # Exiting anyway
+      end
+      begin
+        # Write the raw data buffered for the writer threads
+        @raw_logger_pair.stop if @raw_logger_pair
+      rescue Exception
+        # Exiting anyway
+      end
+      # Skip at_exit handlers inherited from the server process
+      exit!(0)
+    end
+
+    # Write commands received from the server process until it disconnects
+    def run_worker_commands(protocol)
+      while true
+        packet = protocol.read
+        break unless packet
+        if packet.target_name == WORKER_TARGET_NAME
+          write_raw(packet.buffer(false))
+        else
+          command = System.commands.packet(packet.target_name, packet.packet_name).clone
+          command.buffer = packet.buffer(false)
+          write(command)
+        end
+      end
+    rescue Exception => err
+      send_worker_status(protocol, 'ERROR', "#{err.class}:#{err.message}")
+    end
+
+    # Identify a packet using the worker's copy of the telemetry definitions
+    def identify_worker_packet(packet)
+      if packet.identified?
+        begin
+          identified_packet = System.telemetry.update!(packet.target_name, packet.packet_name, packet.buffer)
+        rescue RuntimeError
+          identified_packet = System.telemetry.identify!(packet.buffer, @target_names)
+        end
+      else
+        identified_packet = System.telemetry.identify!(packet.buffer, @target_names)
+      end
+      if identified_packet
+        identified_packet.received_time = packet.received_time
+        return identified_packet
+      else
+        # Sent as UNKNOWN and reported by the server
+        packet.target_name = nil
+        packet.packet_name = nil
+        return packet
+      end
+    end
+
+    def send_worker_status(protocol, status, message)
+      protocol.write(Packet.new(WORKER_TARGET_NAME, status, :BIG_ENDIAN, nil, message))
+    rescue Exception
+      # The server process has disconnected
+    end
+
+  end # module InterfaceWorker
+
+end # module Cosmos
@@ -67,6 +67,16 @@ module Cosmos
       System.targets[target_name.upcase].interface = new_interface
     end
 
+    # @param interface_name [String] Name of the interface
+    # @return [Array<Array<String, Numeric, ...>>] The packet processing
+    #   latency of the interface. See {LatencyStats#summary}.
+    def latency(interface_name)
+      interface = @config.interfaces[interface_name.upcase]
+      raise "Unknown interface: #{interface_name}" unless interface
+      return [] unless interface.latency_stats
+      return interface.latency_stats.summary
+    end
+
     # Recreate an interface with new initialization parameters
     #
     # @param interface_name [String] Name of the interface
@@ -107,6 +117,8 @@ module Cosmos
     # Start an interface's packet reading thread
     def start_thread(interface)
       Logger.info "Creating thread for interface #{interface.name}"
+      # The thread reads packets identified by the worker process
+      interface.extend(InterfaceWorker) if interface.worker_process and !interface.is_a?(InterfaceWorker)
       interface_thread = InterfaceThread.new(interface)
       interface_thread.identified_packet_callback = @identified_packet_callback
       interface_thread.start
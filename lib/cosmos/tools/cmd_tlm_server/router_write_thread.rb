@@ -0,0 +1,117 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'cosmos/utilities/ring_buffer_queue'
+
+module Cosmos
+
+  # Writes telemetry packets to a router from a dedicated Ruby thread so a
+  # slow router does not block the {InterfaceThread} which received the
+  # packets. Packets are buffered in a bounded {RingBufferQueue} and the
+  # router's overflow policy determines what happens when the queue is full.
+  class RouterWriteThread
+    # Maximum number of packets written per pass of the write loop
+    PACKETS_PER_WRITE = 100
+
+    # @return [Integer] Number of bytes per second written to the router
+    #   measured over the last second
+    attr_reader :bytes_per_second
+
+    # @param router [Interface] The router to write packets to
+    def initialize(router)
+      @router = router
+      @queue = RingBufferQueue.new(router.async_write_queue_depth, router.async_write_queue_overflow)
+      @disconnect_requested = false
+      @bytes_per_second = 0
+      @thread = nil
+    end
+
+    # Start the Ruby thread which writes packets to the router
+    def start
+      @rate_time = Time.now
+      @rate_bytes = @router.bytes_written
+      @thread = Thread.new do
+        begin
+          while true
+            packets = @queue.pop_batch(PACKETS_PER_WRITE, 1.0)
+            break unless packets
+            handle_disconnect_request() if @disconnect_requested
+            begin
+              @router.write_batch(packets) if @router.write_allowed? and @router.connected?
+            rescue => err
+              Logger.error "Problem writing to router #{@router.name} - #{err.class}:#{err.message}"
+            end
+            update_rate()
+          end
+        rescue Exception => error
+          Logger.error "Router write thread unexpectedly died for #{@router.name}"
+          Cosmos.handle_fatal_exception(error)
+        end
+      end
+    end
+
+    # Stop the write thread. Any queued packets are discarded.
+    def stop
+      @queue.close
+      @queue.clear
+      Cosmos.kill_thread(self, @thread) if @thread and @thread != Thread.current
+      @thread = nil
+    end
+
+    def graceful_kill
+      # Closing the queue in stop causes the thread to exit
+    end
+
+    # Queue a packet to be written to the router. The packet must not be
+    # modified after it is queued.
+    #
+    # @param packet [Packet] Packet to write
+    def write(packet)
+      unless @queue.push(packet)
+        @disconnect_requested = true
+      end
+    end
+
+    # @return [Integer] The number of packets waiting to be written
+    def queue_size
+      @queue.length
+    end
+
+    # @return [Integer] The number of packets dropped because the queue was
+    #   full
+    def dropped_count
+      @queue.dropped_count
+    end
+
+    protected
+
+    def handle_disconnect_request
+      @disconnect_requested = false
+      @queue.clear
+      Logger.warn "Router #{@router.name} write queue overflowed #{@queue.capacity} packets. Disconnecting."
+      # The RouterThread reconnects the router if it is set to auto reconnect
+      @router.disconnect
+    end
+
+    def update_rate
+      now = Time.now
+      elapsed = now - @rate_time
+      if elapsed >= 1.0
+        bytes = @router.bytes_written
+        # The counters can be cleared while running
+        @bytes_per_second = (bytes >= @rate_bytes) ? ((bytes - @rate_bytes) / elapsed).round : 0
+        @rate_bytes = bytes
+        @rate_time = now
+      end
+    end
+
+  end # class RouterWriteThread
+
+end # module Cosmos
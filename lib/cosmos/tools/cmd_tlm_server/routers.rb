@@ -10,6 +10,7 @@
 
 require 'cosmos/tools/cmd_tlm_server/connections'
 require 'cosmos/tools/cmd_tlm_server/router_thread'
+require 'cosmos/tools/cmd_tlm_server/router_write_thread'
 require 'cosmos/interfaces/tcpip_server_interface'
 
 module Cosmos
@@ -73,17 +74,50 @@ module Cosmos
       return new_router
     end
 
+    # Get information about a router
+    #
+    # @param router_name [String] Name of the router
+    # @return [Array<String, Numeric, ...>] State, number of clients, number
+    #   of packets waiting to be written, number of packets waiting to be read,
+    #   bytes written, bytes read, packets read, packets written, packets
+    #   dropped from the write queue, and bytes written per second
+    def info(router_name)
+      router = @config.routers[router_name.upcase]
+      raise "Unknown router: #{router_name}" unless router
+
+      write_queue_size = router.write_queue_size
+      dropped_count = 0
+      bytes_per_second = 0
+      if router.async_writer
+        write_queue_size += router.async_writer.queue_size
+        dropped_count = router.async_writer.dropped_count
+        bytes_per_second = router.async_writer.bytes_per_second
+      end
+      return [state(router_name), router.num_clients, write_queue_size,
+        router.read_queue_size, router.bytes_written, router.bytes_read,
+        router.read_count, router.write_count, dropped_count, bytes_per_second]
+    end
+
     protected
 
-    # Start an router's packet reading thread
+    # Start an router's packet reading thread and packet writing thread
     def start_thread(router)
       Logger.info "Creating thread for router #{router.name}"
       router_thread = RouterThread.new(router)
       router_thread.start
+      if router.async_write_queue_depth > 0
+        router.async_writer = RouterWriteThread.new(router)
+        router.async_writer.start
+      end
     end
 
-    # Stop an router's packet reading thread
+    # Stop an router's packet reading thread and packet writing thread
     def stop_thread(router)
+      if router.async_writer
+        to_stop = router.async_writer
+        router.async_writer = nil
+        to_stop.stop
+      end
       if router.thread
         Logger.info "Killing thread for router #{router.name}"
         to_stop = router.thread
@@ -20,6 +20,7 @@ module Cosmos
     # Create a new TabbedPlotsRealtimeThread
     def initialize(tabbed_plots_config, connection_success_callback = nil, connection_failed_callback = nil, connection_lost_callback = nil, fatal_exception_callback = nil)
       interface = TcpipClientInterface.new('localhost', nil, System.ports['CTS_PREIDENTIFIED'], nil, 10.0, 'PREIDENTIFIED')
+      interface.set_option('LOCAL_SOCKET', ['TRUE'])
       super(interface)
 
       @queue = Queue.new
@@ -6,6 +6,7 @@ require 'cosmos/utilities/logger'
 require 'cosmos/utilities/low_fragmentation_array'
 require 'cosmos/utilities/message_log'
 require 'cosmos/utilities/quaternion'
+require 'cosmos/utilities/ring_buffer_queue'
 require 'cosmos/utilities/ruby_lex_utils'
 require 'cosmos/utilities/simulated_target'
 require 'cosmos/utilities/sleeper'
@@ -55,13 +55,18 @@ module Cosmos
       end
     end
 
-    # @!method calc(data, seed = nil)
+    # @!method calc(data, seed = nil, offset = 0, length = nil)
     #   Calculates the CRC across the data buffer using the optional seed.
     #   Implemented in C for speed.
     #
     #   @param data [String] String buffer of binary data to calculate a CRC on
     #   @param seed [Integer|nil] Seed value to start the calculation. Pass nil
     #     to use the default seed set in the constructor.
+    #   @param offset [Integer|nil] Byte offset in the data to start the
+    #     calculation at. This avoids copying part of a buffer to calculate
+    #     its CRC.
+    #   @param length [Integer|nil] Number of bytes to calculate the CRC over.
+    #     Pass nil to calculate to the end of the data.
     #   @return [Integer] The CRC value
 
     protected
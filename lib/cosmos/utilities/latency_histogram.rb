@@ -0,0 +1,114 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+module Cosmos
+
+  # Histogram of latencies in nanoseconds using log-linear buckets similar to
+  # an HDR histogram. Values below {SUB_BUCKET_COUNT} nanoseconds are
+  # recorded exactly. Larger values are recorded in {SUB_BUCKET_COUNT}
+  # linear buckets per power of two so every value is within about 3% of the
+  # value reported. Recording a value only updates preallocated counters so
+  # it does not allocate any objects.
+  class LatencyHistogram
+    # Number of bits of precision kept for each value
+    SUB_BUCKET_BITS = 5
+    # Number of linear buckets per power of two
+    SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS
+    # Largest value in bits. Larger values are recorded in the last bucket.
+    # 2**40 nanoseconds is about 18 minutes.
+    MAX_VALUE_BITS = 40
+    # Total number of buckets
+    BUCKET_COUNT = SUB_BUCKET_COUNT * (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1)
+
+    # @return [Integer] Number of values recorded
+    attr_reader :count
+    # @return [Integer] Smallest value recorded in nanoseconds or 0 if no
+    #   values have been recorded
+    attr_reader :min
+    # @return [Integer] Largest value recorded in nanoseconds
+    attr_reader :max
+    # @return [Integer] Sum of the values recorded in nanoseconds
+    attr_reader :total
+
+    def initialize
+      @buckets = Array.new(BUCKET_COUNT, 0)
+      clear()
+    end
+
+    # Record a latency
+    #
+    # @param value [Integer] Latency in nanoseconds. Negative values are
+    #   recorded as 0.
+    def record(value)
+      value = 0 if value < 0
+      if value < SUB_BUCKET_COUNT
+        index = value
+      else
+        shift = value.bit_length - SUB_BUCKET_BITS - 1
+        index = SUB_BUCKET_COUNT * (shift + 1) + (value >> shift) - SUB_BUCKET_COUNT
+        index = BUCKET_COUNT - 1 if index >= BUCKET_COUNT
+      end
+      @buckets[index] += 1
+      @count += 1
+      @total += value
+      @min = value if @count == 1 or value < @min
+      @max = value if value > @max
+    end
+
+    # @return [Float] Mean of the values recorded in nanoseconds
+    def mean
+      return 0.0 if @count == 0
+      @total.to_f / @count
+    end
+
+    # @param percentile [Numeric] Percentile from 0 to 100
+    # @return [Integer] The value in nanoseconds at the given percentile
+    #   rounded down to the precision of the bucket holding it
+    def percentile(percentile)
+      return 0 if @count == 0
+      target = ((percentile.to_f / 100.0) * @count).ceil
+      target = 1 if target < 1
+      seen = 0
+      @buckets.each_with_index do |bucket_count, index|
+        seen += bucket_count
+        if seen >= target
+          # The last bucket also holds every value larger than it
+          return @max if index == BUCKET_COUNT - 1
+          value = bucket_value(index)
+          value = @min if value < @min
+          value = @max if value > @max
+          return value
+        end
+      end
+      return @max
+    end
+
+    # Remove all the recorded values
+    def clear
+      @buckets.fill(0)
+      @count = 0
+      @total = 0
+      @min = 0
+      @max = 0
+    end
+
+    protected
+
+    # @return [Integer] The smallest value recorded in the bucket
+    def bucket_value(index)
+      return index if index < SUB_BUCKET_COUNT
+      shift = (index / SUB_BUCKET_COUNT) - 1
+      sub_bucket = (index % SUB_BUCKET_COUNT) + SUB_BUCKET_COUNT
+      return sub_bucket << shift
+    end
+
+  end # class LatencyHistogram
+
+end # module Cosmos
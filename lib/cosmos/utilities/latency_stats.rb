@@ -0,0 +1,126 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'cosmos/utilities/latency_histogram'
+
+module Cosmos
+
+  # Records how long after its data arrived each packet received by an
+  # interface reaches each stage of processing in the Command and Telemetry
+  # Server. Every stage has a {LatencyHistogram} of the time since the
+  # stream read which returned the packet's data (or since the interface
+  # returned the packet if it does not use a {StreamProtocol}). The
+  # difference between consecutive stages is the time spent in a stage.
+  #
+  # Instrumentation is disabled by default and is enabled for all interfaces
+  # with {LatencyStats.enabled=}. Callers check {LatencyStats.enabled} before
+  # taking a timestamp so there is no cost while it is disabled.
+  class LatencyStats
+    # Processing stages in the order they occur
+    STAGES = [:REDUCE, :IDENTIFY, :LIMITS, :POST, :ROUTE, :LOG]
+    # Index of each stage into the histograms
+    REDUCE = 0
+    IDENTIFY = 1
+    LIMITS = 2
+    POST = 3
+    ROUTE = 4
+    LOG = 5
+
+    @@enabled = false
+
+    # @return [Boolean] Whether latency instrumentation is enabled
+    def self.enabled
+      @@enabled
+    end
+
+    # @param enabled [Boolean] Whether to enable latency instrumentation
+    def self.enabled=(enabled)
+      @@enabled = enabled ? true : false
+    end
+
+    # @return [LatencyStats|nil] The latency stats of the interface whose
+    #   InterfaceThread is the current thread
+    def self.current
+      Thread.current[:cosmos_latency_stats]
+    end
+
+    # @param latency_stats [LatencyStats] The latency stats of the interface
+    #   whose InterfaceThread is the current thread
+    def self.current=(latency_stats)
+      Thread.current[:cosmos_latency_stats] = latency_stats
+    end
+
+    # @return [Integer] Monotonic clock time in nanoseconds
+    def self.now
+      Process.clock_gettime(Process::CLOCK_MONOTONIC, :nanosecond)
+    end
+
+    # @return [Array<LatencyHistogram>] Histogram for each stage in {STAGES}
+    attr_reader :histograms
+
+    def initialize
+      @histograms = Array.new(STAGES.length) { LatencyHistogram.new }
+      @arrival_time = nil
+      @start_time = nil
+    end
+
+    # Record that data was returned by a stream read. Packets reduced from
+    # this data are timed from now.
+    def arrived
+      @arrival_time = LatencyStats.now
+    end
+
+    # Start timing a packet returned by the interface. Records the {REDUCE}
+    # stage.
+    def start
+      now = LatencyStats.now
+      @start_time = @arrival_time || now
+      @histograms[REDUCE].record(now - @start_time)
+    end
+
+    # Record that the packet being timed reached a stage
+    #
+    # @param stage [Integer] Index of the stage. One of {REDUCE}, {IDENTIFY},
+    #   {LIMITS}, {POST}, {ROUTE} or {LOG}.
+    def stamp(stage)
+      @histograms[stage].record(LatencyStats.now - @start_time) if @start_time
+    end
+
+    # Stop timing the current packet
+    def finish
+      @start_time = nil
+    end
+
+    # @return [Array<Array<String, Integer, Float, ...>>] For each stage the
+    #   stage name, number of packets, minimum, mean, 50th, 90th and 99th
+    #   percentile and maximum latency in microseconds
+    def summary
+      result = []
+      STAGES.each_with_index do |stage, index|
+        histogram = @histograms[index]
+        result << [stage.to_s, histogram.count,
+                   histogram.min / 1000.0,
+                   histogram.mean / 1000.0,
+                   histogram.percentile(50) / 1000.0,
+                   histogram.percentile(90) / 1000.0,
+                   histogram.percentile(99) / 1000.0,
+                   histogram.max / 1000.0]
+      end
+      result
+    end
+
+    # Clear all the histograms
+    def clear
+      @histograms.each {|histogram| histogram.clear }
+    end
+
+  end # class LatencyStats
+
+end # module Cosmos
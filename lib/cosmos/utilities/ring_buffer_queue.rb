@@ -0,0 +1,175 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'thread'
+
+module Cosmos
+
+  # Fixed capacity thread safe queue which implements the same push and pop
+  # interface as the Ruby Queue class. When the queue is full the overflow
+  # policy determines what happens to the new entry.
+  class RingBufferQueue
+    # Valid overflow policies. :DROP_OLDEST overwrites the oldest entry,
+    # :DROP_NEWEST discards the entry being pushed and :DISCONNECT discards
+    # the entry and reports the overflow to the caller of push so the queue
+    # can be removed.
+    OVERFLOW_POLICIES = [:DROP_OLDEST, :DROP_NEWEST, :DISCONNECT]
+
+    # @return [Integer] Maximum number of entries held by the queue
+    attr_reader :capacity
+    # @return [Symbol] Overflow policy. One of {OVERFLOW_POLICIES}
+    attr_reader :overflow
+    # @return [Integer] Number of entries dropped due to overflow
+    attr_reader :dropped_count
+
+    # @param capacity [Integer] Maximum number of entries held by the queue
+    # @param overflow [Symbol] What to do when an entry is pushed to a full
+    #   queue. Must be one of {OVERFLOW_POLICIES}.
+    def initialize(capacity, overflow = :DROP_OLDEST)
+      @capacity = Integer(capacity)
+      raise ArgumentError, "capacity must be greater than 0: #{capacity}" if @capacity <= 0
+      @overflow = overflow.to_s.upcase.intern
+      raise ArgumentError, "Unknown overflow policy: #{overflow}" unless OVERFLOW_POLICIES.include?(@overflow)
+      @buffer = Array.new(@capacity)
+      @head = 0
+      @length = 0
+      @dropped_count = 0
+      @closed = false
+      @mutex = Mutex.new
+      @cond = ConditionVariable.new
+    end
+
+    # Add an entry to the queue
+    #
+    # @param object [Object] Entry to add
+    # @return [Boolean] false if the queue overflowed with the :DISCONNECT
+    #   policy, otherwise true
+    def push(object)
+      @mutex.synchronize do
+        return true if @closed
+        if @length == @capacity
+          @dropped_count += 1
+          case @overflow
+          when :DROP_OLDEST
+            @buffer[@head] = object
+            @head = (@head + 1) % @capacity
+          when :DROP_NEWEST
+            # Nothing to do
+          else # :DISCONNECT
+            return false
+          end
+        else
+          @buffer[(@head + @length) % @capacity] = object
+          @length += 1
+          @cond.signal
+        end
+      end
+      return true
+    end
+    alias << push
+
+    # Remove the oldest entry from the queue
+    #
+    # @param non_block [Boolean] Whether to return immediately if the queue is
+    #   empty. If true and the queue is empty a ThreadError is raised.
+    # @return [Object] The oldest entry or nil if the queue has been closed
+    #   and is empty
+    def pop(non_block = false)
+      @mutex.synchronize do
+        while @length == 0
+          return nil if @closed
+          raise ThreadError, "queue empty" if non_block
+          @cond.wait(@mutex)
+        end
+        return shift_entry()
+      end
+    end
+
+    # Remove up to max_entries from the queue. Waits for up to timeout seconds
+    # for at least one entry to become available.
+    #
+    # @param max_entries [Integer] Maximum number of entries to return
+    # @param timeout [Float|nil] Maximum time to wait in seconds for the first
+    #   entry. nil waits forever and 0 returns immediately.
+    # @return [Array|nil] The oldest entries in the queue. The array is empty
+    #   if the timeout expired. nil is returned if the queue has been closed
+    #   and is empty.
+    def pop_batch(max_entries, timeout = nil)
+      max_entries = Integer(max_entries)
+      raise ArgumentError, "max_entries must be greater than 0: #{max_entries}" if max_entries <= 0
+      @mutex.synchronize do
+        if @length == 0 and !@closed and timeout != 0
+          if timeout
+            end_time = Time.now.to_f + timeout.to_f
+            while @length == 0 and !@closed
+              remaining = end_time - Time.now.to_f
+              break if remaining <= 0
+              @cond.wait(@mutex, remaining)
+            end
+          else
+            @cond.wait(@mutex) while @length == 0 and !@closed
+          end
+        end
+        return nil if @length == 0 and @closed
+
+        count = (max_entries < @length) ? max_entries : @length
+        entries = Array.new(count)
+        count.times {|index| entries[index] = shift_entry() }
+        return entries
+      end
+    end
+
+    # Close the queue. Further pushes are ignored and any threads blocked in
+    # pop return nil once the remaining entries have been removed.
+    def close
+      @mutex.synchronize do
+        @closed = true
+        @cond.broadcast
+      end
+    end
+
+    # @return [Boolean] Whether the queue has been closed
+    def closed?
+      @closed
+    end
+
+    # @return [Integer] Number of entries in the queue
+    def length
+      @length
+    end
+    alias size length
+
+    # @return [Boolean] Whether the queue is empty
+    def empty?
+      @length == 0
+    end
+
+    # Remove all entries from the queue
+    def clear
+      @mutex.synchronize do
+        @buffer.fill(nil)
+        @head = 0
+        @length = 0
+      end
+    end
+
+    protected
+
+    def shift_entry
+      object = @buffer[@head]
+      @buffer[@head] = nil
+      @head = (@head + 1) % @capacity
+      @length -= 1
+      return object
+    end
+
+  end # class RingBufferQueue
+
+end # module Cosmos
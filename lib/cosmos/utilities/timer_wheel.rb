@@ -0,0 +1,196 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'thread'
+
+module Cosmos
+
+  # Hierarchical timer wheel which tracks a deadline for each of a set of
+  # keys and returns the keys whose deadlines have passed. The first level
+  # has {LEVEL0_SLOTS} slots of one tick each. Each higher level has
+  # {LEVELN_SLOTS} slots which each cover a full revolution of the level
+  # below and are cascaded down as the lower level wraps. Advancing the wheel
+  # only touches keys in the slots being passed.
+  #
+  # Rescheduling a key to a later deadline only records the new deadline.
+  # The key is moved when its old slot is reached, so keys which are
+  # rescheduled much more often than they expire (such as packets being
+  # received) cost a single hash update each time. Rescheduling to an
+  # earlier deadline inserts the key again and the copy in the old slot is
+  # ignored when it is reached.
+  class TimerWheel
+    # Number of bits in the first level slot index
+    LEVEL0_BITS = 8
+    # Number of slots in the first level
+    LEVEL0_SLOTS = 1 << LEVEL0_BITS
+    # Number of bits in the higher level slot indexes
+    LEVELN_BITS = 6
+    # Number of slots in each of the higher levels
+    LEVELN_SLOTS = 1 << LEVELN_BITS
+    # Number of levels
+    LEVELS = 3
+    # Largest number of ticks in the future a deadline can be placed. Later
+    # deadlines are placed at the limit and rescheduled when it is reached.
+    MAX_TICKS = (LEVEL0_SLOTS << (LEVELN_BITS * (LEVELS - 1))) - 1
+
+    # @return [Float] Number of seconds per tick
+    attr_reader :tick
+
+    # @param tick [Float] Number of seconds per tick. Keys expire up to one
+    #   tick after their deadline.
+    # @param start_time [Float] Time in seconds to start the wheel at
+    def initialize(tick = 1.0, start_time = Time.now.to_f)
+      @tick = tick.to_f
+      raise ArgumentError, "tick must be greater than 0: #{tick}" if @tick <= 0.0
+      @levels = []
+      @levels << Array.new(LEVEL0_SLOTS) { [] }
+      (LEVELS - 1).times { @levels << Array.new(LEVELN_SLOTS) { [] } }
+      @deadlines = {}
+      # Tick of the slot holding the current copy of each key
+      @armed_ticks = {}
+      @current_tick = to_ticks(start_time)
+      @mutex = Mutex.new
+    end
+
+    # Set the deadline of a key
+    #
+    # @param key [Object] The key
+    # @param deadline [Float] Time in seconds at which the key expires
+    def schedule(key, deadline)
+      @mutex.synchronize do
+        @deadlines[key] = deadline
+        armed_tick = @armed_ticks[key]
+        # Keys armed for an earlier tick are moved when that tick is reached
+        insert(key, deadline) unless armed_tick and armed_tick <= to_ticks(deadline)
+      end
+    end
+
+    # Remove a key from the wheel
+    #
+    # @param key [Object] The key
+    def cancel(key)
+      # The key is dropped when its slot is reached
+      @mutex.synchronize do
+        @deadlines.delete(key)
+        @armed_ticks.delete(key)
+      end
+    end
+
+    # @param key [Object] The key
+    # @return [Float|nil] The deadline of the key or nil if it is not in the
+    #   wheel
+    def deadline(key)
+      @deadlines[key]
+    end
+
+    # @return [Integer] The number of keys in the wheel
+    def length
+      @deadlines.length
+    end
+    alias size length
+
+    # Remove all keys from the wheel
+    def clear
+      @mutex.synchronize do
+        @levels.each {|level| level.each {|slot| slot.clear } }
+        @deadlines.clear
+        @armed_ticks.clear
+      end
+    end
+
+    # Advance the wheel and remove every key whose deadline is at or before
+    # the given time.
+    #
+    # @param time [Float] Time in seconds to advance the wheel to
+    # @return [Array] The expired keys
+    def advance(time = Time.now.to_f)
+      expired = []
+      @mutex.synchronize do
+        target_tick = to_ticks(time)
+        while @current_tick < target_tick
+          @current_tick += 1
+          cascade() if (@current_tick & (LEVEL0_SLOTS - 1)) == 0
+          slot = @levels[0][@current_tick & (LEVEL0_SLOTS - 1)]
+          next if slot.empty?
+          keys = slot.dup
+          slot.clear
+          keys.each do |key|
+            # Skip canceled keys and copies left behind by rescheduling
+            next unless @armed_ticks[key] == @current_tick
+            deadline = @deadlines[key]
+            if deadline <= time
+              @deadlines.delete(key)
+              @armed_ticks.delete(key)
+              expired << key
+            else
+              insert(key, deadline)
+            end
+          end
+        end
+      end
+      expired
+    end
+
+    protected
+
+    def to_ticks(time)
+      (time.to_f / @tick).floor
+    end
+
+    # Place a key in the slot for its deadline. Must be called with the mutex
+    # held.
+    def insert(key, deadline)
+      deadline_tick = to_ticks(deadline)
+      # Deadlines in the past expire on the next tick
+      deadline_tick = @current_tick + 1 if deadline_tick <= @current_tick
+      delta = deadline_tick - @current_tick
+      if delta > MAX_TICKS
+        delta = MAX_TICKS
+        deadline_tick = @current_tick + delta
+      end
+
+      if delta < LEVEL0_SLOTS
+        @levels[0][deadline_tick & (LEVEL0_SLOTS - 1)] << key
+      else
+        level = 1
+        shift = LEVEL0_BITS
+        while level < (LEVELS - 1) and delta >= (LEVEL0_SLOTS << (LEVELN_BITS * level))
+          level += 1
+          shift += LEVELN_BITS
+        end
+        @levels[level][(deadline_tick >> shift) & (LEVELN_SLOTS - 1)] << key
+      end
+      @armed_ticks[key] = deadline_tick
+    end
+
+    # Move the keys in the higher level slots which have come due down to the
+    # lower levels. Must be called with the mutex held.
+    def cascade
+      shift = LEVEL0_BITS
+      (1...LEVELS).each do |level|
+        slot = @levels[level][(@current_tick >> shift) & (LEVELN_SLOTS - 1)]
+        keys = slot.dup
+        slot.clear
+        block = @current_tick >> shift
+        keys.each do |key|
+          armed_tick = @armed_ticks[key]
+          # Skip canceled keys and copies left behind by rescheduling
+          next unless armed_tick and (armed_tick >> shift) == block
+          insert(key, @deadlines[key])
+        end
+        # Only cascade the next level when this level wraps
+        break unless ((@current_tick >> shift) & (LEVELN_SLOTS - 1)) == 0
+        shift += LEVELN_BITS
+      end
+    end
+
+  end # class TimerWheel
+
+end # module Cosmos
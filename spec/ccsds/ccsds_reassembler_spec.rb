@@ -0,0 +1,111 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos/ccsds/ccsds_reassembler'
+require 'cosmos/ccsds/ccsds_packet'
+
+module Cosmos
+
+  describe CcsdsReassembler do
+    before(:each) do
+      @reassembler = CcsdsReassembler.new
+    end
+
+    def segment(apid, flags, count, data)
+      [0x0800 | apid, (flags << 14) | count, data.length - 1].pack('nnn') << data
+    end
+
+    describe "unsegment" do
+      it "returns standalone CCSDS packets" do
+        data = segment(1, CcsdsPacket::STANDALONE, 0, "\x01\x02")
+        expect(@reassembler.unsegment(data)).to eql data
+        expect(@reassembler.stats(1)[:completed]).to eql 1
+      end
+
+      it "combines interleaved segments from different APIDs" do
+        first1 = segment(1, CcsdsPacket::FIRST, 10, "\x01\x02")
+        first2 = segment(2, CcsdsPacket::FIRST, 20, "\x11\x12")
+        expect(@reassembler.unsegment(first1)).to be_nil
+        expect(@reassembler.unsegment(first2)).to be_nil
+        expect(@reassembler.unsegment(segment(1, CcsdsPacket::CONTINUATION, 11, "\x03"))).to be_nil
+        expect(@reassembler.unsegment(segment(2, CcsdsPacket::LAST, 21, "\x13"))).to eql first2 + "\x13"
+        expect(@reassembler.in_progress?(1)).to be true
+        expect(@reassembler.unsegment(segment(1, CcsdsPacket::LAST, 12, "\x04"))).to eql first1 + "\x03\x04"
+        expect(@reassembler.in_progress?(1)).to be false
+        expect(@reassembler.apids).to eql [1, 2]
+      end
+
+      it "keeps the segments when the received buffers change" do
+        first = segment(3, CcsdsPacket::FIRST, 0, "\x01\x02")
+        last = segment(3, CcsdsPacket::LAST, 1, "\x03")
+        expected = first + "\x03"
+        @reassembler.unsegment(first)
+        first.replace("\x00" * 8)
+        expect(@reassembler.unsegment(last)).to eql expected
+      end
+
+      it "counts missing segments and discards the packet" do
+        @reassembler.unsegment(segment(4, CcsdsPacket::FIRST, 16383, "\x01"))
+        expect(@reassembler.unsegment(segment(4, CcsdsPacket::CONTINUATION, 2, "\x02"))).to be_nil
+        expect(@reassembler.unsegment(segment(4, CcsdsPacket::LAST, 3, "\x03"))).to be_nil
+        stats = @reassembler.stats(4)
+        expect(stats[:packets]).to eql 3
+        expect(stats[:missing]).to eql 2
+        expect(stats[:discarded]).to eql 1
+        expect(stats[:unexpected]).to eql 1
+        expect(stats[:completed]).to eql 0
+      end
+
+      it "counts segments received out of order" do
+        @reassembler.unsegment(segment(5, CcsdsPacket::FIRST, 0, "\x01"))
+        expect(@reassembler.unsegment(segment(5, CcsdsPacket::FIRST, 1, "\x02"))).to be_nil
+        data = segment(5, CcsdsPacket::STANDALONE, 2, "\x03")
+        expect(@reassembler.unsegment(data)).to eql data
+        stats = @reassembler.stats(5)
+        expect(stats[:unexpected]).to eql 2
+        expect(stats[:discarded]).to eql 2
+        expect(stats[:missing]).to eql 0
+      end
+
+      it "complains about data shorter than the primary header" do
+        expect { @reassembler.unsegment("\x00\x01") }.to raise_error(ArgumentError, /primary header/)
+      end
+    end
+
+    describe "unsegment_packet" do
+      it "reassembles CcsdsPackets" do
+        pkt1 = CcsdsPacket.new
+        pkt1.write('CCSDSSEQFLAGS', CcsdsPacket::FIRST)
+        pkt1.write('CCSDSSEQCNT', 0)
+        pkt1.write('CCSDSDATA',"\x01\x02\x03\x04")
+        pkt2 = CcsdsPacket.new
+        pkt2.write('CCSDSSEQFLAGS', CcsdsPacket::LAST)
+        pkt2.write('CCSDSSEQCNT', 1)
+        pkt2.write('CCSDSDATA',"\x05\x06\x07\x08")
+        expect(@reassembler.unsegment_packet(pkt1)).to be_nil
+        expect(@reassembler.unsegment_packet(pkt2)).to eql pkt1.buffer + pkt2.read("CCSDSDATA")
+      end
+    end
+
+    describe "reset" do
+      it "clears one or all APIDs" do
+        @reassembler.unsegment(segment(1, CcsdsPacket::FIRST, 0, "\x01"))
+        @reassembler.unsegment(segment(2, CcsdsPacket::FIRST, 0, "\x01"))
+        @reassembler.reset(1)
+        expect(@reassembler.stats(1)).to be_nil
+        expect(@reassembler.in_progress?(2)).to be true
+        @reassembler.reset
+        expect(@reassembler.apids).to eql []
+        expect { @reassembler.stats(2048) }.to raise_error(ArgumentError, /APID/)
+      end
+    end
+  end
+end
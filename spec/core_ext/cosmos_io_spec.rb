@@ -74,4 +74,33 @@ describe StringIO do
       expect(io.read_length_bytes(4)).to eql "\x01\x02\x03"
     end
   end
+
+  describe "writev_nonblock" do
+    it "writes the joined segments" do
+      io = StringIO.new
+      expect(io.writev_nonblock(["\x01\x02", "", "\x03"])).to eql 3
+      expect(io.string).to eql "\x01\x02\x03"
+    end
+  end
+end
+
+describe IO do
+
+  describe "writev_nonblock" do
+    it "writes the segments without changing the blocking mode" do
+      unless Kernel.is_windows?
+        require 'fcntl'
+        require 'cosmos/core_ext/io'
+        read, write = UNIXSocket.pair
+        write.fcntl(Fcntl::F_SETFL, write.fcntl(Fcntl::F_GETFL) & ~Fcntl::O_NONBLOCK)
+        flags = write.fcntl(Fcntl::F_GETFL)
+        expect(write.writev_nonblock(["\x01\x02", "", "\x03"])).to eql 3
+        expect(read.readpartial(3)).to eql "\x01\x02\x03"
+        expect { loop { write.writev_nonblock(["\x00" * 65536]) } }.to raise_error(IO::EAGAINWaitWritable)
+        expect(write.fcntl(Fcntl::F_GETFL)).to eql flags
+        read.close
+        write.close
+      end
+    end
+  end
 end
@@ -41,6 +41,8 @@ module Cosmos
         expect(i.read_queue_size).to eql 0
         expect(i.write_queue_size).to eql 0
         expect(i.interfaces).to eql []
+        expect(i.async_write_queue_depth).to eql 0
+        expect(i.async_writer).to be_nil
       end
     end
 
@@ -56,6 +58,44 @@ module Cosmos
       end
     end
 
+    describe "read_batch" do
+      it "returns the packet from read" do
+        i = Interface.new
+        packet = Packet.new('TGT', 'PKT')
+        allow(i).to receive(:read).and_return(packet)
+        expect(i.read_batch).to eql [packet]
+      end
+
+      it "returns nil if read returns nil" do
+        i = Interface.new
+        allow(i).to receive(:read).and_return(nil)
+        expect(i.read_batch).to be_nil
+      end
+    end
+
+    describe "write_batch" do
+      it "writes each packet" do
+        i = Interface.new
+        packets = [Packet.new('TGT', 'PKT1'), Packet.new('TGT', 'PKT2')]
+        written = []
+        allow(i).to receive(:write) {|packet| written << packet }
+        i.write_batch(packets)
+        expect(written).to eql packets
+      end
+
+      it "writes the rest of the packets after a packet fails" do
+        i = Interface.new
+        packets = [Packet.new('TGT', 'PKT1'), Packet.new('TGT', 'PKT2'), Packet.new('TGT', 'PKT3')]
+        written = []
+        allow(i).to receive(:write) do |packet|
+          raise "Bad packet" if packet.packet_name == 'PKT1'
+          written << packet
+        end
+        expect { i.write_batch(packets) }.to raise_error("Bad packet")
+        expect(written).to eql packets[1..-1]
+      end
+    end
+
     describe "read_allowed?" do
       it "is true" do
         expect(Interface.new.read_allowed?).to be true
@@ -94,6 +134,7 @@ module Cosmos
         i.read_queue_size = 6
         i.write_queue_size = 7
         i.interfaces = [5,6]
+        i.worker_process = true
 
         i2 = Interface.new
         i.copy_to(i2)
@@ -114,6 +155,7 @@ module Cosmos
         expect(i2.read_queue_size).to eql 0 # does not get copied
         expect(i2.write_queue_size).to eql 0 # does not get copied
         expect(i2.interfaces).to eql [5,6]
+        expect(i2.worker_process).to be true
 
         Cosmos.kill_thread(nil, i.thread)
       end
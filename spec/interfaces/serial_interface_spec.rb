@@ -51,6 +51,19 @@ module Cosmos
         end
       end
     end
+
+    describe "set_option" do
+      it "passes the read buffer options to the stream" do
+        stream = double("stream")
+        allow(stream).to receive(:raw_logger_pair=)
+        allow(stream).to receive(:connect)
+        expect(SerialStream).to receive(:new).with('COM1','COM1','9600',:NONE,'1','0','0',100000,0.01).and_return(stream)
+        i = SerialInterface.new('COM1','COM1','9600','NONE','1','0','0','burst')
+        i.set_option('READ_BUFFER_SIZE', ['100000'])
+        i.set_option('INTER_BYTE_TIMEOUT', ['0.01'])
+        i.connect
+      end
+    end
   end
 end
 
@@ -152,6 +152,16 @@ module Cosmos
       end
     end
 
+    describe "set_option" do
+      it "configures a CRC check" do
+        si = StreamInterface.new("burst")
+        expect(si.crc_failures).to eql 0
+        si.set_option('CRC', ['32', 'nil', 'nil', 'nil', 'nil', 'nil', 'LITTLE_ENDIAN', 'DISCARD'])
+        expect(si.instance_variable_get(:@stream_protocol).crc_check.action).to eql :DISCARD
+        expect(si.crc_failures).to eql 0
+      end
+    end
+
   end
 end
 
@@ -49,6 +49,20 @@ module Cosmos
         i.connect
         expect(i.connected?).to be true
       end
+
+      it "passes the local socket option to the stream" do
+        stream = double("stream")
+        allow(stream).to receive(:connect)
+        allow(stream).to receive(:connected?) { true }
+        allow(stream).to receive(:raw_logger_pair=) { nil }
+        i = TcpipClientInterface.new('localhost','nil','8891','5','5','burst')
+        expect(TcpipClientStream).to receive(:new).with('localhost',nil,'8891','5','5',5.0,false) { stream }
+        i.connect
+
+        i.set_option('LOCAL_SOCKET', ['TRUE'])
+        expect(TcpipClientStream).to receive(:new).with('localhost',nil,'8891','5','5',5.0,true) { stream }
+        i.connect
+      end
     end
   end
 end
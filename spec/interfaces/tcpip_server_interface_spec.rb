@@ -148,11 +148,33 @@ module Cosmos
     end
 
     describe "set_option" do
+      it "listens on a local socket" do
+        expect(@stream).to receive(:local_socket=).with(true)
+        i = TcpipServerInterface.new('8888','8889','5','5','burst')
+        i.set_option('LOCAL_SOCKET', ['TRUE'])
+      end
+
       it "sets the listen address for the tcpip_server" do
         expect(@stream).to receive(:listen_address=).with('127.0.0.1')
         i = TcpipServerInterface.new('8888','8889','5','5','burst')
         i.set_option('LISTEN_ADDRESS', ['127.0.0.1'])
       end
+
+      it "configures the event loop and client output buffers" do
+        expect(@stream).to receive(:event_loop=).with(true)
+        expect(@stream).to receive(:max_output_bytes=).with(1000000)
+        expect(@stream).to receive(:overflow_policy=).with('SAMPLE')
+        i = TcpipServerInterface.new('8888','8889','5','5','burst')
+        i.set_option('EVENT_LOOP', ['TRUE'])
+        i.set_option('CLIENT_BUFFER_SIZE', ['1000000'])
+        i.set_option('CLIENT_OVERFLOW', ['SAMPLE'])
+      end
+
+      it "removes the client output buffer limit" do
+        expect(@stream).to receive(:max_output_bytes=).with(nil)
+        i = TcpipServerInterface.new('8888','8889','5','5','burst')
+        i.set_option('CLIENT_BUFFER_SIZE', ['NIL'])
+      end
     end
 
   end
@@ -140,6 +140,32 @@ module Cosmos
       end
     end
 
+    describe "read_batch" do
+      it "counts the packets received and sets their received time" do
+        time = Time.now
+        read = double("read")
+        allow(read).to receive(:read_batch) { [["\x00\x01", "\x02\x03\x04"], [time, nil]] }
+        expect(UdpReadSocket).to receive(:new).and_return(read)
+        i = UdpInterface.new('localhost','nil','8889')
+        i.connect
+        packets = i.read_batch
+        expect(packets.length).to eql 2
+        expect(packets[0].buffer).to eql "\x00\x01"
+        expect(packets[0].received_time).to eql time
+        expect(packets[1].received_time).to be_nil
+        expect(i.read_count).to eql 2
+        expect(i.bytes_read).to eql 5
+      end
+
+      it "calls read for subclasses which override it" do
+        class MyUdpInterface < UdpInterface
+          def read; Packet.new(nil, nil, :BIG_ENDIAN, nil, "\x05"); end
+        end
+        i = MyUdpInterface.new('localhost','nil','8889')
+        expect(i.read_batch.map {|packet| packet.buffer }).to eql ["\x05"]
+      end
+    end
+
     describe "write, write_raw" do
       it "complains if write_dest not given" do
         i = UdpInterface.new('localhost','nil','8889')
@@ -170,6 +196,52 @@ module Cosmos
         expect(i.bytes_written).to eql 8
       end
     end
+
+    describe "write_batch" do
+      it "writes the packets as one batch" do
+        write = double("write")
+        expect(UdpWriteSocket).to receive(:new).and_return(write)
+        expect(write).to receive(:write_batch).with(["\x00\x01", "\x02\x03\x04"], 10.0).and_return({})
+        i = UdpInterface.new('localhost','8888','nil')
+        i.connect
+        pkt1 = Packet.new('tgt','pkt1')
+        pkt1.buffer = "\x00\x01"
+        pkt2 = Packet.new('tgt','pkt2')
+        pkt2.buffer = "\x02\x03\x04"
+        i.write_batch([pkt1, pkt2])
+        expect(i.write_count).to eql 2
+        expect(i.bytes_written).to eql 5
+      end
+
+      it "counts only the packets which were sent" do
+        write = double("write")
+        expect(UdpWriteSocket).to receive(:new).and_return(write)
+        expect(write).to receive(:write_batch).and_return({0 => Errno::ECONNREFUSED.new})
+        i = UdpInterface.new('localhost','8888','nil')
+        i.connect
+        pkt1 = Packet.new('tgt','pkt1')
+        pkt1.buffer = "\x00\x01"
+        pkt2 = Packet.new('tgt','pkt2')
+        pkt2.buffer = "\x02\x03\x04"
+        expect { i.write_batch([pkt1, pkt2]) }.to raise_error(Errno::ECONNREFUSED)
+        expect(i.write_count).to eql 1
+        expect(i.bytes_written).to eql 3
+      end
+
+      it "complains if the server is not connected" do
+        i = UdpInterface.new('localhost','8888','nil')
+        expect { i.write_batch([Packet.new('','')]) }.to raise_error(/Interface not connected/)
+      end
+    end
+
+    describe "set_option" do
+      it "sets the receive buffer size of the read socket" do
+        expect(UdpReadSocket).to receive(:new).with(8889, '127.0.0.1', nil, '0.0.0.0', 4000000)
+        i = UdpInterface.new('localhost','nil','8889')
+        i.set_option('RECEIVE_BUFFER_SIZE', ['4000000'])
+        i.connect
+      end
+    end
   end
 end
 
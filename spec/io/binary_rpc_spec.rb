@@ -0,0 +1,87 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos/io/json_rpc'
+
+module Cosmos
+
+  describe BinaryRpc do
+    describe "dump, load" do
+      it "encodes basic types" do
+        [nil, true, false, 0, 127, 128, 255, 65536, 2**32, 2**64 - 1, -1, -32, -33, -129, -32769, -2**31 - 1, -2**63,
+         2**64, -2**63 - 1, 2**100, 0.0, -1.5, Float::INFINITY].each do |value|
+          expect(BinaryRpc.load(BinaryRpc.dump(value))).to eql value
+        end
+        expect(BinaryRpc.load(BinaryRpc.dump(Float::NAN)).nan?).to be true
+      end
+
+      it "starts with the binary message marker" do
+        data = BinaryRpc.dump([1, 2, 3])
+        expect(data[0]).to eql BinaryRpc::MARKER
+        expect(BinaryRpc.message?(data)).to be true
+        expect(BinaryRpc.message?([1, 2, 3].to_json)).to be false
+      end
+
+      it "encodes binary strings as raw bytes" do
+        buffer = "\x00\x01\x02\xFF" * 256
+        data = BinaryRpc.dump(buffer)
+        expect(data.length).to eql(buffer.length + 4)
+        result = BinaryRpc.load(data)
+        expect(result).to eql buffer
+        expect(result.encoding).to eql Encoding::ASCII_8BIT
+      end
+
+      it "decodes text as UTF-8" do
+        ["", "TEXT", "X" * 40, "Y" * 300, "Z" * 70000, "café".force_encoding('UTF-8')].each do |text|
+          result = BinaryRpc.load(BinaryRpc.dump(text))
+          expect(result).to eql text.dup.force_encoding('UTF-8')
+          expect(result.encoding).to eql Encoding::UTF_8
+        end
+        expect(BinaryRpc.load(BinaryRpc.dump(:SYMBOL))).to eql "SYMBOL"
+      end
+
+      it "encodes arrays and hashes with string keys" do
+        array = (1..20).to_a
+        expect(BinaryRpc.load(BinaryRpc.dump(array))).to eql array
+        expect(BinaryRpc.load(BinaryRpc.dump(Array.new(70000, 1)))).to eql Array.new(70000, 1)
+        hash = {:TGT => {"PKT" => [1, 2.5, "\xFF"]}, 1 => nil}
+        expect(BinaryRpc.load(BinaryRpc.dump(hash))).to eql({"TGT" => {"PKT" => [1, 2.5, "\xFF"]}, "1" => nil})
+      end
+
+      it "keeps the type of times" do
+        time = Time.at(1000000000, Rational(123456789, 1000))
+        result = BinaryRpc.load(BinaryRpc.dump(time))
+        expect(result).to be_a Time
+        expect(result).to eql time
+        expect(result.nsec).to eql 123456789
+      end
+
+      it "encodes exceptions like JSON" do
+        error = RuntimeError.new("Error")
+        expect(BinaryRpc.load(BinaryRpc.dump(error))).to eql error.as_json
+      end
+
+      it "encodes other objects with as_json" do
+        struct = Struct.new(:a, :b).new(1, "two")
+        expect(BinaryRpc.load(BinaryRpc.dump(struct))).to eql({"a" => 1, "b" => "two"})
+      end
+
+      it "complains about invalid messages" do
+        expect { BinaryRpc.load("") }.to raise_error(ArgumentError, /Not a binary message/)
+        expect { BinaryRpc.load("{}") }.to raise_error(ArgumentError, /Not a binary message/)
+        expect { BinaryRpc.load(BinaryRpc.dump("test")[0..-2]) }.to raise_error(ArgumentError, /Truncated/)
+        expect { BinaryRpc.load(BinaryRpc.dump(nil) << "\xC0") }.to raise_error(ArgumentError, /Extra data/)
+        expect { BinaryRpc.load("\xC1\xC1") }.to raise_error(ArgumentError, /Invalid binary message type/)
+        expect { BinaryRpc.load("\xC1\xD4\x05\x00") }.to raise_error(ArgumentError, /Unknown binary message extension/)
+      end
+    end
+  end
+end
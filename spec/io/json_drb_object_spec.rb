@@ -18,6 +18,10 @@ module Cosmos
       it "rescues bad hosts" do
         expect { JsonDRbObject.new("blah", 7777) }.to raise_error("Invalid hostname: blah")
       end
+
+      it "complains about unknown encodings" do
+        expect { JsonDRbObject.new("localhost", 7777, 1.0, :xml) }.to raise_error(ArgumentError, /Invalid encoding/)
+      end
     end
 
     describe "method_missing" do
@@ -37,6 +41,43 @@ module Cosmos
         sleep(0.1)
       end
 
+      it "calls the method with the binary encoding" do
+        class JsonDRbObjectServer
+          def my_data(param)
+            [param, "\x00\xFF" * 100, 1.5, Time.at(100, 5)]
+          end
+        end
+
+        json = JsonDRb.new
+        json.start_service('127.0.0.1', 7777, JsonDRbObjectServer.new)
+        obj = JsonDRbObject.new("localhost", 7777, 1.0, :binary)
+        expect(obj.my_data("\x01\x02")).to eql ["\x01\x02", "\x00\xFF" * 100, 1.5, Time.at(100, 5)]
+        expect { obj.no_such_method() }.to raise_error(NoMethodError)
+        expect(obj.encoding).to eql :binary
+        obj.disconnect
+        json.stop_service
+        sleep(0.1)
+      end
+
+      it "falls back to JSON if the server does not support the binary encoding" do
+        class JsonDRbObjectServer
+          def my_method(param)
+            param * 2
+          end
+        end
+
+        json = JsonDRb.new
+        json.start_service('127.0.0.1', 7777, JsonDRbObjectServer.new)
+        allow(JsonRpcRequest).to receive(:from_binary) { |data| JsonRpcRequest.from_json(data) }
+        allow_any_instance_of(JsonRpcResponse).to receive(:to_binary) { |response| response.to_json(:allow_nan => true) }
+        obj = JsonDRbObject.new("localhost", 7777, 1.0, :binary)
+        expect(obj.my_method(10)).to eql 20
+        expect(obj.encoding).to eql :json
+        obj.disconnect
+        json.stop_service
+        sleep(0.1)
+      end
+
       it "raises an exception if the remote connection can't be made" do
         json = JsonDRb.new
         json.start_service('127.0.0.1', 7777, self)
@@ -193,6 +193,23 @@ module Cosmos
         expect(request).to eq(JsonRpcRequest.from_hash(request.as_json))
       end
     end
+
+    describe "to_binary, from_binary" do
+      it "creates a request from the binary string" do
+        request = JsonRpcRequest.new("puts",["test","\x00\x01",1.5],10)
+        binary = request.to_binary
+        expect(BinaryRpc.message?(binary)).to be true
+        new_request = JsonRpcRequest.from_binary(binary)
+        expect(new_request.method).to eql "puts"
+        expect(new_request.params).to eql ["test","\x00\x01",1.5]
+        expect(new_request.id).to eql 10
+      end
+
+      it "rescues a bad binary string" do
+        expect { JsonRpcRequest.from_binary(BinaryRpc.dump({"jsonrpc"=>"1.1","method"=>"puts","id"=>10})) }.to raise_error("Invalid JSON-RPC 2.0 Request")
+        expect { JsonRpcRequest.from_binary(JsonRpcRequest.new("puts","test",10).to_json) }.to raise_error("Invalid JSON-RPC 2.0 Request")
+      end
+    end
   end
 
   describe JsonRpcResponse do
@@ -259,6 +276,29 @@ module Cosmos
       end
     end
 
+    describe "from_binary" do
+      it "creates a success response from the binary string" do
+        response = JsonRpcResponse.from_binary(JsonRpcSuccessResponse.new("\x00\xFF" * 512, 10).to_binary)
+        expect(response).to be_a JsonRpcSuccessResponse
+        expect(response.result).to eql("\x00\xFF" * 512)
+        expect(response.to_h['id']).to eql 10
+      end
+
+      it "creates an error response from the binary string" do
+        error = JsonRpcError.new(-1, "error", TestError.new("Error"))
+        response = JsonRpcResponse.from_binary(JsonRpcErrorResponse.new(error, 10).to_binary)
+        expect(response).to be_a JsonRpcErrorResponse
+        expect(response.error.code).to eql(-1)
+        expect(response.error.message).to eql "error"
+        expect(Exception.from_hash(response.error.data)).to be_a TestError
+      end
+
+      it "reports an error if it is not binary" do
+        expect { JsonRpcResponse.from_binary(JsonRpcSuccessResponse.new(1, 10).to_json) }.to raise_error("Invalid JSON-RPC 2.0 Response")
+        expect { JsonRpcResponse.from_binary(BinaryRpc.dump([1])) }.to raise_error("Invalid JSON-RPC 2.0 Response")
+      end
+    end
+
   end
 end
 
@@ -0,0 +1,72 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos/io/poller'
+
+module Cosmos
+
+  describe Poller do
+    before(:each) do
+      @poller = Poller.new
+      @reader, @writer = IO.pipe
+    end
+
+    after(:each) do
+      @poller.close
+      @reader.close
+      @writer.close
+    end
+
+    describe "wait" do
+      it "returns the ready IOs and their events" do
+        @poller.register(@reader, Poller::READABLE)
+        @poller.register(@writer, Poller::WRITABLE)
+        expect(@poller.wait(0)).to eql [[@writer, Poller::WRITABLE]]
+        @writer.write('.')
+        expect(@poller.wait(0).sort_by {|io, _| io.fileno }).to eql [[@reader, Poller::READABLE], [@writer, Poller::WRITABLE]]
+      end
+
+      it "returns an empty array after the timeout" do
+        @poller.register(@reader, Poller::READABLE)
+        start = Time.now
+        expect(@poller.wait(0.1)).to eql []
+        expect(Time.now - start).to be >= 0.09
+      end
+
+      it "returns when woken up by another thread" do
+        @poller.register(@reader, Poller::READABLE)
+        Thread.new { sleep 0.1; @poller.wakeup }
+        start = Time.now
+        expect(@poller.wait(5)).to eql []
+        expect(Time.now - start).to be < 1
+      end
+    end
+
+    describe "register" do
+      it "changes the events of a registered IO" do
+        @poller.register(@writer, Poller::WRITABLE)
+        @poller.register(@writer, Poller::READABLE)
+        expect(@poller.size).to eql 1
+        expect(@poller.wait(0)).to eql []
+      end
+    end
+
+    describe "deregister" do
+      it "stops watching the IO" do
+        @poller.register(@writer, Poller::WRITABLE)
+        expect(@poller.deregister(@writer)).to eql @writer
+        expect(@poller.deregister(@writer)).to be_nil
+        expect(@poller.size).to eql 0
+        expect(@poller.wait(0)).to eql []
+      end
+    end
+  end
+end
@@ -114,6 +114,99 @@ module Cosmos
       end
     end
 
+    describe "asynchronous write" do
+      it "buffers the data until it is flushed" do
+        raw_logger = RawLogger.new('MYINT', :WRITE, true, 100000, nil, true, 1000, 60.0)
+        raw_logger.write("\x00\x01")
+        raw_logger.write("\x02\x03")
+        expect(raw_logger.bytes_buffered).to eql 4
+        expect(Dir[File.join(@log_path,"*.bin")]).to be_empty
+        raw_logger.flush
+        expect(raw_logger.bytes_buffered).to eql 0
+        expect(raw_logger.high_water_mark).to eql 4
+        raw_logger.stop
+        data = File.open(Dir[File.join(@log_path,"*.bin")][-1],'rb') {|file| file.read }
+        expect(data).to eql "\x00\x01\x02\x03"
+      end
+
+      it "writes the data once the flush interval passes" do
+        raw_logger = RawLogger.new('MYINT', :WRITE, true, 100000, nil, true, 1000, 0.1)
+        raw_logger.write("\x00\x01\x02\x03")
+        sleep 0.5
+        expect(raw_logger.bytes_buffered).to eql 0
+        expect(File.size(Dir[File.join(@log_path,"*.bin")][-1])).to eql 4
+        raw_logger.stop
+      end
+
+      it "drops data which does not fit in the buffer" do
+        capture_io do |stdout|
+          raw_logger = RawLogger.new('MYINT', :WRITE, true, 100000, nil, true, 10, 60.0)
+          # Hold the writer thread off the buffer
+          raw_logger.instance_variable_get(:@flush_mutex).synchronize do
+            raw_logger.write("\x00" * 4)
+            raw_logger.write("\x01" * 4)
+            raw_logger.write("\x02" * 4)
+            raw_logger.write("\x03" * 4)
+          end
+          expect(raw_logger.bytes_dropped).to eql 8
+          expect(raw_logger.high_water_mark).to eql 8
+          raw_logger.stop
+          data = File.open(Dir[File.join(@log_path,"*.bin")][-1],'rb') {|file| file.read }
+          expect(data).to eql "\x00\x00\x00\x00\x01\x01\x01\x01"
+          expect(stdout.string.scan("Raw log buffer full").length).to eql 1
+        end
+      end
+
+      it "writes the data once the buffer is half full" do
+        raw_logger = RawLogger.new('MYINT', :WRITE, true, 100000, nil, true, 8, 60.0)
+        raw_logger.write("\x00\x01\x02")
+        sleep 0.5
+        expect(raw_logger.bytes_buffered).to eql 3
+        raw_logger.write("\x03")
+        sleep 0.5
+        expect(raw_logger.bytes_buffered).to eql 0
+        expect(File.size(Dir[File.join(@log_path,"*.bin")][-1])).to eql 4
+        raw_logger.stop
+      end
+
+      it "discards the data buffered before a fork" do
+        raw_logger = RawLogger.new('MYINT', :WRITE, true, 100000, nil, true, 1000, 60.0)
+        raw_logger.write("\x00\x01")
+        raw_logger.reset_after_fork
+        expect(raw_logger.bytes_buffered).to eql 0
+        raw_logger.write("\x02\x03")
+        sleep 0.1
+        raw_logger.stop
+        data = File.open(Dir[File.join(@log_path,"*.bin")][-1],'rb') {|file| file.read }
+        expect(data).to eql "\x02\x03"
+      end
+
+      it "accepts data which is not binary" do
+        raw_logger = RawLogger.new('MYINT', :WRITE, true, 100000, nil, true, 1000, 60.0)
+        raw_logger.write("\xFF")
+        raw_logger.write("\xC3\xA9".force_encoding('UTF-8'))
+        raw_logger.stop
+        data = File.open(Dir[File.join(@log_path,"*.bin")][-1],'rb') {|file| file.read }
+        expect(data).to eql "\xFF\xC3\xA9"
+      end
+
+      it "writes clones to their own files from one writer thread" do
+        raw_logger = RawLogger.new('MYINT', :WRITE, true, 100000, nil, true, 1000, 0.1)
+        clone = raw_logger.clone
+        threads = Thread.list.length
+        raw_logger.write("\x00\x01")
+        clone.write("\x02\x03")
+        expect(Thread.list.length).to eql(threads + 1)
+        sleep 0.5
+        files = Dir[File.join(@log_path,"*.bin")]
+        expect(files.length).to eql 2
+        raw_logger.stop
+        clone.stop
+        data = files.map {|file| File.open(file,'rb') {|f| f.read } }.sort
+        expect(data).to eql ["\x00\x01", "\x02\x03"]
+      end
+    end
+
     describe "start and stop" do
       it "enables and disable logging" do
         raw_logger = RawLogger.new('MYINT', :WRITE, false, 200, nil)
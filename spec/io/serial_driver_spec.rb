@@ -55,6 +55,14 @@ module Cosmos
         driver.read
       end
     end
+
+    describe "error_counts" do
+      it "returns nil if the driver does not keep counters" do
+        allow(Kernel).to receive(:is_windows?).and_return(true)
+        allow(Win32SerialDriver).to receive(:new).and_return(double("Win32SerialDriver"))
+        expect(SerialDriver.new('COM1',9600).error_counts).to be_nil
+      end
+    end
   end
 end
 
@@ -0,0 +1,94 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos/ext/serial_reader'
+
+module Cosmos
+
+  if defined? SerialReader
+    describe SerialReader do
+      before(:each) do
+        @reader, @writer = IO.pipe
+      end
+
+      after(:each) do
+        @reader.close unless @reader.closed?
+        @writer.close unless @writer.closed?
+      end
+
+      describe "read" do
+        it "returns all the data buffered since the last read" do
+          serial_reader = SerialReader.new(@reader, 1000)
+          @writer.write("\x01\x02")
+          @writer.write("\x03\x04")
+          sleep 0.1
+          expect(serial_reader.read(1.0)).to eql "\x01\x02\x03\x04"
+          expect(serial_reader.stats[:bytes_read]).to eql 4
+          expect(serial_reader.stats[:high_water_mark]).to eql 4
+          serial_reader.stop
+        end
+
+        it "returns nil after the timeout" do
+          serial_reader = SerialReader.new(@reader, 1000)
+          start = Time.now
+          expect(serial_reader.read(0.1)).to be_nil
+          expect(Time.now - start).to be_within(0.05).of(0.1)
+          serial_reader.stop
+        end
+
+        it "does not block other threads while waiting" do
+          serial_reader = SerialReader.new(@reader, 1000)
+          thread = Thread.new { serial_reader.read }
+          sleep 0.1
+          @writer.write("\x05")
+          expect(thread.value).to eql "\x05"
+          serial_reader.stop
+        end
+
+        it "counts the data dropped while the buffer is full" do
+          serial_reader = SerialReader.new(@reader, 10)
+          @writer.write("\x00" * 25)
+          sleep 0.1
+          expect(serial_reader.read(1.0)).to eql "\x00" * 10
+          expect(serial_reader.stats[:bytes_dropped]).to eql 15
+          serial_reader.stop
+        end
+
+        it "raises EOFError once the buffered data is read" do
+          serial_reader = SerialReader.new(@reader, 1000)
+          @writer.write("\x06")
+          @writer.close
+          sleep 0.1
+          expect(serial_reader.read(1.0)).to eql "\x06"
+          expect { serial_reader.read(1.0) }.to raise_error(EOFError)
+          serial_reader.stop
+        end
+      end
+
+      describe "read_nonblock" do
+        it "returns an empty string if no data is buffered" do
+          serial_reader = SerialReader.new(@reader, 1000)
+          expect(serial_reader.read_nonblock).to eql ''
+          serial_reader.stop
+        end
+      end
+
+      describe "error_counts" do
+        it "returns nil if the driver does not keep counters" do
+          serial_reader = SerialReader.new(@reader, 1000)
+          expect(serial_reader.error_counts).to be_nil
+          serial_reader.stop
+        end
+      end
+    end
+  end
+
+end
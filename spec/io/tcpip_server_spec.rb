@@ -289,7 +289,7 @@ module Cosmos
         capture_io do |stdout|
           allow(System).to receive_message_chain(:instance, :use_dns).and_return(false)
           allow(System).to receive_message_chain(:instance, :acl).and_return(false)
-          allow_any_instance_of(BurstStreamProtocol).to receive(:write) { raise Errno::ECONNABORTED }
+          allow_any_instance_of(BurstStreamProtocol).to receive(:write_encoded) { raise Errno::ECONNABORTED }
 
           server = TcpipServer.new(8888,8889,nil,nil,'Burst')
           server.connect
@@ -315,6 +315,249 @@ module Cosmos
       end
     end
 
+    describe "event_loop" do
+      before(:each) do
+        allow(System).to receive_message_chain(:instance, :use_dns).and_return(false)
+        allow(System).to receive_message_chain(:instance, :acl).and_return(false)
+      end
+
+      it "serves every client from a single thread" do
+        server = TcpipServer.new(8888,8889,nil,nil,'Burst')
+        server.event_loop = true
+        server.connect
+        sleep 0.2
+        sockets = []
+        5.times { sockets << TCPSocket.open("127.0.0.1",8888) }
+        5.times { sockets << TCPSocket.open("127.0.0.1",8889) }
+        sleep 0.2
+        expect(server.num_clients).to eql 10
+        # 2 because the RSpec main thread plus the event loop
+        expect(Thread.list.length).to eql 2
+        server.disconnect
+        sleep 0.2
+        expect(server.num_clients).to eql 0
+        expect(Thread.list.length).to eql 1
+        sockets.each {|socket| socket.close }
+      end
+
+      it "reads from and writes to the clients" do
+        server = TcpipServer.new(8888,8888,nil,nil,'Burst')
+        server.event_loop = true
+        server.connect
+        sleep 0.2
+        socket1 = TCPSocket.open("127.0.0.1",8888)
+        socket2 = TCPSocket.open("127.0.0.1",8888)
+        sleep 0.2
+        socket1.write("\x00\x01")
+        sleep 0.2
+        expect(server.read.buffer).to eql "\x00\x01"
+
+        packet = Packet.new("TGT","PKT")
+        packet.buffer = "\x01\x02\x03\x04"
+        server.write(packet)
+        sleep 0.2
+        expect(socket1.read_nonblock(4)).to eql "\x01\x02\x03\x04"
+        expect(socket2.read_nonblock(4)).to eql "\x01\x02\x03\x04"
+        server.disconnect
+        socket1.close
+        socket2.close
+        sleep(0.2)
+      end
+
+      it "drops clients which disconnect" do
+        capture_io do |stdout|
+          server = TcpipServer.new(8888,8889,nil,nil,'Burst')
+          server.event_loop = true
+          server.connect
+          sleep 0.2
+          socket1 = TCPSocket.open("127.0.0.1",8888)
+          socket2 = TCPSocket.open("127.0.0.1",8889)
+          sleep 0.2
+          expect(server.num_clients).to eql 2
+          socket1.close
+          socket2.close
+          sleep 0.2
+          expect(server.num_clients).to eql 0
+          server.disconnect
+          sleep(0.2)
+
+          expect(stdout.string).to match /Tcpip server lost write connection/
+          expect(stdout.string).to match /Tcpip server lost read connection/
+        end
+      end
+
+      it "drops clients which stop accepting data after the write timeout" do
+        capture_io do |stdout|
+          server = TcpipServer.new(8888,nil,0.2,nil,'Burst')
+          server.event_loop = true
+          server.connect
+          sleep 0.2
+          socket = TCPSocket.open("127.0.0.1",8888)
+          sleep 0.2
+          packet = Packet.new("TGT","PKT")
+          packet.buffer = "\x00" * 65536
+          100.times { server.write(packet) }
+          sleep 0.5
+          expect(server.num_clients).to eql 0
+          server.disconnect
+          socket.close
+          sleep(0.2)
+
+          expect(stdout.string).to match /Tcpip server write timeout/
+        end
+      end
+
+      it "encodes each packet once for every client" do
+        server = TcpipServer.new(8888,nil,nil,nil,'Burst')
+        server.event_loop = true
+        server.connect
+        sleep 0.2
+        sockets = []
+        3.times { sockets << TCPSocket.open("127.0.0.1",8888) }
+        sleep 0.2
+        expect_any_instance_of(BurstStreamProtocol).to receive(:pre_write_packet).once.and_call_original
+        packet = Packet.new("TGT","PKT")
+        packet.buffer = "\x01\x02\x03\x04"
+        server.write(packet)
+        sleep 0.2
+        sockets.each {|socket| expect(socket.read_nonblock(4)).to eql "\x01\x02\x03\x04" }
+        expect(server.client_stats.map {|stats| stats[:packets_written] }).to eql [1, 1, 1]
+        server.disconnect
+        sockets.each {|socket| socket.close }
+        sleep(0.2)
+      end
+
+      it "samples packets for clients whose output buffer is full" do
+        server = TcpipServer.new(8888,nil,nil,nil,'Burst')
+        server.event_loop = true
+        server.max_output_bytes = 1_000_000
+        server.overflow_policy = 'SAMPLE'
+        server.connect
+        sleep 0.2
+        socket = TCPSocket.open("127.0.0.1",8888)
+        sleep 0.2
+        packet = Packet.new("TGT","PKT")
+        packet.buffer = "\x00" * 65536
+        100.times { server.write(packet) }
+        sleep 0.5
+        stats = server.client_stats[0]
+        expect(stats[:packets_dropped]).to be > 0
+        expect(stats[:packets_written] + stats[:packets_dropped]).to eql 100
+        expect(stats[:bytes_queued]).to be <= 1_000_000
+        expect(stats[:lag]).to be > 0
+        expect(server.num_clients).to eql 1
+        server.disconnect
+        socket.close
+        sleep(0.2)
+      end
+
+      it "disconnects clients whose output buffer is full" do
+        capture_io do |stdout|
+          server = TcpipServer.new(8888,nil,nil,nil,'Burst')
+          server.event_loop = true
+          server.max_output_bytes = 1_000_000
+          server.connect
+          sleep 0.2
+          socket = TCPSocket.open("127.0.0.1",8888)
+          sleep 0.2
+          packet = Packet.new("TGT","PKT")
+          packet.buffer = "\x00" * 65536
+          100.times { server.write(packet) }
+          sleep 0.5
+          expect(server.num_clients).to eql 0
+          server.disconnect
+          socket.close
+          sleep(0.2)
+
+          expect(stdout.string).to match /Tcpip server output buffer full/
+        end
+      end
+
+      it "limits the client output buffers by default" do
+        server = TcpipServer.new(8888,nil,nil,nil,'Burst')
+        expect(server.max_output_bytes).to eql TcpipServer::DEFAULT_MAX_OUTPUT_BYTES
+      end
+
+      it "complains about an unknown overflow policy" do
+        server = TcpipServer.new(8888,nil,nil,nil,'Burst')
+        expect { server.overflow_policy = 'BLOCK' }.to raise_error(ArgumentError, /overflow policy/)
+      end
+    end
+
+    describe "local_socket" do
+      before(:each) do
+        allow(System).to receive_message_chain(:instance, :use_dns).and_return(false)
+        allow(System).to receive_message_chain(:instance, :acl).and_return(false)
+      end
+
+      it "reads from and writes to local clients" do
+        unless Kernel.is_windows?
+          [false, true].each do |event_loop|
+            server = TcpipServer.new(8888,8888,nil,nil,'Burst')
+            server.event_loop = event_loop
+            server.local_socket = true
+            server.connect
+            sleep 0.2
+            path = TcpipSocketStream.local_socket_path(8888)
+            expect(File.socket?(path)).to be true
+            expect(File.stat(path).mode & 0077).to eql 0
+            expect(File.stat(TcpipSocketStream.local_socket_dir).mode & 0077).to eql 0
+            socket1 = UNIXSocket.new(path)
+            socket2 = TCPSocket.open("127.0.0.1",8888)
+            sleep 0.2
+            expect(server.num_clients).to eql 2
+            socket1.write("\x00\x01")
+            sleep 0.2
+            expect(server.read.buffer).to eql "\x00\x01"
+
+            packet = Packet.new("TGT","PKT")
+            packet.buffer = "\x01\x02\x03\x04"
+            server.write(packet)
+            sleep 0.2
+            expect(socket1.read_nonblock(4)).to eql "\x01\x02\x03\x04"
+            expect(socket2.read_nonblock(4)).to eql "\x01\x02\x03\x04"
+            server.disconnect
+            socket1.close
+            socket2.close
+            expect(File.exist?(path)).to be false
+            sleep(0.2)
+          end
+        end
+      end
+
+      it "replaces a local socket left behind by a server which is not running" do
+        unless Kernel.is_windows?
+          TcpipSocketStream.create_local_socket_dir
+          path = TcpipSocketStream.local_socket_path(8889)
+          stale = UNIXServer.new(path)
+          stale.close
+          expect(File.socket?(path)).to be true
+          server = TcpipServer.new(nil,8889,nil,nil,'Burst')
+          server.local_socket = true
+          server.connect
+          sleep 0.2
+          socket = UNIXSocket.new(path)
+          sleep 0.2
+          expect(server.num_clients).to eql 1
+          server.disconnect
+          socket.close
+          sleep(0.2)
+        end
+      end
+
+      it "does not start if the local socket directory is not private" do
+        unless Kernel.is_windows?
+          dir = TcpipSocketStream.create_local_socket_dir
+          File.chmod(0755, dir)
+          server = TcpipServer.new(nil,8889,nil,nil,'Burst')
+          server.local_socket = true
+          expect { server.connect }.to raise_error(/must be a directory owned by the current user/)
+          server.disconnect
+          File.chmod(0700, dir)
+        end
+      end
+    end
+
     describe "read_queue_size" do
       it "returns 0 if there is no read port" do
         server = TcpipServer.new(8888,nil,nil,nil,'Burst')
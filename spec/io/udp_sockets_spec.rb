@@ -48,6 +48,30 @@ module Cosmos
       end
     end
 
+    describe "write_batch" do
+      it "writes each datagram in order" do
+        udp_read  = UdpReadSocket.new(8888)
+        udp_write = UdpWriteSocket.new('127.0.0.1', 8888)
+        datagrams = (0...100).map {|index| [index].pack('n') }
+        udp_write.write_batch(datagrams, 2.0)
+        100.times {|index| expect(udp_read.read(2.0)).to eql [index].pack('n') }
+        udp_read.close
+        udp_write.close
+      end
+
+      it "sends the rest of the batch after a datagram fails" do
+        udp_read  = UdpReadSocket.new(8888)
+        udp_write = UdpWriteSocket.new('127.0.0.1', 8888)
+        errors = udp_write.write_batch(["\x01", "\x00" * 70000, "\x03"], 2.0)
+        expect(errors.keys).to eql [1]
+        expect(errors[1]).to be_a(SystemCallError)
+        expect(udp_read.read(2.0)).to eql "\x01"
+        expect(udp_read.read(2.0)).to eql "\x03"
+        udp_read.close
+        udp_write.close
+      end
+    end
+
     describe "multicast" do
       it "determines if a host is multicast" do
         expect(UdpWriteSocket.multicast?('127.0.0.1')).to be false
@@ -89,6 +113,44 @@ module Cosmos
       end
     end
 
+    describe "read_batch" do
+      it "reads the waiting datagrams" do
+        udp_read  = UdpReadSocket.new(8888, nil, nil, "0.0.0.0", 1_000_000)
+        udp_write = UdpWriteSocket.new('127.0.0.1', 8888)
+        datagrams = (0...10).map {|index| [index].pack('n') * (index + 1) }
+        udp_write.write_batch(datagrams, 2.0)
+        sleep 0.1
+        received = []
+        while received.length < datagrams.length
+          data, times = udp_read.read_batch(UdpReadSocket::BATCH_SIZE, 2.0)
+          expect(times.length).to eql data.length
+          times.each {|time| expect(time).to be_within(5.0).of(Time.now) if time }
+          received.concat(data)
+        end
+        expect(received).to eql datagrams
+        expect(udp_read.dropped).to eql 0
+        udp_read.close
+        udp_write.close
+      end
+
+      it "limits the number of datagrams read" do
+        udp_read  = UdpReadSocket.new(8888)
+        udp_write = UdpWriteSocket.new('127.0.0.1', 8888)
+        udp_write.write_batch(["\x01", "\x02", "\x03"], 2.0)
+        sleep 0.1
+        data, _ = udp_read.read_batch(1, 2.0)
+        expect(data).to eql ["\x01"]
+        udp_read.close
+        udp_write.close
+      end
+
+      it "handles timeouts" do
+        udp_read = UdpReadSocket.new(8889)
+        expect { udp_read.read_batch(UdpReadSocket::BATCH_SIZE, 0.1) }.to raise_error(Timeout::Error)
+        udp_read.close
+      end
+    end
+
   end
 end
 
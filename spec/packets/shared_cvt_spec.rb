@@ -0,0 +1,120 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos'
+require 'cosmos/packets/shared_cvt_telemetry'
+require 'tempfile'
+
+module Cosmos
+
+  describe SharedCvt do
+
+    before(:each) do
+      tf = Tempfile.new('unittest')
+      tf.puts 'TELEMETRY tgt1 pkt1 BIG_ENDIAN "TGT1 PKT1 Description"'
+      tf.puts '  APPEND_ID_ITEM item1 8 UINT 1 "Item1"'
+      tf.puts '  APPEND_ITEM item2 16 UINT "Item2"'
+      tf.puts '    LIMITS DEFAULT 1 ENABLED 1 2 4 5'
+      tf.puts 'TELEMETRY tgt1 pkt2 BIG_ENDIAN "TGT1 PKT2 Description"'
+      tf.puts '  APPEND_ID_ITEM item1 8 UINT 2 "Item1"'
+      tf.puts '  APPEND_ITEM item2 32 UINT "Item2"'
+      tf.close
+
+      @writer_config = PacketConfig.new
+      @writer_config.process_file(tf.path, "SYSTEM")
+      @reader_config = PacketConfig.new
+      @reader_config.process_file(tf.path, "SYSTEM")
+      tf.unlink
+
+      @filename = File.join(Dir.tmpdir, 'shared_cvt_spec.bin')
+      File.delete(@filename) if File.exist?(@filename)
+      @writer_tlm = Telemetry.new(@writer_config)
+      @writer = SharedCvt.new(@filename, @writer_tlm, true)
+    end
+
+    after(:each) do
+      @writer.close
+      File.delete(@filename) if File.exist?(@filename)
+    end
+
+    describe "initialize" do
+      it "complains if the file does not exist for readers" do
+        expect { SharedCvt.new(File.join(Dir.tmpdir, 'nope.bin'), Telemetry.new(@reader_config)) }.to raise_error(/does not exist/)
+      end
+
+      it "complains if the telemetry definitions do not match" do
+        tf = Tempfile.new('unittest')
+        tf.puts 'TELEMETRY tgt1 pkt1 BIG_ENDIAN "TGT1 PKT1 Description"'
+        tf.puts '  APPEND_ID_ITEM item1 64 UINT 1 "Item1"'
+        tf.close
+        config = PacketConfig.new
+        config.process_file(tf.path, "SYSTEM")
+        tf.unlink
+        expect { SharedCvt.new(@filename, Telemetry.new(config)) }.to raise_error(/does not match/)
+      end
+    end
+
+    describe "write and read" do
+      it "shares packets between the writer and reader" do
+        reader = SharedCvtTelemetry.new(@reader_config, @filename)
+        expect(reader.value("TGT1", "PKT1", "ITEM2")).to eql 0
+
+        packet = @writer_tlm.packet("TGT1", "PKT1")
+        packet.buffer = "\x01\x00\x03"
+        packet.received_time = Time.at(1000, 500)
+        packet.received_count = 5
+        @writer.write(packet)
+
+        expect(reader.value("TGT1", "PKT1", "ITEM2")).to eql 3
+        read_packet = reader.packet("TGT1", "PKT1")
+        expect(read_packet.received_time).to eql Time.at(1000, 500)
+        expect(read_packet.received_count).to eql 5
+        expect(read_packet.get_item("ITEM2").limits.state).to eql :GREEN
+        expect(reader.value("TGT1", "PKT2", "ITEM2")).to eql 0
+        reader.close
+      end
+
+      it "clears packets written by a previous writer" do
+        packet = @writer_tlm.packet("TGT1", "PKT1")
+        packet.buffer = "\x01\x00\x03"
+        @writer.write(packet)
+        @writer.close
+
+        @writer = SharedCvt.new(@filename, Telemetry.new(@writer_config), true)
+        reader = SharedCvt.new(@filename, Telemetry.new(@reader_config))
+        expect(reader.read("TGT1", "PKT1")).to be false
+        reader.close
+      end
+
+      it "reads the latest packets of a target" do
+        reader = SharedCvtTelemetry.new(@reader_config, @filename)
+        packet = @writer_tlm.packet("TGT1", "PKT2")
+        packet.buffer = "\x02\x00\x00\x00\x07"
+        packet.received_time = Time.now
+        @writer.write(packet)
+        expect(reader.value("TGT1", "LATEST", "ITEM2")).to eql 7
+        reader.close
+      end
+
+      it "does not publish packets larger than their defined length" do
+        reader = SharedCvtTelemetry.new(@reader_config, @filename)
+        packet = @writer_tlm.packet("TGT1", "PKT1")
+        packet.buffer = "\x01\x00\x03" + ("\x00" * 20)
+        expect(Logger).to receive(:warn).once
+        @writer.write(packet)
+        @writer.write(packet)
+        expect(reader.value("TGT1", "PKT1", "ITEM2")).to eql 0
+        reader.close
+      end
+    end
+
+  end
+end
@@ -378,6 +378,27 @@ module Cosmos
         expect(@tlm.packet("TGT1","PKT2").stale).to be false
         expect(@tlm.packet("TGT2","PKT1").stale).to be false
       end
+
+      it "marks packets stale once their deadline passes" do
+        allow(System).to receive(:staleness_seconds).and_return(0.5)
+        packet = @tlm.update!("TGT1","PKT1","\x01\x02\x03\x04")
+        packet.received_time = Time.now
+        packet.check_limits
+        expect(@tlm.check_stale).to be_empty
+        expect(@tlm.stale).not_to include(packet)
+        sleep 1.1
+        expect(@tlm.check_stale).to eql [packet]
+        expect(packet.stale).to be true
+        expect(@tlm.stale).to include(packet)
+        expect(@tlm.check_stale).to be_empty
+      end
+
+      it "does not check packets which have not been updated" do
+        packet = @tlm.packet("TGT1","PKT1")
+        packet.received_time = Time.now - 1000
+        packet.check_limits
+        expect(@tlm.check_stale).to be_empty
+      end
     end
 
     describe "stale" do
@@ -0,0 +1,78 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos/streams/buffered_tcpip_socket_stream'
+
+module Cosmos
+
+  describe BufferedTcpipSocketStream do
+    before(:each) do
+      @client, @server = UNIXSocket.pair
+    end
+
+    after(:each) do
+      @client.close unless @client.closed?
+      @server.close unless @server.closed?
+    end
+
+    describe "write" do
+      it "queues the data until it is flushed" do
+        stream = BufferedTcpipSocketStream.new(@server, nil, nil, nil)
+        stream.write("\x01\x02")
+        stream.writev(["\x03", "", "\x04"])
+        expect(stream.bytes_queued).to eql 4
+        expect(stream.write_pending?).to be true
+        expect(@client.read_nonblock(10, exception: false)).to eql :wait_readable
+        expect(stream.flush).to be true
+        expect(stream.bytes_queued).to eql 0
+        expect(@client.read_nonblock(10)).to eql "\x01\x02\x03\x04"
+      end
+
+      it "complains if there is no write socket" do
+        stream = BufferedTcpipSocketStream.new(nil, @server, nil, nil)
+        expect { stream.write("\x01") }.to raise_error(/read only/)
+      end
+    end
+
+    describe "flush" do
+      it "keeps the data the socket does not accept" do
+        stream = BufferedTcpipSocketStream.new(@server, nil, nil, nil)
+        data = "\x55" * 1_000_000
+        stream.write(data)
+        expect(stream.flush).to be false
+        expect(stream.stalled_for).to be >= 0.0
+        received = ''
+        while received.length < data.length
+          received << @client.readpartial(65536)
+          stream.flush
+        end
+        expect(received).to eql data
+        expect(stream.write_pending?).to be false
+        expect(stream.stalled_for).to eql 0.0
+      end
+    end
+
+    describe "lag" do
+      it "returns the age of the oldest data which has not been written" do
+        stream = BufferedTcpipSocketStream.new(@server, nil, nil, nil)
+        expect(stream.lag).to eql 0.0
+        stream.write("\x01\x02")
+        now = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+        expect(stream.lag(now + 1.0)).to be_within(0.1).of(1.0)
+        stream.write("\x03")
+        expect(stream.max_bytes_queued).to eql 3
+        expect(stream.flush).to be true
+        expect(stream.lag).to eql 0.0
+        expect(stream.max_bytes_queued).to eql 3
+      end
+    end
+  end
+end
@@ -0,0 +1,101 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos/streams/crc_check'
+require 'cosmos/streams/length_stream_protocol'
+
+module Cosmos
+
+  describe CrcCheck do
+    describe "initialize" do
+      it "complains about invalid parameters" do
+        expect { CrcCheck.new(8) }.to raise_error(ArgumentError, /bit size/)
+        expect { CrcCheck.new(16, nil, nil, nil, nil, -12) }.to raise_error(ArgumentError, /byte aligned/)
+        expect { CrcCheck.new(16, nil, nil, nil, nil, nil, 'BIG_ENDIAN', 'IGNORE') }.to raise_error(ArgumentError, /action/)
+      end
+
+      it "uses the default algorithm for the CRC size" do
+        check = CrcCheck.new(32)
+        expect(check.crc.poly).to eql Crc32::DEFAULT_POLY
+        expect(check.crc.xor).to be true
+        expect(check.crc.reflect).to be true
+        check = CrcCheck.new('16', '0x8005', '0', 'TRUE', 'TRUE')
+        expect(check.crc.poly).to eql 0x8005
+        expect(check.crc.seed).to eql 0
+        expect(check.crc.xor).to be true
+      end
+    end
+
+    describe "process" do
+      it "accepts a frame with a matching CRC at the end" do
+        check = CrcCheck.new
+        expect(check.process("123456789\x29\xB1")).to be true
+        expect(check.failures).to eql 0
+      end
+
+      it "calculates from the start offset to the CRC field" do
+        check = CrcCheck.new(16, nil, nil, nil, nil, -16, 'LITTLE_ENDIAN', 'ERROR', 2)
+        expect(check.process("\xAA\xBB123456789\xB1\x29")).to be true
+        check = CrcCheck.new(16, nil, nil, nil, nil, 88, 'LITTLE_ENDIAN', 'ERROR', 2)
+        expect(check.process("\xAA\xBB123456789\xB1\x29\xEE")).to be true
+      end
+
+      it "takes the configured action on a mismatch" do
+        check = CrcCheck.new
+        expect { check.process("123456789\x00\x00") }.to raise_error(/CRC mismatch: received 0x0, calculated 0x29B1/)
+        expect(check.failures).to eql 1
+
+        check = CrcCheck.new(16, nil, nil, nil, nil, nil, 'BIG_ENDIAN', 'DISCARD')
+        expect(Logger).to receive(:error).with(/CRC mismatch/)
+        expect(check.process("123456789\x00\x00")).to be false
+
+        check = CrcCheck.new(16, nil, nil, nil, nil, nil, 'BIG_ENDIAN', 'WARN')
+        expect(Logger).to receive(:warn).with(/too short/)
+        expect(check.process("\x00")).to be true
+        expect(check.failures).to eql 1
+      end
+
+      it "drops packets read by a stream protocol" do
+        class CrcStream < Stream
+          def connect; end
+          def connected?; true; end
+          def read; "\x00\x0D123456789\x29\xB1\x00\x0D123456789\x00\x00"; end
+        end
+        lsp = LengthStreamProtocol.new(0, 16)
+        lsp.crc_check = CrcCheck.new(16, nil, nil, nil, nil, nil, 'BIG_ENDIAN', 'DISCARD', 2)
+        allow(Logger).to receive(:error)
+        lsp.connect(CrcStream.new)
+        expect(lsp.read.buffer).to eql "\x00\x0D123456789\x29\xB1"
+        expect(lsp.read.buffer).to eql "\x00\x0D123456789\x29\xB1"
+        expect(lsp.crc_check.failures).to eql 1
+      end
+
+      it "checks a dropped packet only once when receiving partial packets" do
+        class CrcReceiveStream < Stream
+          def connect; end
+          def connected?; true; end
+          def read; raise "Unexpected read"; end
+        end
+        lsp = LengthStreamProtocol.new(0, 16)
+        lsp.crc_check = CrcCheck.new(16, nil, nil, nil, nil, nil, 'BIG_ENDIAN', 'DISCARD', 2)
+        allow(Logger).to receive(:error)
+        lsp.connect(CrcReceiveStream.new)
+        # A bad frame followed by a partial packet
+        expect(lsp.receive("\x00\x0D123456789\x00\x00\x00")).to eql []
+        expect(lsp.receive("\x0D12")).to eql []
+        packets = lsp.receive("3456789\x29\xB1")
+        expect(packets.length).to eql 1
+        expect(packets[0].buffer).to eql "\x00\x0D123456789\x29\xB1"
+        expect(lsp.crc_check.failures).to eql 1
+      end
+    end
+  end
+end
@@ -165,6 +165,131 @@ module Cosmos
       end
     end
 
+    describe "read_batch" do
+      it "frames every complete packet from a single stream read" do
+        class MyBatchStream < Stream
+          def connect; end
+          def connected?; true; end
+          def read
+            $index += 1
+            case $index
+            when 1
+              "\x00\x01\x00\x03\x00\x02\x00\x04\x05\x00\x03\x00"
+            when 2
+              "\x04\x06"
+            else
+              ""
+            end
+          end
+        end
+        stream = MyBatchStream.new
+
+        lsp = LengthStreamProtocol.new(16, 16, 1, 1, 'BIG_ENDIAN')
+        lsp.connect(stream)
+        $index = 0
+        packets = lsp.read_batch
+        expect(packets.length).to eql 2
+        expect(packets[0].buffer).to eql "\x00\x01\x00\x03"
+        expect(packets[1].buffer).to eql "\x00\x02\x00\x04\x05"
+        # The partial packet is left for the next read
+        expect($index).to eql 1
+        packets = lsp.read_batch
+        expect(packets.length).to eql 1
+        expect(packets[0].buffer).to eql "\x00\x03\x00\x04\x06"
+        expect(lsp.read_batch).to be_nil
+      end
+
+      it "limits the number of packets returned" do
+        class MyBatchStream2 < Stream
+          def connect; end
+          def connected?; true; end
+          def read; "\x00\x01\x00\x03" * 5; end
+        end
+        stream = MyBatchStream2.new
+
+        lsp = LengthStreamProtocol.new(16, 16, 1, 1, 'BIG_ENDIAN')
+        lsp.connect(stream)
+        expect(lsp.read_batch(3).length).to eql 3
+        expect(lsp.read_batch(3).length).to eql 2
+      end
+
+      it "returns the frames before a length larger than max_length" do
+        class MyBatchStream3 < Stream
+          def connect; end
+          def connected?; true; end
+          def read; "\x00\x03\x01\x02\x00\x03\x03\x04\x00\x40"; end
+        end
+        stream = MyBatchStream3.new
+
+        lsp = LengthStreamProtocol.new(0, 16, 1, 1, 'BIG_ENDIAN', 0, nil, 10)
+        lsp.connect(stream)
+        packets = lsp.read_batch
+        expect(packets.length).to eql 2
+        expect(packets[1].buffer).to eql "\x00\x03\x03\x04"
+        expect { lsp.read_batch }.to raise_error(RuntimeError, "Length value received larger than max_length: 64 > 10")
+      end
+    end
+
+    describe "receive" do
+      it "frames the packets completed by data read elsewhere" do
+        class MyReceiveStream < Stream
+          def connect; end
+          def connected?; true; end
+          def read; raise "Unexpected read"; end
+        end
+
+        lsp = LengthStreamProtocol.new(16, 16, 1, 1, 'BIG_ENDIAN')
+        lsp.connect(MyReceiveStream.new)
+        packets = lsp.receive("\x00\x01\x00\x03\x00\x02\x00")
+        expect(packets.length).to eql 1
+        expect(packets[0].buffer).to eql "\x00\x01\x00\x03"
+        expect(lsp.receive("\x04")).to eql []
+        packets = lsp.receive("\x05")
+        expect(packets[0].buffer).to eql "\x00\x02\x00\x04\x05"
+        expect(lsp.bytes_read).to eql 9
+      end
+
+      it "discards data before a sync pattern only once" do
+        class MyReceiveStream2 < Stream
+          def connect; end
+          def connected?; true; end
+          def read; raise "Unexpected read"; end
+        end
+
+        lsp = LengthStreamProtocol.new(16, 16, 1, 1, 'BIG_ENDIAN', 0, '0x1234')
+        lsp.connect(MyReceiveStream2.new)
+        expect(lsp.receive("\x12\x34\x00\x03").length).to eql 1
+        # The discarded bytes are followed by a partial packet
+        expect(lsp.receive("\xFF\xFF\x12\x34")).to eql []
+        expect(lsp.receive("\x00")).to eql []
+        packets = lsp.receive("\x03")
+        expect(packets[0].buffer).to eql "\x12\x34\x00\x03"
+        expect(lsp.bytes_discarded).to eql 2
+      end
+
+      it "does not return framed packets again after an error" do
+        class MyReceiveStream3 < Stream
+          def connect; end
+          def connected?; true; end
+          def read; raise "Unexpected read"; end
+        end
+        class MyRaisingLengthStreamProtocol < LengthStreamProtocol
+          def post_read_data(packet_data)
+            raise "Bad packet" if packet_data == "\x00\x01\x00\x03"
+            packet_data
+          end
+        end
+
+        lsp = MyRaisingLengthStreamProtocol.new(16, 16, 1, 1, 'BIG_ENDIAN')
+        lsp.connect(MyReceiveStream3.new)
+        expect { lsp.receive("\x00\x01\x00\x03\x00\x02\x00\x04\x05\x00\x03\x00\x04\x06") }.to raise_error("Bad packet")
+        packets = lsp.receive("")
+        expect(packets.length).to eql 2
+        expect(packets[0].buffer).to eql "\x00\x02\x00\x04\x05"
+        expect(packets[1].buffer).to eql "\x00\x03\x00\x04\x06"
+      end
+    end
+
     describe "write" do
       it "fills the length field and sync pattern if told to" do
         class MyStream < Stream
@@ -293,6 +418,33 @@ module Cosmos
         expect(MyStream.written_data).to eql("\xBA\x5E\xBA\x11\xCA\xFE\xBA\xBE\x00\x00\x00\x04\x01\x02\x03\x04")
         expect(packet.buffer).to eql("\xBA\x5E\xBA\x11\xCA\xFE\xBA\xBE\x00\x00\x00\x04\x01\x02\x03\x04")
       end
+
+      it "writes the discarded header separately from the packet buffer" do
+        class MySegmentStream < Stream
+          attr_reader :segments
+          def connect; end
+          def connected?; true; end
+          def writev(segments); @segments = segments; end
+        end
+        stream = MySegmentStream.new
+
+        lsp = LengthStreamProtocol.new(32, # bit offset
+                                        16, # bit size
+                                        6,  # length offset
+                                        2,  # bytes per count
+                                        'BIG_ENDIAN',
+                                        6,  # discard 6 leading bytes (sync and length)
+                                        "BA5EBA11",
+                                        nil,
+                                        true)
+        lsp.connect(stream)
+        packet = Packet.new(nil, nil)
+        packet.buffer = "\x01\x02\x03\x04"
+        lsp.write(packet)
+        expect(stream.segments).to eql ["\xBA\x5E\xBA\x11\x00\x02", "\x01\x02\x03\x04"]
+        expect(stream.segments[1]).to equal packet.buffer(false)
+        expect(lsp.bytes_written).to eql 10
+      end
     end
 
   end
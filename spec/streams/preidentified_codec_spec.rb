@@ -0,0 +1,71 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos/streams/preidentified_codec'
+require 'cosmos/streams/receive_buffer'
+
+module Cosmos
+
+  describe PreidentifiedCodec do
+    describe "encode_header" do
+      it "appends the header to the buffer" do
+        buffer = "\xA5"
+        PreidentifiedCodec.encode_header(buffer, 5, 6, 'TGT', 'PKT', 3)
+        expect(buffer).to eql "\xA5\x00\x00\x00\x05\x00\x00\x00\x06\x03TGT\x03PKT\x00\x00\x00\x03"
+      end
+
+      it "complains about names longer than 255 bytes" do
+        expect { PreidentifiedCodec.encode_header('', 0, 0, 'T' * 256, 'PKT', 0) }.to raise_error(ArgumentError, /target name/)
+        expect { PreidentifiedCodec.encode_header('', 0, 0, 'TGT', 'P' * 256, 0) }.to raise_error(ArgumentError, /packet name/)
+      end
+    end
+
+    describe "decode_header" do
+      it "decodes a header at an offset" do
+        buffer = "\xA5" + PreidentifiedCodec.encode_header('', 5, 6, 'TGT', 'PKT', 3) + "\x01\x02\x03"
+        expect(PreidentifiedCodec.decode_header(buffer, 1)).to eql [20, 5, 6, 'TGT', 'PKT', 3]
+      end
+
+      it "returns nil for an incomplete header" do
+        header = PreidentifiedCodec.encode_header('', 5, 6, 'TGT', 'PKT', 3)
+        expect(PreidentifiedCodec.decode_header(header[0..-2])).to be_nil
+      end
+
+      it "returns binary names" do
+        header = PreidentifiedCodec.encode_header('', 5, 6, 'TGT', 'PKT', 3)
+        names = PreidentifiedCodec.decode_header(header)[3..4]
+        expect(names.map {|name| name.encoding }).to eql [Encoding::ASCII_8BIT] * 2
+      end
+    end
+
+    describe "decode_frame" do
+      it "removes a complete entry from the receive buffer" do
+        entry = PreidentifiedCodec.encode_header('', 5, 6, 'TGT', 'PKT', 3) + "\x01\x02\x03"
+        buffer = ReceiveBuffer.new
+        buffer << entry[0..9]
+        expect(PreidentifiedCodec.decode_frame(buffer, nil)).to eql 13
+        buffer << entry[10..-1]
+        expect(PreidentifiedCodec.decode_frame(buffer, nil)).to eql [5, 6, 'TGT', 'PKT', "\x01\x02\x03"]
+        expect(buffer.empty?).to be true
+      end
+
+      it "complains if the data is longer than max_length" do
+        buffer = ReceiveBuffer.new
+        buffer << PreidentifiedCodec.encode_header('', 5, 6, 'TGT', 'PKT', 11)
+        expect { PreidentifiedCodec.decode_frame(buffer, 10) }.to raise_error(RuntimeError, "Length value received larger than max_length: 11 > 10")
+      end
+
+      it "complains if not given a receive buffer" do
+        expect { PreidentifiedCodec.decode_frame('', nil) }.to raise_error(TypeError)
+      end
+    end
+  end
+end
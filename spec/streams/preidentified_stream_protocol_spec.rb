@@ -84,6 +84,20 @@ module Cosmos
         offset += 4
         expect($buffer[offset..-1]).to eql pkt.buffer
       end
+
+      it "writes the header separately from the packet buffer" do
+        pkt = System.telemetry.packet("COSMOS","VERSION")
+        class MySegmentStream < Stream
+          def connect; end
+          def connected?; true; end
+          def writev(segments); $segments = segments; end
+        end
+        @psp.connect(MySegmentStream.new)
+        @psp.write(pkt)
+        expect($segments.length).to eql 2
+        expect($segments[1]).to equal pkt.buffer(false)
+        expect(@psp.bytes_written).to eql($segments[0].length + pkt.length)
+      end
     end
 
     describe "read" do
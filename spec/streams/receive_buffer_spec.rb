@@ -0,0 +1,210 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos/streams/receive_buffer'
+
+module Cosmos
+
+  describe ReceiveBuffer do
+    before(:each) do
+      @buffer = ReceiveBuffer.new(8)
+    end
+
+    describe "initialize" do
+      it "creates an empty buffer" do
+        expect(ReceiveBuffer.new.length).to eql 0
+        expect(@buffer.empty?).to be true
+      end
+
+      it "complains about an invalid capacity" do
+        expect { ReceiveBuffer.new(0) }.to raise_error(ArgumentError, /capacity/)
+      end
+    end
+
+    describe "<<" do
+      it "appends data and grows as needed" do
+        @buffer << "\x01\x02\x03"
+        @buffer << "\x04\x05\x06\x07\x08\x09\x0A"
+        expect(@buffer.length).to eql 10
+        expect(@buffer.to_s).to eql "\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0A"
+      end
+
+      it "keeps unread data when compacting" do
+        @buffer << "\x01\x02\x03\x04\x05\x06"
+        @buffer.discard(5)
+        @buffer << "\x07\x08\x09\x0A"
+        expect(@buffer.to_s).to eql "\x06\x07\x08\x09\x0A"
+      end
+    end
+
+    describe "getbyte" do
+      it "returns bytes relative to the first unread byte" do
+        @buffer << "\x01\x02\x03"
+        @buffer.discard(1)
+        expect(@buffer.getbyte(0)).to eql 2
+        expect(@buffer.getbyte(1)).to eql 3
+        expect(@buffer.getbyte(2)).to be_nil
+      end
+    end
+
+    describe "index" do
+      it "finds a pattern in the unread data" do
+        @buffer << "\xAA\x1A\xCF\x1A\xCF\xFC\x1D"
+        @buffer.discard(1)
+        expect(@buffer.index("\x1A\xCF\xFC")).to eql 2
+        expect(@buffer.index("\x1A", 1)).to eql 2
+        expect(@buffer.index("\xAA")).to be_nil
+        expect(@buffer.index("\x1D\x00")).to be_nil
+      end
+    end
+
+    describe "peek" do
+      it "copies data without consuming it" do
+        @buffer << "\x01\x02\x03\x04"
+        expect(@buffer.peek(1, 2)).to eql "\x02\x03"
+        expect(@buffer.peek(2, 10)).to eql "\x03\x04"
+        expect(@buffer.peek(5, 1)).to be_nil
+        expect(@buffer.length).to eql 4
+      end
+    end
+
+    describe "shift" do
+      it "removes and returns data" do
+        @buffer << "\x01\x02\x03\x04"
+        data = @buffer.shift(3)
+        expect(data).to eql "\x01\x02\x03"
+        expect(data.encoding).to eql Encoding::ASCII_8BIT
+        expect(@buffer.shift(3)).to eql "\x04"
+        expect(@buffer.empty?).to be true
+      end
+    end
+
+    describe "clear" do
+      it "removes all the data" do
+        @buffer << "\x01\x02\x03\x04"
+        @buffer.clear
+        expect(@buffer.length).to eql 0
+      end
+    end
+
+    describe "rewind" do
+      it "restores data consumed since a checkpoint" do
+        @buffer << "\x01\x02\x03\x04"
+        @buffer.discard(1)
+        checkpoint = @buffer.checkpoint
+        @buffer.shift(2)
+        @buffer.rewind(checkpoint)
+        expect(@buffer.to_s).to eql "\x02\x03\x04"
+        expect { @buffer.rewind(checkpoint + 1) }.to raise_error(ArgumentError)
+      end
+    end
+  end
+
+  describe ReceiveBuffer do
+    describe "String compatibility" do
+      before(:each) do
+        @buffer = ReceiveBuffer.new(8)
+        @buffer << "\x00\x01\x02\x03\x04\x05"
+        @buffer.discard(1)
+      end
+
+      it "slices the unread data like a String" do
+        expect(@buffer[0]).to eql "\x01"
+        expect(@buffer[0..1]).to eql "\x01\x02"
+        expect(@buffer[1, 2]).to eql "\x02\x03"
+        expect(@buffer[-2..-1]).to eql "\x04\x05"
+        expect(@buffer[10..-1]).to be_nil
+      end
+
+      it "replaces the unread data" do
+        @buffer.replace(@buffer[2..-1])
+        expect(@buffer.to_s).to eql "\x03\x04\x05"
+        @buffer.replace('')
+        expect(@buffer.length).to eql 0
+      end
+
+      it "converts to a String implicitly" do
+        expect("\xFF" + @buffer).to eql "\xFF\x01\x02\x03\x04\x05"
+      end
+
+      it "copies the unread data when cloned" do
+        copy = @buffer.clone
+        @buffer.clear
+        expect(copy.to_s).to eql "\x01\x02\x03\x04\x05"
+      end
+    end
+  end
+
+  describe LengthFramer do
+    describe "initialize" do
+      it "complains about length fields which are not byte aligned" do
+        expect { LengthFramer.new(4, 16, 0, 1, :BIG_ENDIAN, nil, nil) }.to raise_error(ArgumentError, /bit_offset/)
+        expect { LengthFramer.new(8, 12, 0, 1, :BIG_ENDIAN, nil, nil) }.to raise_error(ArgumentError, /bit_size/)
+      end
+    end
+
+    describe "frame" do
+      it "removes all the complete frames" do
+        framer = LengthFramer.new(8, 16, 3, 1, :LITTLE_ENDIAN, nil, "\xA5")
+        buffer = ReceiveBuffer.new
+        buffer << "\xA5\x01\x00\x01\xA5\x02\x00\x01\x02\xA5\x03"
+        frames = []
+        expect(framer.frame(buffer, frames)).to eql 3
+        expect(frames).to eql ["\xA5\x01\x00\x01", "\xA5\x02\x00\x01\x02"]
+        expect(buffer.to_s).to eql "\xA5\x03"
+      end
+
+      it "stops at a frame without the sync pattern" do
+        framer = LengthFramer.new(8, 8, 0, 1, :BIG_ENDIAN, nil, "\xA5")
+        buffer = ReceiveBuffer.new
+        buffer << "\xA5\x02\x00\xA5"
+        frames = []
+        framer.frame(buffer, frames)
+        expect(frames).to eql ["\xA5\x02"]
+        expect(buffer.to_s).to eql "\x00\xA5"
+      end
+    end
+  end
+
+  describe TerminatedFramer do
+    describe "frame" do
+      it "removes all the complete lines" do
+        framer = TerminatedFramer.new("\r\n", true, nil)
+        buffer = ReceiveBuffer.new
+        buffer << "A\r\n\r\rB\r\nC\r"
+        frames = []
+        framer.frame(buffer, frames)
+        expect(frames).to eql ["A", "\r\rB"]
+        expect(buffer.to_s).to eql "C\r"
+      end
+
+      it "keeps the termination characters" do
+        framer = TerminatedFramer.new("\r\n", false, nil)
+        buffer = ReceiveBuffer.new
+        buffer << "A\r\nB\r\n"
+        frames = []
+        framer.frame(buffer, frames)
+        expect(frames).to eql ["A\r\n", "B\r\n"]
+        expect(buffer.empty?).to be true
+      end
+
+      it "stops at a line without the sync pattern" do
+        framer = TerminatedFramer.new("\n", true, "$")
+        buffer = ReceiveBuffer.new
+        buffer << "$A\nX$B\n"
+        frames = []
+        framer.frame(buffer, frames)
+        expect(frames).to eql ["$A"]
+        expect(buffer.to_s).to eql "X$B\n"
+      end
+    end
+  end
+end
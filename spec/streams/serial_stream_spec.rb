@@ -46,6 +46,22 @@ module Cosmos
       end
     end
 
+    describe "read buffer" do
+      it "passes the read buffer options to the read port only" do
+        expect(SerialDriver).to receive(:new).with('COM1',9600,:EVEN,1,nil,nil,0,nil).and_return(double("write"))
+        expect(SerialDriver).to receive(:new).with('COM2',9600,:EVEN,1,nil,nil,1000,0.1).and_return(double("read"))
+        SerialStream.new('COM1','COM2',9600,:EVEN,1,nil,nil,'1000','0.1')
+      end
+
+      it "returns the error counts of the read port" do
+        driver = double("driver")
+        expect(driver).to receive(:error_counts).and_return({:overrun => 1})
+        expect(SerialDriver).to receive(:new).and_return(driver)
+        ss = SerialStream.new('COM1','COM1',9600,:EVEN,1,nil,nil)
+        expect(ss.error_counts).to eql({:overrun => 1})
+      end
+    end
+
     describe "write" do
       it "raises an error if no write port given" do
         driver = double("driver")
@@ -61,6 +77,15 @@ module Cosmos
         ss = SerialStream.new('COM1','COM1',9600,:EVEN,1,nil,nil)
         ss.write('test')
       end
+
+      it "writes each segment to the driver" do
+        driver = double("driver")
+        expect(driver).to receive(:write).with('te').ordered
+        expect(driver).to receive(:write).with('st').ordered
+        expect(SerialDriver).to receive(:new).and_return(driver)
+        ss = SerialStream.new('COM1','COM1',9600,:EVEN,1,nil,nil)
+        ss.writev(['te', 'st'])
+      end
     end
 
     describe "disconnect" do
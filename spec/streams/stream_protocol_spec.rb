@@ -205,6 +205,26 @@ module Cosmos
         expect(packet.length).to eql 3 # sync plus one byte
       end
 
+      it "rate limits logging of discarded data" do
+        class MyStream11 < Stream
+          def connect; end
+          def connected?; true; end
+          def read; "\x00\x12\x34\x01"; end
+        end
+        @sp = StreamProtocol.new(0, '0x1234')
+        stream = MyStream11.new
+        @sp.connect(stream)
+        messages = []
+        allow(Logger).to receive(:error) {|msg| messages << msg }
+        10.times do
+          packet = @sp.read
+          expect(packet.length).to eql 3
+        end
+        expect(@sp.bytes_discarded).to eql 10
+        expect(messages.length).to eql 1
+        expect(messages[0]).to eql "Sync found. Discarding 1 bytes of data."
+      end
+
       it "discards leading bytes from the stream" do
         class MyStream8 < Stream
           def connect; end
@@ -327,6 +347,24 @@ module Cosmos
       end
     end
 
+    describe "encode" do
+      it "returns the data to write without writing it" do
+        $buffer = nil
+        class MyStream11 < Stream
+          def connect; end
+          def connected?; true; end
+          def write(buffer) $buffer = buffer; end
+        end
+        packet = Packet.new(nil, nil, :BIG_ENDIAN, nil, "\x01\x02\x03\x04")
+        @sp.connect(MyStream11.new)
+        data = @sp.encode(packet)
+        expect(data).to eql "\x01\02\03\04"
+        expect($buffer).to be_nil
+        @sp.write_encoded(packet, data)
+        expect($buffer).to eql "\x01\02\03\04"
+      end
+    end
+
     describe "write_raw" do
       it "writes the raw buffer to the stream" do
         $buffer = ''
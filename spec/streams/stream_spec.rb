@@ -25,6 +25,14 @@ module Cosmos
       end
     end
 
+    describe "writev" do
+      it "writes the joined segments" do
+        stream = Stream.new
+        expect(stream).to receive(:write).with("abcd")
+        stream.writev(["ab", "cd"])
+      end
+    end
+
   end
 end
 
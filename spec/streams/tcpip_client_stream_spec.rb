@@ -51,6 +51,84 @@ module Cosmos
         expect(ss.connected?).to be true
         ss.disconnect
       end
+
+      it "connects to a local socket" do
+        unless Kernel.is_windows?
+          TcpipSocketStream.create_local_socket_dir
+          path = TcpipSocketStream.local_socket_path(8890)
+          File.delete(path) if File.exist?(path)
+          server = UNIXServer.new(path)
+          ss = TcpipClientStream.new('localhost',8890,8890,nil,nil,5.0,true)
+          ss.connect
+          expect(ss.connected?).to be true
+          client = server.accept
+          ss.write("\x01\x02")
+          expect(client.read(2)).to eql "\x01\x02"
+          client.write("\x03\x04")
+          expect(ss.read).to eql "\x03\x04"
+          ss.disconnect
+          client.close
+          server.close
+          File.delete(path)
+        end
+      end
+
+      it "connects to the TCP port if the local socket can not be connected" do
+        unless Kernel.is_windows?
+          TcpipSocketStream.create_local_socket_dir
+          path = TcpipSocketStream.local_socket_path(8892)
+          File.delete(path) if File.exist?(path)
+          # Leave a socket file behind which nothing is listening on
+          UNIXServer.new(path).close
+          server = TCPServer.new('127.0.0.1', 8892)
+          ss = TcpipClientStream.new('localhost',8892,8892,nil,nil,5.0,true)
+          ss.connect
+          expect(ss.connected?).to be true
+          expect(ss.write_socket.local_address.ipv4?).to be true
+          client = server.accept
+          ss.write("\x01\x02")
+          expect(client.read(2)).to eql "\x01\x02"
+          ss.disconnect
+          client.close
+          server.close
+          File.delete(path)
+        end
+      end
+
+      it "only connects to a local socket for loopback hostnames" do
+        unless Kernel.is_windows?
+          TcpipSocketStream.create_local_socket_dir
+          path = TcpipSocketStream.local_socket_path(8893)
+          File.delete(path) if File.exist?(path)
+          server = UNIXServer.new(path)
+          ss = TcpipClientStream.new('127.0.0.1',8893,8893,nil,nil,5.0,true)
+          expect(ss.write_socket.local_address.unix?).to be true
+          ss.disconnect
+          ss = TcpipClientStream.new('10.0.0.1',8893,8893,nil,nil,5.0,true)
+          expect(ss.write_socket.local_address.ipv4?).to be true
+          ss.disconnect
+          server.close
+          File.delete(path)
+        end
+      end
+
+      it "does not connect to a local socket other users can access" do
+        unless Kernel.is_windows?
+          dir = TcpipSocketStream.create_local_socket_dir
+          path = TcpipSocketStream.local_socket_path(8894)
+          File.delete(path) if File.exist?(path)
+          server = UNIXServer.new(path)
+          expect(TcpipSocketStream.local_socket?(8894)).to be true
+          File.chmod(0755, dir)
+          expect(TcpipSocketStream.local_socket?(8894)).to be false
+          ss = TcpipClientStream.new('localhost',8894,8894,nil,nil,5.0,true)
+          expect(ss.write_socket.local_address.ipv4?).to be true
+          ss.disconnect
+          File.chmod(0700, dir)
+          server.close
+          File.delete(path)
+        end
+      end
     end
   end
 end
@@ -179,6 +179,39 @@ module Cosmos
       end
     end
 
+    describe "writev" do
+      it "writes the segments without joining them" do
+        write = double("write_socket")
+        sent = []
+        # Simulate only writing three bytes at a time
+        allow(write).to receive(:writev_nonblock) do |segments|
+          sent << segments.dup
+          3
+        end
+        ss = TcpipSocketStream.new(write,nil,nil,nil)
+        ss.connect
+        ss.writev(['ab', '', 'cdef'])
+        expect(sent).to eql [['ab', '', 'cdef'], ['def']]
+      end
+
+      it "joins the segments if writev is not supported" do
+        write = double("write_socket")
+        expect(write).to receive(:write_nonblock).with('abcd').and_return(4)
+        ss = TcpipSocketStream.new(write,nil,nil,nil)
+        ss.connect
+        ss.writev(['ab', 'cd'])
+      end
+
+      it "handles socket timeouts" do
+        write = double("write_socket")
+        allow(write).to receive(:writev_nonblock).and_raise(Errno::EWOULDBLOCK)
+        expect(IO).to receive(:select).at_least(:once).and_return(nil)
+        ss = TcpipSocketStream.new(write,nil,nil,nil)
+        ss.connect
+        expect { ss.writev(['test']) }.to raise_error(Timeout::Error)
+      end
+    end
+
     describe "disconnect" do
       it "closes the write socket" do
         write = double("write_socket")
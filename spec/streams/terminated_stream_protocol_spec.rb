@@ -85,6 +85,36 @@ module Cosmos
       end
     end
 
+    describe "read_batch" do
+      it "splits every complete line from a single stream read" do
+        class MyBatchStream < Stream
+          def connect; end
+          def connected?; true; end
+          def read
+            $index += 1
+            case $index
+            when 1
+              "LINE1\r\nLINE2\r\nLI"
+            when 2
+              "NE3\r\n"
+            else
+              ""
+            end
+          end
+        end
+        stream = MyBatchStream.new
+
+        lsp = TerminatedStreamProtocol.new('0x0D0A', '0x0D0A', true)
+        lsp.connect(stream)
+        $index = 0
+        packets = lsp.read_batch
+        expect(packets.map {|packet| packet.buffer }).to eql %w(LINE1 LINE2)
+        packets = lsp.read_batch
+        expect(packets.map {|packet| packet.buffer }).to eql %w(LINE3)
+        expect(lsp.read_batch).to be_nil
+      end
+    end
+
     describe "write" do
       it "appends termination characters to the packet" do
         class MyStream < Stream
@@ -0,0 +1,50 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos/streams/tm_frame_framer'
+
+module Cosmos
+
+  describe TmFrameFramer do
+    describe "frame" do
+      it "removes every complete frame" do
+        framer = TmFrameFramer.new(14, "\xA5", false)
+        packet = "\x08\x01\xC0\x00\x00\x01\x01\x02"
+        buffer = ReceiveBuffer.new
+        buffer << "\xA5\x00\x02\x00\x00\x00\x00" + packet + "\xA5\x00"
+        frames = []
+        expect(framer.frame(buffer, frames)).to eql 15
+        expect(frames).to eql [packet]
+        expect(buffer.to_s).to eql "\xA5\x00"
+        expect(framer.stats(1)[:frames]).to eql 1
+      end
+
+      it "returns 0 if the data does not start with the sync pattern" do
+        framer = TmFrameFramer.new(14, "\xA5", false)
+        buffer = ReceiveBuffer.new
+        buffer << "\x00" * 15
+        expect(framer.frame(buffer, [])).to eql 0
+        expect(buffer.length).to eql 15
+      end
+
+      it "complains if not given a receive buffer" do
+        framer = TmFrameFramer.new(14, "\xA5", false)
+        expect { framer.frame("\xA5" * 15, []) }.to raise_error(TypeError)
+      end
+    end
+
+    describe "stats" do
+      it "complains about an invalid virtual channel" do
+        expect { TmFrameFramer.new(14, nil, false).stats(8) }.to raise_error(ArgumentError)
+      end
+    end
+  end
+end
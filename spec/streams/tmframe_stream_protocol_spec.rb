@@ -0,0 +1,129 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos/streams/tmframe_stream_protocol'
+require 'cosmos/streams/stream'
+require 'cosmos/utilities/crc'
+
+module Cosmos
+
+  describe TmframeStreamProtocol do
+    class TmframeStream < Stream
+      def connect; end
+      def connected?; true; end
+      def read; ($buffers.shift || ''); end
+    end
+
+    TM_FRAME_LENGTH = 24
+    TM_SYNC = "\x1A\xCF\xFC\x1D"
+
+    def space_packet(apid, data)
+      [0x0800 | apid, 0xC000, data.length - 1].pack('nnn') << data
+    end
+
+    def idle_packet(length)
+      space_packet(0x7FF, "\x00" * (length - 6))
+    end
+
+    # Build a frame on the given virtual channel. The data field is 18 bytes
+    # or 16 bytes with an FECF.
+    def frame(vcid, count, first_header_pointer, data, fecf = false)
+      frame = [vcid << 1, count, count, first_header_pointer].pack('nCCn') << data
+      frame << [Crc16.new.calc(frame)].pack('n') if fecf
+      frame
+    end
+
+    before(:each) do
+      @stream = TmframeStream.new
+      # 11 bytes followed by 16 bytes so the second packet spans two frames
+      @packet1 = space_packet(1, "\x01" * 5)
+      @packet2 = space_packet(2, "\x02" * 10)
+      @data = @packet2 + @packet1
+    end
+
+    describe "initialize" do
+      it "complains about frames too short to hold a header" do
+        expect { TmframeStreamProtocol.new(6) }.to raise_error(ArgumentError, /frame_length/)
+      end
+    end
+
+    describe "read" do
+      it "returns the packets in each frame without the idle packets" do
+        $buffers = [TM_SYNC + frame(1, 0, 0, @packet1 + idle_packet(7))]
+        tsp = TmframeStreamProtocol.new(TM_FRAME_LENGTH)
+        tsp.connect(@stream)
+        expect(tsp.read.buffer).to eql @packet1
+        expect(tsp.read).to be_nil
+        expect(tsp.frame_stats(1)[:packets]).to eql 1
+      end
+
+      it "reassembles packets which span frames of a virtual channel" do
+        $buffers = [TM_SYNC + frame(1, 0, 0, @data[0, 18]) +
+                    TM_SYNC + frame(2, 0, 0x7FE, "\x00" * 18),
+                    TM_SYNC + frame(1, 1, 9, @data[18..-1] + idle_packet(9))]
+        tsp = TmframeStreamProtocol.new(TM_FRAME_LENGTH)
+        tsp.connect(@stream)
+        expect(tsp.read.buffer).to eql @packet2
+        expect(tsp.read.buffer).to eql @packet1
+        expect(tsp.frame_stats(2)[:idle_frames]).to eql 1
+        expect(tsp.frame_stats[:frames]).to eql 3
+      end
+
+      it "discards packets missing data from a lost frame" do
+        $buffers = [frame(3, 0, 0, @data[0, 18]) + frame(3, 2, 9, @data[18..-1] + idle_packet(9))]
+        tsp = TmframeStreamProtocol.new(TM_FRAME_LENGTH, nil)
+        tsp.connect(@stream)
+        expect(tsp.read.buffer).to eql @packet2
+        expect(tsp.read).to be_nil
+        stats = tsp.frame_stats(3)
+        expect(stats[:lost_frames]).to eql 1
+        expect(stats[:discarded]).to eql 1
+      end
+
+      it "drops frames whose FECF does not match" do
+        packet = space_packet(1, "\x01" * 3)
+        bad = frame(1, 0, 0, packet + idle_packet(7), true)
+        bad[8] = "\x55"
+        $buffers = [TM_SYNC + bad + TM_SYNC + frame(1, 1, 0, packet + idle_packet(7), true)]
+        tsp = TmframeStreamProtocol.new(TM_FRAME_LENGTH, '0x1ACFFC1D', true)
+        tsp.connect(@stream)
+        expect(tsp.read.buffer).to eql packet
+        expect(tsp.read).to be_nil
+        expect(tsp.frame_stats[:fecf_errors]).to eql 1
+      end
+
+      it "resynchronizes to the sync pattern" do
+        $buffers = ["\x00\x01" + TM_SYNC + frame(1, 0, 0, @packet1 + idle_packet(7))]
+        tsp = TmframeStreamProtocol.new(TM_FRAME_LENGTH)
+        tsp.connect(@stream)
+        expect(tsp.read.buffer).to eql @packet1
+        expect(tsp.bytes_discarded).to eql 2
+      end
+    end
+
+    describe "read_batch" do
+      it "does not frame the same frame twice" do
+        packet3 = space_packet(3, "\x03" * 30)
+        frame3 = TM_SYNC + frame(1, 2, 0x7FF, packet3[18..-1])
+        $buffers = [TM_SYNC + frame(1, 0, 0, @packet1 + idle_packet(7)) + "\x00" +
+                    TM_SYNC + frame(1, 1, 0, packet3[0, 18]) + frame3[0, 10],
+                    frame3[10..-1]]
+        tsp = TmframeStreamProtocol.new(TM_FRAME_LENGTH)
+        tsp.connect(@stream)
+        expect(tsp.read_batch.map {|packet| packet.buffer }).to eql [@packet1]
+        expect(tsp.read_batch.map {|packet| packet.buffer }).to eql [packet3]
+        stats = tsp.frame_stats(1)
+        expect(stats[:lost_frames]).to eql 0
+        expect(stats[:discarded]).to eql 0
+      end
+    end
+  end
+end
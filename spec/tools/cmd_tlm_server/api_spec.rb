@@ -1084,6 +1084,36 @@ module Cosmos
       end
     end
 
+    describe "get_limits_event_batch" do
+      it "calls CmdTlmServer" do
+        expect(CmdTlmServer).to receive(:get_limits_event_batch).with(10, 5, 1.0)
+        @api.get_limits_event_batch(10, 5, 1.0)
+      end
+    end
+
+    describe "get_packet_data_batch" do
+      it "calls CmdTlmServer" do
+        expect(CmdTlmServer).to receive(:get_packet_data_batch).with(10, 5, 1.0)
+        @api.get_packet_data_batch(10, 5, 1.0)
+      end
+    end
+
+    describe "get_packet_data_queue_stats" do
+      it "calls CmdTlmServer" do
+        expect(CmdTlmServer).to receive(:get_packet_data_queue_stats)
+        @api.get_packet_data_queue_stats(10)
+      end
+    end
+
+    describe "set_latency_instrumentation" do
+      it "enables and disables latency instrumentation" do
+        @api.set_latency_instrumentation(true)
+        expect(@api.get_latency_instrumentation).to be true
+        @api.set_latency_instrumentation(false)
+        expect(@api.get_latency_instrumentation).to be false
+      end
+    end
+
     # All these methods simply pass through directly to CmdTlmServer without
     # adding any functionality. Thus we just test that they are are received
     # by the CmdTlmServer.
@@ -1093,14 +1123,17 @@ module Cosmos
         @api.connect_interface("INT")
         @api.disconnect_interface("INT")
         @api.interface_state("INT")
+        @api.get_interface_latency("INT")
         @api.map_target_to_interface("INST", "INT")
         @api.get_router_names
         @api.connect_router("ROUTE")
         @api.disconnect_router("ROUTE")
         @api.router_state("ROUTE")
+        @api.get_router_info("ROUTE")
         @api.send_raw("INT","\x00\x01")
         @api.get_cmd_log_filename('DEFAULT')
         @api.get_tlm_log_filename('DEFAULT')
+        @api.get_shared_cvt_filename
         @api.start_logging('ALL')
         @api.stop_logging('ALL')
         @api.start_cmd_log('ALL')
@@ -442,6 +442,88 @@ module Cosmos
         end
       end
 
+      context "with WRITE_QUEUE" do
+        it "complains if a router hasn't been defined" do
+          tf = Tempfile.new('unittest')
+          tf.puts 'WRITE_QUEUE 100'
+          tf.close
+          expect { CmdTlmServerConfig.new(tf.path) }.to raise_error(ConfigParser::Error, /No current router for WRITE_QUEUE/)
+          tf.unlink
+        end
+
+        it "complains about unknown overflow policies" do
+          tf = Tempfile.new('unittest')
+          tf.puts 'ROUTER ROUTER cts_config_test_interface.rb'
+          tf.puts 'WRITE_QUEUE 100 BLAH'
+          tf.close
+          expect { CmdTlmServerConfig.new(tf.path) }.to raise_error(ConfigParser::Error, /Unknown overflow policy: BLAH/)
+          tf.unlink
+        end
+
+        it "sets the router write queue" do
+          tf = Tempfile.new('unittest')
+          tf.puts 'ROUTER ROUTER cts_config_test_interface.rb'
+          tf.puts 'WRITE_QUEUE 10 DISCONNECT'
+          tf.close
+          config = CmdTlmServerConfig.new(tf.path)
+          expect(config.routers['ROUTER'].async_write_queue_depth).to eql 10
+          expect(config.routers['ROUTER'].async_write_queue_overflow).to eql :DISCONNECT
+          tf.unlink
+        end
+      end
+
+      context "with WORKER_PROCESS" do
+        it "complains if an interface hasn't been defined" do
+          tf = Tempfile.new('unittest')
+          tf.puts 'WORKER_PROCESS'
+          tf.close
+          expect { CmdTlmServerConfig.new(tf.path) }.to raise_error(ConfigParser::Error, /No current interface for WORKER_PROCESS/)
+          tf.unlink
+        end
+
+        it "runs the interface in a worker process" do
+          tf = Tempfile.new('unittest')
+          tf.puts 'INTERFACE CTS_INT cts_config_test_interface.rb'
+          tf.puts 'WORKER_PROCESS'
+          tf.close
+          if InterfaceWorker.supported?
+            config = CmdTlmServerConfig.new(tf.path)
+            expect(config.interfaces['CTS_INT'].worker_process).to be true
+          else
+            expect { CmdTlmServerConfig.new(tf.path) }.to raise_error(ConfigParser::Error, /not supported/)
+          end
+          tf.unlink
+        end
+      end
+
+      context "with SHARED_CVT" do
+        it "complains about too many parameters" do
+          tf = Tempfile.new('unittest')
+          tf.puts 'SHARED_CVT file.bin extra'
+          tf.close
+          expect { CmdTlmServerConfig.new(tf.path) }.to raise_error(ConfigParser::Error, /Too many parameters/)
+          tf.unlink
+        end
+
+        it "defaults to the tmp directory" do
+          tf = Tempfile.new('unittest')
+          tf.puts 'SHARED_CVT'
+          tf.close
+          config = CmdTlmServerConfig.new(tf.path)
+          expect(config.shared_cvt_filename).to eql File.join(System.paths['TMP'], 'shared_cvt.bin')
+          tf.unlink
+        end
+
+        it "sets the shared CVT filename" do
+          tf = Tempfile.new('unittest')
+          tf.puts 'SHARED_CVT /tmp/cvt.bin'
+          tf.close
+          config = CmdTlmServerConfig.new(tf.path)
+          expect(config.shared_cvt_filename).to eql File.expand_path('/tmp/cvt.bin')
+          tf.unlink
+        end
+      end
+
       context "with BACKGROUND_TASK" do
         it "creates a background task" do
           background_task_no_args_file = File.join(Cosmos::USERPATH,'lib','cts_config_test_background_task_no_args.rb')
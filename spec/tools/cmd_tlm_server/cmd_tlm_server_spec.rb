@@ -349,6 +349,53 @@ module Cosmos
       end
     end
 
+    describe "post_packet" do
+      it "only posts to queues subscribed to the packet" do
+        cts = CmdTlmServer.new
+        version = System.telemetry.packet("COSMOS","VERSION")
+        limits_change = System.telemetry.packet("COSMOS","LIMITS_CHANGE")
+        id1 = CmdTlmServer.subscribe_packet_data([["COSMOS","VERSION"]])
+        id2 = CmdTlmServer.subscribe_packet_data([["COSMOS","VERSION"],["COSMOS","LIMITS_CHANGE"]])
+        expect(cts.packet_data_subscriptions["COSMOS"]["VERSION"].length).to eql 2
+        expect(cts.packet_data_subscriptions["COSMOS"]["LIMITS_CHANGE"].length).to eql 1
+
+        cts.post_packet(limits_change)
+        expect { CmdTlmServer.get_packet_data(id1, true) }.to raise_error(ThreadError)
+        buffer,tgt,pkt,tv_sec,tv_usec,cnt = CmdTlmServer.get_packet_data(id2, true)
+        expect(pkt).to eql "LIMITS_CHANGE"
+
+        CmdTlmServer.unsubscribe_packet_data(id2)
+        expect(cts.packet_data_subscriptions["COSMOS"]["LIMITS_CHANGE"]).to be_nil
+        cts.post_packet(version)
+        buffer,tgt,pkt,tv_sec,tv_usec,cnt = CmdTlmServer.get_packet_data(id1, true)
+        expect(pkt).to eql "VERSION"
+
+        cts.stop
+        sleep 0.2
+      end
+
+      it "shares a frozen buffer and drops the oldest packets" do
+        cts = CmdTlmServer.new
+        version = System.telemetry.packet("COSMOS","VERSION")
+        id1 = CmdTlmServer.subscribe_packet_data([["COSMOS","VERSION"]], 2, :DROP_OLDEST)
+        id2 = CmdTlmServer.subscribe_packet_data([["COSMOS","VERSION"]], 2, :DROP_OLDEST)
+        3.times do |count|
+          version.received_count = count
+          cts.post_packet(version)
+        end
+        expect(CmdTlmServer.get_packet_data_queue_stats(id1)).to eql [2, 2, :DROP_OLDEST, 1]
+
+        buffer1,tgt,pkt,tv_sec,tv_usec,cnt = CmdTlmServer.get_packet_data(id1, true)
+        expect(cnt).to eql 1
+        expect(buffer1).to be_frozen
+        buffer2,tgt,pkt,tv_sec,tv_usec,cnt = CmdTlmServer.get_packet_data(id2, true)
+        expect(buffer2).to equal(buffer1)
+
+        cts.stop
+        sleep 0.2
+      end
+    end
+
     describe "self.unsubscribe_packet_data" do
       it "unsubscribes to packets" do
         version = System.telemetry.packet("COSMOS","VERSION")
@@ -394,6 +441,47 @@ module Cosmos
       end
     end
 
+    describe "self.get_packet_data_batch" do
+      it "returns multiple packets" do
+        cts = CmdTlmServer.new
+        version = System.telemetry.packet("COSMOS","VERSION")
+        id = CmdTlmServer.subscribe_packet_data([["COSMOS","VERSION"]])
+        expect(CmdTlmServer.get_packet_data_batch(id, 10, 0.1)).to eql []
+        3.times { cts.post_packet(version) }
+        packets = CmdTlmServer.get_packet_data_batch(id, 2, 0.1)
+        expect(packets.length).to eql 2
+        buffer,tgt,pkt,tv_sec,tv_usec,cnt = packets[0]
+        expect(tgt).to eql "COSMOS"
+        expect(pkt).to eql "VERSION"
+        expect(CmdTlmServer.get_packet_data_batch(id, 2, 0.1).length).to eql 1
+        CmdTlmServer.unsubscribe_packet_data(id)
+        expect { CmdTlmServer.get_packet_data_batch(id) }.to raise_error("Packet data queue with id #{id} not found")
+        cts.stop
+        sleep 0.2
+      end
+    end
+
+    describe "self.get_limits_event_batch" do
+      it "returns multiple limits events" do
+        cts = CmdTlmServer.new
+        pkt = Packet.new("TGT","PKT")
+        pi = PacketItem.new("TEST", 0, 32, :UINT, :BIG_ENDIAN, nil)
+        id = CmdTlmServer.subscribe_limits_events()
+        pi.limits.state = :GREEN
+        cts.limits_change_callback(pkt, pi, :STALE, 100, true)
+        pi.limits.state = :YELLOW
+        cts.limits_change_callback(pkt, pi, :GREEN, 100, true)
+
+        events = CmdTlmServer.get_limits_event_batch(id, 10, 0.1)
+        expect(events.length).to eql 2
+        expect(events[0][0]).to eql :LIMITS_CHANGE
+        expect(events[1][1][4]).to eql :YELLOW
+        expect(CmdTlmServer.get_limits_event_batch(id, 10, 0)).to eql []
+        cts.stop
+        sleep 0.2
+      end
+    end
+
     describe "self.clear_counters" do
       it "clears all counters" do
         cts = CmdTlmServer.new
@@ -272,6 +272,7 @@ module Cosmos
           allow(router).to receive(:write_allowed?).and_return(true)
           allow(router).to receive(:connected?).and_return(true)
           allow(router).to receive(:name).and_return("ROUTER")
+          allow(router).to receive(:async_writer).and_return(nil)
           allow(router).to receive(:write) { raise "RouterWriteError" }
           @interface.routers = [router]
           thread = InterfaceThread.new(@interface)
@@ -286,6 +287,24 @@ module Cosmos
         end
       end
 
+      it "queues packets to routers with a write thread" do
+        writer = double("RouterWriteThread")
+        router = double("Router")
+        allow(router).to receive(:write_allowed?).and_return(true)
+        allow(router).to receive(:connected?).and_return(true)
+        allow(router).to receive(:async_writer).and_return(writer)
+        expect(router).to_not receive(:write)
+        expect(writer).to receive(:write).at_least(:once) do |packet|
+          expect(packet).to be_a Packet
+        end
+        @interface.routers = [router]
+        thread = InterfaceThread.new(@interface)
+        thread.start
+        sleep 0.1
+        thread.stop
+        sleep 0.2
+      end
+
       it "writes to all defined packet log writers" do
         writer = double("LogWriter")
         allow(writer).to receive_message_chain(:tlm_log_writer,:write)
@@ -300,6 +319,24 @@ module Cosmos
         expect(Thread.list.length).to eql(1)
       end
 
+      it "records packet latency when enabled" do
+        LatencyStats.enabled = true
+        callback_stats = nil
+        thread = InterfaceThread.new(@interface)
+        thread.identified_packet_callback = lambda {|packet| callback_stats = LatencyStats.current }
+        thread.start
+        sleep 0.1
+        thread.stop
+        sleep 0.2
+        LatencyStats.enabled = false
+        expect(callback_stats).to eql @interface.latency_stats
+        histograms = @interface.latency_stats.histograms
+        expect(histograms[LatencyStats::REDUCE].count).to be > 0
+        expect(histograms[LatencyStats::IDENTIFY].count).to be_within(1).of(histograms[LatencyStats::REDUCE].count)
+        expect(histograms[LatencyStats::LOG].count).to be_within(1).of(histograms[LatencyStats::REDUCE].count)
+        expect(histograms[LatencyStats::LIMITS].count).to eql 0
+      end
+
     end
   end
 end
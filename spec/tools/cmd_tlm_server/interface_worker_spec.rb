@@ -0,0 +1,132 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos'
+require 'cosmos/tools/cmd_tlm_server/interface_worker'
+require 'cosmos/interfaces/interface'
+require 'tempfile'
+
+module Cosmos
+
+  # Interface which produces two telemetry packets and records commands to a
+  # file since they are written by the worker process
+  class InterfaceWorkerTestInterface < Interface
+    attr_accessor :command_filename
+    attr_accessor :fail_connect
+    attr_accessor :hold_reads
+
+    def connect
+      raise "ConnectError" if @fail_connect
+      @connected = true
+      @packets_read = 0
+    end
+
+    def connected?
+      @connected
+    end
+
+    def disconnect
+      @connected = false
+    end
+
+    def read
+      sleep 0.01
+      sleep 0.1 while @hold_reads
+      @packets_read += 1
+      case @packets_read
+      when 1
+        packet = Packet.new('INST', 'HEALTH_STATUS')
+        packet.buffer = "\x01\x02"
+        packet
+      when 2
+        Packet.new(nil, nil, :BIG_ENDIAN, nil, "\xFF\xFF")
+      else
+        nil
+      end
+    end
+
+    def write(packet)
+      File.open(@command_filename, 'a') {|file| file.puts "#{packet.target_name} #{packet.packet_name}" }
+    end
+
+    def write_raw(data)
+      File.open(@command_filename, 'a') {|file| file.puts data }
+    end
+  end
+
+  describe InterfaceWorker do
+
+    before(:each) do
+      skip "fork is not supported" unless InterfaceWorker.supported?
+      @tf = Tempfile.new('unittest')
+      @tf.close
+      @interface = InterfaceWorkerTestInterface.new
+      @interface.name = 'WORKER_INT'
+      @interface.target_names = ['INST']
+      @interface.command_filename = @tf.path
+      @interface.extend(InterfaceWorker)
+      System.telemetry
+    end
+
+    after(:each) do
+      @interface.disconnect if @interface
+      @tf.unlink if @tf
+    end
+
+    describe "connect" do
+      it "raises an error if the worker fails to connect" do
+        @interface.fail_connect = true
+        expect { @interface.connect }.to raise_error(/WORKER_INT worker process failed to connect: RuntimeError:ConnectError/)
+        expect(@interface.connected?).to be false
+        expect(@interface.worker_pid).to be_nil
+      end
+
+      it "starts the worker process" do
+        @interface.connect
+        expect(@interface.connected?).to be true
+        expect(@interface.worker_pid).to_not eql Process.pid
+      end
+    end
+
+    describe "read" do
+      it "returns packets identified by the worker" do
+        @interface.connect
+        packet = @interface.read
+        expect(packet.target_name).to eql 'INST'
+        expect(packet.packet_name).to eql 'HEALTH_STATUS'
+        expect(packet.received_time).to be_a Time
+        packet = @interface.read
+        expect(packet.target_name).to be_nil
+        expect(packet.buffer).to eql "\xFF\xFF"
+        expect(@interface.read).to be_nil
+        expect(@interface.read_count).to eql 2
+      end
+    end
+
+    describe "write and write_raw" do
+      it "writes commands from the worker" do
+        @interface.hold_reads = true
+        @interface.connect
+        @interface.write(System.commands.packet('INST', 'ABORT'))
+        @interface.write_raw("RAW")
+        expect(@interface.write_count).to eql 2
+        sleep 0.5
+        expect(File.read(@tf.path)).to eql "INST ABORT\nRAW\n"
+      end
+
+      it "complains if not connected" do
+        expect { @interface.write(System.commands.packet('INST', 'ABORT')) }.to raise_error(/not connected/)
+        expect { @interface.write_raw("RAW") }.to raise_error(/not connected/)
+      end
+    end
+
+  end
+end
@@ -0,0 +1,78 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos'
+require 'cosmos/tools/cmd_tlm_server/router_write_thread'
+
+module Cosmos
+
+  describe RouterWriteThread do
+    before(:each) do
+      @router = Interface.new
+      @router.name = "ROUTER"
+      @router.async_write_queue_depth = 1000
+      allow(@router).to receive(:connected?).and_return(true)
+      allow(@router).to receive(:disconnect)
+      @packets = []
+      allow(@router).to receive(:write) {|packet| @packets << packet }
+    end
+
+    describe "write" do
+      it "writes queued packets to the router" do
+        thread = RouterWriteThread.new(@router)
+        thread.start
+        3.times { thread.write(Packet.new("TGT","PKT")) }
+        sleep 0.1
+        expect(@packets.length).to eql 3
+        thread.stop
+      end
+
+      it "drops packets when the queue is full" do
+        @router.async_write_queue_depth = 2
+        thread = RouterWriteThread.new(@router)
+        3.times { thread.write(Packet.new("TGT","PKT")) }
+        expect(thread.queue_size).to eql 2
+        expect(thread.dropped_count).to eql 1
+        thread.start
+        sleep 0.1
+        expect(@packets.length).to eql 2
+        thread.stop
+      end
+
+      it "disconnects the router when the queue overflows" do
+        capture_io do |stdout|
+          @router.async_write_queue_depth = 2
+          @router.async_write_queue_overflow = :DISCONNECT
+          expect(@router).to receive(:disconnect)
+          thread = RouterWriteThread.new(@router)
+          3.times { thread.write(Packet.new("TGT","PKT")) }
+          thread.start
+          sleep 0.1
+          expect(@packets.length).to eql 0
+          expect(stdout.string).to match "Router ROUTER write queue overflowed"
+          thread.stop
+        end
+      end
+
+      it "logs write errors" do
+        capture_io do |stdout|
+          allow(@router).to receive(:write) { raise "RouterWriteError" }
+          thread = RouterWriteThread.new(@router)
+          thread.start
+          thread.write(Packet.new("TGT","PKT"))
+          sleep 0.1
+          expect(stdout.string).to match "Problem writing to router ROUTER"
+          thread.stop
+        end
+      end
+    end
+  end
+end
@@ -194,6 +194,30 @@ module Cosmos
       end
     end
 
+    describe "info" do
+      it "complains about unknown routers" do
+        tf = Tempfile.new('unittest')
+        tf.puts 'ROUTER ROUTER1 interface.rb'
+        tf.close
+        routers = Routers.new(CmdTlmServerConfig.new(tf.path))
+        expect { routers.info("BLAH") }.to raise_error("Unknown router: BLAH")
+        tf.unlink
+      end
+
+      it "reports the router write queue" do
+        tf = Tempfile.new('unittest')
+        tf.puts 'ROUTER ROUTER1 interface.rb'
+        tf.close
+        routers = Routers.new(CmdTlmServerConfig.new(tf.path))
+        router = routers.all['ROUTER1']
+        allow(router).to receive(:connected?).and_return(false)
+        router.async_writer = double("RouterWriteThread", :queue_size => 5, :dropped_count => 2, :bytes_per_second => 100)
+        router.bytes_written = 10
+        expect(routers.info("ROUTER1")).to eql ['DISCONNECTED', 0, 5, 0, 10, 0, 0, 0, 2, 100]
+        tf.unlink
+      end
+    end
+
     describe "clear_counters" do
       it "clears all router counters" do
         tf = Tempfile.new('unittest')
@@ -21,6 +21,14 @@ module Cosmos
         @crc = Crc16.new()
         expect(@crc.calc('123456789')).to eql 0x29B1
       end
+
+      it "calculates a CRC over part of the data" do
+        @crc = Crc16.new()
+        expect(@crc.calc('xx123456789yy', nil, 2, 9)).to eql 0x29B1
+        expect(@crc.calc('xx123456789', nil, 2)).to eql 0x29B1
+        expect { @crc.calc('123', nil, 4) }.to raise_error(ArgumentError, /offset/)
+        expect { @crc.calc('123', nil, 1, 3) }.to raise_error(ArgumentError, /length/)
+      end
     end
   end
 
@@ -0,0 +1,69 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos'
+require 'cosmos/utilities/latency_histogram'
+
+module Cosmos
+
+  describe LatencyHistogram do
+
+    describe "record" do
+      it "records small values exactly" do
+        h = LatencyHistogram.new
+        [5, 5, 5, 31].each {|value| h.record(value) }
+        expect(h.count).to eql 4
+        expect(h.min).to eql 5
+        expect(h.max).to eql 31
+        expect(h.total).to eql 46
+        expect(h.percentile(50)).to eql 5
+        expect(h.percentile(100)).to eql 31
+      end
+
+      it "records negative values as 0" do
+        h = LatencyHistogram.new
+        h.record(-10)
+        expect(h.min).to eql 0
+        expect(h.percentile(100)).to eql 0
+      end
+
+      it "records large values within the bucket precision" do
+        h = LatencyHistogram.new
+        (1..100000).each {|value| h.record(value * 10) }
+        expect(h.count).to eql 100000
+        expect(h.mean).to eql 500005.0
+        expect(h.percentile(50)).to be_within(500000 * 0.04).of(500000)
+        expect(h.percentile(90)).to be_within(900000 * 0.04).of(900000)
+        expect(h.percentile(99)).to be_within(990000 * 0.04).of(990000)
+        expect(h.percentile(0)).to eql 10
+      end
+
+      it "records values larger than the maximum in the last bucket" do
+        h = LatencyHistogram.new
+        h.record(2**45)
+        expect(h.max).to eql 2**45
+        expect(h.percentile(100)).to eql 2**45
+      end
+    end
+
+    describe "clear" do
+      it "removes all values" do
+        h = LatencyHistogram.new
+        h.record(100)
+        h.clear
+        expect(h.count).to eql 0
+        expect(h.mean).to eql 0.0
+        expect(h.percentile(50)).to eql 0
+      end
+    end
+
+  end
+end
@@ -0,0 +1,76 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos'
+require 'cosmos/utilities/latency_stats'
+
+module Cosmos
+
+  describe LatencyStats do
+
+    after(:each) do
+      LatencyStats.enabled = false
+      LatencyStats.current = nil
+    end
+
+    describe "enabled" do
+      it "is disabled by default" do
+        expect(LatencyStats.enabled).to be false
+        LatencyStats.enabled = 1
+        expect(LatencyStats.enabled).to be true
+      end
+    end
+
+    describe "current" do
+      it "is local to the thread" do
+        stats = LatencyStats.new
+        LatencyStats.current = stats
+        expect(LatencyStats.current).to eql stats
+        expect(Thread.new { LatencyStats.current }.value).to be_nil
+      end
+    end
+
+    describe "start, stamp and finish" do
+      it "times stages from the data arrival" do
+        stats = LatencyStats.new
+        stats.arrived
+        sleep 0.01
+        stats.start
+        stats.stamp(LatencyStats::IDENTIFY)
+        stats.finish
+        stats.stamp(LatencyStats::LOG)
+        expect(stats.histograms[LatencyStats::REDUCE].min).to be >= 10_000_000
+        expect(stats.histograms[LatencyStats::IDENTIFY].count).to eql 1
+        expect(stats.histograms[LatencyStats::LOG].count).to eql 0
+      end
+
+      it "times stages from the start without a data arrival" do
+        stats = LatencyStats.new
+        stats.start
+        expect(stats.histograms[LatencyStats::REDUCE].max).to be < 10_000_000
+      end
+    end
+
+    describe "summary" do
+      it "returns the latency of each stage in microseconds" do
+        stats = LatencyStats.new
+        stats.histograms[LatencyStats::POST].record(2000)
+        summary = stats.summary
+        expect(summary.length).to eql LatencyStats::STAGES.length
+        expect(summary[LatencyStats::POST]).to eql ['POST', 1, 2.0, 2.0, 2.0, 2.0, 2.0, 2.0]
+        expect(summary[LatencyStats::REDUCE][1]).to eql 0
+        stats.clear
+        expect(stats.summary[LatencyStats::POST][1]).to eql 0
+      end
+    end
+
+  end
+end
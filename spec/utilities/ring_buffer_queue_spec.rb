@@ -0,0 +1,107 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos/utilities/ring_buffer_queue'
+
+module Cosmos
+
+  describe RingBufferQueue do
+    describe "initialize" do
+      it "complains about bad parameters" do
+        expect { RingBufferQueue.new(0) }.to raise_error(ArgumentError, /capacity/)
+        expect { RingBufferQueue.new(10, :BLAH) }.to raise_error(ArgumentError, /Unknown overflow policy/)
+      end
+
+      it "accepts string overflow policies" do
+        expect(RingBufferQueue.new(10, 'drop_newest').overflow).to eql :DROP_NEWEST
+      end
+    end
+
+    describe "push, pop" do
+      it "returns entries in order" do
+        queue = RingBufferQueue.new(3)
+        5.times {|i| queue << i }
+        expect(queue.length).to eql 3
+        expect(queue.dropped_count).to eql 2
+        expect(queue.pop).to eql 2
+        expect(queue.pop).to eql 3
+        expect(queue.pop).to eql 4
+        expect { queue.pop(true) }.to raise_error(ThreadError)
+      end
+
+      it "drops the newest entries" do
+        queue = RingBufferQueue.new(2, :DROP_NEWEST)
+        expect(queue.push(1)).to be true
+        expect(queue.push(2)).to be true
+        expect(queue.push(3)).to be true
+        expect(queue.dropped_count).to eql 1
+        expect(queue.pop).to eql 1
+        expect(queue.pop).to eql 2
+      end
+
+      it "reports overflow when disconnecting" do
+        queue = RingBufferQueue.new(2, :DISCONNECT)
+        expect(queue.push(1)).to be true
+        expect(queue.push(2)).to be true
+        expect(queue.push(3)).to be false
+        expect(queue.dropped_count).to eql 1
+      end
+
+      it "blocks until an entry is available" do
+        queue = RingBufferQueue.new(2)
+        thread = Thread.new { queue.pop }
+        sleep 0.1
+        queue << 10
+        expect(thread.value).to eql 10
+      end
+    end
+
+    describe "pop_batch" do
+      it "returns up to max entries" do
+        queue = RingBufferQueue.new(10)
+        5.times {|i| queue << i }
+        expect(queue.pop_batch(3)).to eql [0, 1, 2]
+        expect(queue.pop_batch(3)).to eql [3, 4]
+        expect(queue.pop_batch(3, 0)).to eql []
+      end
+
+      it "waits for the timeout" do
+        queue = RingBufferQueue.new(10)
+        start = Time.now
+        expect(queue.pop_batch(3, 0.2)).to eql []
+        expect(Time.now - start).to be_within(0.1).of(0.2)
+        thread = Thread.new { queue.pop_batch(3, 5) }
+        sleep 0.1
+        queue << 1
+        expect(thread.value).to eql [1]
+      end
+
+      it "returns nil when closed" do
+        queue = RingBufferQueue.new(10)
+        thread = Thread.new { queue.pop_batch(3) }
+        sleep 0.1
+        queue.close
+        expect(thread.value).to be_nil
+      end
+    end
+
+    describe "close" do
+      it "unblocks waiting threads" do
+        queue = RingBufferQueue.new(2)
+        thread = Thread.new { queue.pop }
+        sleep 0.1
+        queue.close
+        expect(thread.value).to be_nil
+        expect(queue.closed?).to be true
+      end
+    end
+  end
+end
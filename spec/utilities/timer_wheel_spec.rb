@@ -0,0 +1,89 @@
+# encoding: ascii-8bit
+
+# Copyright 2014 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+
+require 'spec_helper'
+require 'cosmos'
+require 'cosmos/utilities/timer_wheel'
+
+module Cosmos
+
+  describe TimerWheel do
+
+    describe "initialize" do
+      it "complains about invalid ticks" do
+        expect { TimerWheel.new(0) }.to raise_error(ArgumentError, /tick must be greater than 0/)
+      end
+    end
+
+    describe "schedule and advance" do
+      it "expires keys at their deadline" do
+        wheel = TimerWheel.new(1.0, 0.0)
+        wheel.schedule(:A, 10.0)
+        wheel.schedule(:B, 20.5)
+        expect(wheel.length).to eql 2
+        expect(wheel.advance(9.9)).to eql []
+        expect(wheel.advance(10.0)).to eql [:A]
+        expect(wheel.advance(20.4)).to eql []
+        # Keys can expire up to a tick after their deadline
+        expect(wheel.advance(21.0)).to eql [:B]
+        expect(wheel.length).to eql 0
+      end
+
+      it "expires deadlines in the past on the next tick" do
+        wheel = TimerWheel.new(1.0, 100.0)
+        wheel.schedule(:A, 50.0)
+        expect(wheel.advance(101.0)).to eql [:A]
+      end
+
+      it "cascades deadlines from the higher levels" do
+        wheel = TimerWheel.new(1.0, 0.0)
+        deadlines = [300.0, 5000.0, 20000.0, 2000000.0]
+        deadlines.each {|deadline| wheel.schedule(deadline, deadline) }
+        expired = []
+        time = 0.0
+        while time < 2000001.0
+          time += 97.0
+          wheel.advance(time).each do |key|
+            expect(key).to be <= time
+            expect(key).to be > (time - 98.0)
+            expired << key
+          end
+        end
+        expect(expired).to eql deadlines
+      end
+
+      it "moves rescheduled keys" do
+        wheel = TimerWheel.new(1.0, 0.0)
+        wheel.schedule(:A, 10.0)
+        wheel.schedule(:A, 30.0)
+        expect(wheel.deadline(:A)).to eql 30.0
+        expect(wheel.advance(20.0)).to eql []
+        wheel.schedule(:A, 25.0)
+        expect(wheel.advance(25.0)).to eql [:A]
+        expect(wheel.advance(40.0)).to eql []
+      end
+    end
+
+    describe "cancel and clear" do
+      it "removes keys" do
+        wheel = TimerWheel.new(1.0, 0.0)
+        wheel.schedule(:A, 10.0)
+        wheel.schedule(:B, 10.0)
+        wheel.cancel(:A)
+        expect(wheel.advance(10.0)).to eql [:B]
+        wheel.schedule(:A, 20.0)
+        wheel.clear
+        expect(wheel.length).to eql 0
+        expect(wheel.advance(30.0)).to eql []
+      end
+    end
+
+  end
+end